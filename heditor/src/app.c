@@ -38,6 +38,8 @@
 		B = tmp; \
 	} while (0)
 
+#define HED_JOURNAL_SIZE (1024 * 1024)
+
 #ifdef NDEBUG
 REMODULE_VAR(bool, hed_debug) = false;
 #else
@@ -49,9 +51,16 @@ typedef struct {
 	hgraph_t* current_graph;
 	size_t next_graph_size;
 	hgraph_t* next_graph;
+	size_t journal_size;
+	hgraph_journal_t* journal;
 
 	int navigate_to_content;
 	bool is_dirty;
+	uint64_t saved_digest;
+	// Size of the graph written whole and of the file after the last save.
+	// saved_size is 0 when the next save must write the graph whole.
+	long base_size;
+	long saved_size;
 
 	hed_path_t* path;
 	neEditorContext* node_editor;
@@ -98,6 +107,8 @@ REMODULE_VAR(size_t, current_pipeline_size) = 0;
 REMODULE_VAR(hgraph_pipeline_t*, current_pipeline) = NULL;
 REMODULE_VAR(size_t, next_pipeline_size) = 0;
 REMODULE_VAR(hgraph_pipeline_t*, next_pipeline) = NULL;
+REMODULE_VAR(size_t, pipeline_graph_size) = 0;
+REMODULE_VAR(hgraph_t*, pipeline_graph) = NULL;
 static pipeline_runner_t pipeline_runner;
 static hgraph_t* pipeline_bound_graph = NULL;
 
@@ -166,6 +177,23 @@ build_graph(
 	}
 }
 
+static void
+sync_pipeline_graph(hed_allocator_t* alloc, const hgraph_t* graph) {
+	// Only the parts of the graph changed since the last run are copied
+	if (pipeline_graph != NULL && hgraph_snapshot(pipeline_graph, graph)) {
+		return;
+	}
+
+	hgraph_config_t config = hgraph_get_config(graph);
+	size_t required_size = hgraph_init(pipeline_graph, pipeline_graph_size, &config);
+	if (required_size > pipeline_graph_size) {
+		pipeline_graph = hed_realloc(pipeline_graph, required_size, alloc);
+		pipeline_graph_size = required_size;
+		hgraph_init(pipeline_graph, pipeline_graph_size, &config);
+	}
+	hgraph_snapshot(pipeline_graph, graph);
+}
+
 static int
 new_document(hed_allocator_t* alloc) {
 	if (num_documents >= editor_config.max_documents) { return -1; }
@@ -177,6 +205,8 @@ new_document(hed_allocator_t* alloc) {
 	document->path = NULL;
 	document->navigate_to_content = 0;
 	document->is_dirty = false;
+	document->base_size = 0;
+	document->saved_size = 0;
 	if (document->node_editor == NULL) {
 		neConfig config = neConfigDefault();
 		config.EnableSmoothZoom = true;
@@ -184,6 +214,14 @@ new_document(hed_allocator_t* alloc) {
 		document->node_editor = neCreateEditor(&config);
 	}
 	build_graph(alloc, current_registry, &document->current_graph_size, &document->current_graph);
+	if (document->journal == NULL) {
+		hgraph_journal_config_t config = { .max_size = HED_JOURNAL_SIZE };
+		document->journal_size = hgraph_journal_init(NULL, 0, &config);
+		document->journal = hed_malloc(document->journal_size, alloc);
+		hgraph_journal_init(document->journal, document->journal_size, &config);
+	}
+	hgraph_set_journal(document->current_graph, document->journal);
+	document->saved_digest = hgraph_get_digest(document->current_graph);
 
 	return new_doc_index;
 }
@@ -196,18 +234,61 @@ close_document(int index) {
 	}
 }
 
+// Open the file at path to append the edits since the last save.
+// Returns NULL when the whole graph should be written instead.
+static FILE*
+open_document_for_append(document_t* document, const char* path) {
+	bool can_append = document->saved_size > 0
+		&& document->path != NULL
+		&& strcmp(path, hed_path_as_str(document->path)) == 0
+		&& hgraph_can_append_edits(document->current_graph)
+		// Compact once the edits outgrow the graph
+		&& document->saved_size - document->base_size < document->base_size;
+	if (!can_append) { return NULL; }
+
+	FILE* file = fopen(path, "r+b");
+	if (file == NULL) { return NULL; }
+
+	// The file may have been changed by something else since
+	if (
+		fseek(file, 0, SEEK_END) != 0
+		|| ftell(file) != document->saved_size
+	) {
+		fclose(file);
+		return NULL;
+	}
+
+	return file;
+}
+
 static bool
 save_document_at(document_t* document, const char* path) {
-	FILE* file = fopen(path, "wb");
+	FILE* file = open_document_for_append(document, path);
+	bool append = file != NULL;
+	if (!append) {
+		file = fopen(path, "wb");
+	}
+
 	if (file != NULL) {
-		log_debug("Saving %s", path);
+		log_debug("Saving %s%s", path, append ? " (appending edits)" : "");
 		neEditorContext* editor = neGetCurrentEditor();
 		neSetCurrentEditor(document->node_editor);
-		hgraph_io_status_t status = save_graph(document->current_graph, file);
+		hgraph_io_status_t status = append
+			? append_graph_edits(document->current_graph, file)
+			: save_graph(document->current_graph, file);
 		neSetCurrentEditor(editor);
+		long file_size = ftell(file);
 		fclose(file);
 		if (status == HGRAPH_IO_OK) {
 			document->is_dirty = false;
+			document->saved_digest = hgraph_get_digest(document->current_graph);
+			if (!append) {
+				document->base_size = file_size;
+			}
+			document->saved_size = file_size;
+			hgraph_mark_saved(document->current_graph);
+		} else {
+			document->saved_size = 0;
 		}
 
 		return status == HGRAPH_IO_OK;
@@ -386,6 +467,8 @@ frame(void* userdata) {
 
 			SWAP(size_t, document->current_graph_size, document->next_graph_size);
 			SWAP(hgraph_t*, document->current_graph, document->next_graph);
+			// Recorded type indices are no longer valid
+			hgraph_set_journal(document->current_graph, document->journal);
 		}
 
 		// Swap registry
@@ -450,6 +533,18 @@ frame(void* userdata) {
 			igEndMenu();
 		}
 
+		if (igBeginMenu("Edit", true)) {
+			if (igMenuItem_Bool("Undo", "Ctrl+Z", false, true)) {
+				HED_CMD(HED_CMD_UNDO);
+			}
+
+			if (igMenuItem_Bool("Redo", "Ctrl+Y", false, true)) {
+				HED_CMD(HED_CMD_REDO);
+			}
+
+			igEndMenu();
+		}
+
 		pipeline_runner_state_t runner_state = pipeline_runner_current_state(&pipeline_runner);
 		if (igBeginMenu("Run", true)) {
 			if (igMenuItem_Bool("Play", "F5", false, runner_state == PIPELINE_STOPPED)) {
@@ -546,14 +641,17 @@ frame(void* userdata) {
 							nePushStyleColor(neStyleColor_PinRect, (ImVec4){ 1.f, 1.f, 1.f, 0.7f }); ++numStyleColors;
 							nePushStyleVarFloat(neStyleVar_NodeRounding, 4.f); ++numStyleVars;
 							nePushStyleVarVec4(neStyleVar_NodePadding, (ImVec4){ 8.f, 4.f, 8.f, 4.f }); ++numStyleVars;
-							bool editable = document->current_graph != pipeline_bound_graph
-								|| pipeline_runner_current_state(&pipeline_runner) == PIPELINE_STOPPED;
+							// The pipeline runs on a snapshot so the document is
+							// always editable
+							// Everything edited in a frame is undone together
+							hgraph_begin_edit(document->current_graph);
 							bool updated = draw_editor(
 								&frame_arena,
-								editable,
+								true,
 								node_type_menu,
 								document->current_graph
 							);
+							hgraph_end_edit(document->current_graph);
 							nePopStyleVar(numStyleVars); numStyleVars = 0;
 							nePopStyleColor(numStyleColors); numStyleColors = 0;
 							document->is_dirty = document->is_dirty || updated;
@@ -611,6 +709,17 @@ frame(void* userdata) {
 		HED_CMD(HED_CMD_SAVE_AS);
 	}
 
+	if (igIsKeyChordPressed_Nil(ImGuiKey_Z | ImGuiMod_Ctrl)) {
+		HED_CMD(HED_CMD_UNDO);
+	}
+
+	if (
+		igIsKeyChordPressed_Nil(ImGuiKey_Y | ImGuiMod_Ctrl)
+		|| igIsKeyChordPressed_Nil(ImGuiKey_Z | ImGuiMod_Ctrl | ImGuiMod_Shift)
+	) {
+		HED_CMD(HED_CMD_REDO);
+	}
+
 	// Handle GUI commands
 	if (show_imgui_demo) {
 		igShowDemoWindow(&show_imgui_demo);
@@ -756,8 +865,16 @@ frame(void* userdata) {
 										hgraph_config_t config = graph_config;
 										config.registry = current_registry;
 										hgraph_init(new_doc->current_graph, new_doc->current_graph_size, &config);
-										status = load_graph(new_doc->current_graph, file);
+										status = load_graph(
+											new_doc->current_graph,
+											file,
+											&new_doc->base_size,
+											&new_doc->saved_size
+										);
 										fclose(file);
+										hgraph_set_journal(new_doc->current_graph, new_doc->journal);
+										hgraph_mark_saved(new_doc->current_graph);
+										new_doc->saved_digest = hgraph_get_digest(new_doc->current_graph);
 									}
 									neSetCurrentEditor(editor);
 
@@ -765,6 +882,12 @@ frame(void* userdata) {
 										new_doc->navigate_to_content = 2;  // Delay nav for 2 frames
 										hed_free(new_doc->path, args->allocator);
 										new_doc->path = hed_path_resolve(args->allocator, path);
+									} else {
+										log_error(
+											"Could not load %s: %s",
+											path,
+											status == HGRAPH_IO_MALFORMED ? "malformed file" : "read error"
+										);
 									}
 								} else {
 									log_error("Could not open %s: %s", path, strerror(errno));
@@ -798,8 +921,11 @@ frame(void* userdata) {
 							hgraph_pipeline_cleanup(current_pipeline);
 						}
 
+						// Moved slots are copied over by the snapshot
+						hgraph_defragment(active_document->current_graph);
+						sync_pipeline_graph(args->allocator, active_document->current_graph);
 						hgraph_pipeline_config_t config = pipeline_config;
-						config.graph = active_document->current_graph;
+						config.graph = pipeline_graph;
 						size_t required_size = hgraph_pipeline_init(
 							current_pipeline, current_pipeline_size, &config
 						);
@@ -814,10 +940,12 @@ frame(void* userdata) {
 						}
 
 						pipeline_bound_graph = active_document->current_graph;
+					} else {
+						sync_pipeline_graph(args->allocator, active_document->current_graph);
 					}
 
 					hgraph_pipeline_config_t config = pipeline_config;
-					config.graph = active_document->current_graph;
+					config.graph = pipeline_graph;
 					config.previous_pipeline = current_pipeline;
 					size_t required_size = hgraph_pipeline_init(
 						next_pipeline, next_pipeline_size, &config
@@ -838,6 +966,19 @@ frame(void* userdata) {
 					pipeline_runner_execute(&pipeline_runner, current_pipeline);
 				}
 				break;
+			case HED_CMD_UNDO:
+				if (hgraph_undo(active_document->current_graph)) {
+					// Undoing back to the saved state makes the document clean again
+					active_document->is_dirty =
+						hgraph_get_digest(active_document->current_graph) != active_document->saved_digest;
+				}
+				break;
+			case HED_CMD_REDO:
+				if (hgraph_redo(active_document->current_graph)) {
+					active_document->is_dirty =
+						hgraph_get_digest(active_document->current_graph) != active_document->saved_digest;
+				}
+				break;
 			case HED_CMD_CREATE_NODE:
 				{
 					hgraph_index_t node_id = hgraph_create_node(
@@ -898,10 +1039,12 @@ cleanup(void* userdata) {
 
 	hed_free(current_pipeline, args->allocator);
 	hed_free(next_pipeline, args->allocator);
+	hed_free(pipeline_graph, args->allocator);
 
 	for (int i = 0; i < editor_config.max_documents; ++i) {
 		hed_free(documents[i].current_graph, args->allocator);
 		hed_free(documents[i].next_graph, args->allocator);
+		hed_free(documents[i].journal, args->allocator);
 		hed_free(documents[i].path, args->allocator);
 		if (documents[i].node_editor != NULL) {
 			neDestroyEditor(documents[i].node_editor);
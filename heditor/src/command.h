@@ -14,6 +14,10 @@ typedef enum hed_command_type_e {
 	HED_CMD_OPEN,
 	HED_CMD_SAVE,
 	HED_CMD_SAVE_AS,
+	HED_CMD_UNDO,
+	HED_CMD_REDO,
+	HED_CMD_UNDO,
+	HED_CMD_REDO,
 	HED_CMD_EXECUTE,
 	HED_CMD_CREATE_NODE,
 	HED_CMD_CREATE_EDGE,
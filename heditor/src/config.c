@@ -81,6 +81,8 @@ parse_app_config(
 			return parse_count(value, &config->graph_config.max_nodes);
 		} else if (strcmp(name, "max_name_length") == 0) {
 			return parse_count(value, &config->graph_config.max_name_length);
+		} else if (strcmp(name, "name_storage_size") == 0) {
+			return parse_count(value, &config->graph_config.name_storage_size);
 		} else {
 			return 0;
 		}
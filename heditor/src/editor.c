@@ -7,6 +7,7 @@
 #include <node_type_menu.h>
 #include <cnode-editor.h>
 #include <float.h>
+#include <string.h>
 #include "command.h"
 #include "plugin_api_impl.h"
 #include "utils.h"
@@ -36,6 +37,34 @@ typedef struct pin_ctx_s {
 	struct pin_ctx_s* next;
 } pin_info_t;
 
+// Attributes are edited through a copy so that changes go through
+// hgraph_set_node_attribute and are seen by snapshots
+static void*
+edit_attribute_begin(
+	hed_arena_t* arena,
+	hgraph_t* graph,
+	hgraph_index_t node_id,
+	const hgraph_attribute_description_t* attribute
+) {
+	size_t size = attribute->data_type->size;
+	void* copy = hed_arena_alloc(arena, size, _Alignof(max_align_t));
+	memcpy(copy, hgraph_get_node_attribute(graph, node_id, attribute), size);
+	return copy;
+}
+
+static void
+edit_attribute_end(
+	hgraph_t* graph,
+	hgraph_index_t node_id,
+	const hgraph_attribute_description_t* attribute,
+	void* copy,
+	bool updated
+) {
+	if (updated) {
+		hgraph_set_node_attribute(graph, node_id, attribute, copy);
+	}
+}
+
 static void
 gui_draw_graph_node_impl(
 	draw_graph_ctx_t* ctx,
@@ -122,9 +151,9 @@ gui_draw_graph_node_impl(
 					igBeginGroup();
 					{
 						hed_plugin_api_impl_t impl;
-						void* attr = hgraph_get_node_attribute(ctx->graph, node_id, *itr);
 						igBeginDisabled(!ctx->editable);
 						HED_WITH_ARENA(ctx->arena) {
+							void* attr = edit_attribute_begin(ctx->arena, ctx->graph, node_id, *itr);
 							render(
 								attr,
 								hed_gui_init(
@@ -135,6 +164,7 @@ gui_draw_graph_node_impl(
 									igGetCurrentContext()
 								)
 							);
+							edit_attribute_end(ctx->graph, node_id, *itr, attr, impl.updated);
 						}
 						igEndDisabled();
 						ctx->updated = ctx->updated || impl.updated;
@@ -375,19 +405,6 @@ gui_draw_graph_node(
 	return true;
 }
 
-static bool
-gui_draw_graph_edge(
-	hgraph_index_t edge,
-	hgraph_index_t from_pin,
-	hgraph_index_t to_pin,
-	void* userdata
-) {
-	(void)userdata;
-
-	neLink(edge, from_pin, to_pin);
-	return true;
-}
-
 static void
 show_create_node_menu(
 	const create_node_menu_ctx_t* ctx,
@@ -449,7 +466,11 @@ draw_editor(
 	hgraph_iterate_nodes(graph, gui_draw_graph_node, &draw_ctx);
 	updated = updated || draw_ctx.updated;
 
-	hgraph_iterate_edges(graph, gui_draw_graph_edge, NULL);
+	hgraph_edge_cursor_t edge_cursor = hgraph_edge_cursor(graph);
+	hgraph_index_t edge, from_pin, to_pin;
+	while (hgraph_edge_cursor_next(&edge_cursor, &edge, &from_pin, &to_pin)) {
+		neLink(edge, from_pin, to_pin);
+	}
 	const ImVec4 accept_color = { 0.f, 1.f, 0.f, 1.f };
 	const ImVec4 reject_color = { 1.f, 0.f, 0.f, 1.f };
 
@@ -561,9 +582,9 @@ draw_editor(
 
 			if (render) {
 				hed_plugin_api_impl_t impl;
-				void* attr = hgraph_get_node_attribute(graph, popup_node, popup_attribute);
 
 				HED_WITH_ARENA(arena) {
+					void* attr = edit_attribute_begin(arena, graph, popup_node, popup_attribute);
 					render(
 						attr,
 						hed_gui_init(
@@ -574,6 +595,7 @@ draw_editor(
 							igGetCurrentContext()
 						)
 					);
+					edit_attribute_end(graph, popup_node, popup_attribute, attr, impl.updated);
 				}
 
 				updated = updated || impl.updated;
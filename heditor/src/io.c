@@ -2,21 +2,20 @@
 #include "hgraph/common.h"
 #include "hgraph/io.h"
 #include "hgraph/runtime.h"
+#include "hgraph/stream.h"
+#include "hgraph/lz.h"
 #include "utils.h"
 #define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
 #include "cnode-editor.h"
 #include <float.h>
 
-typedef struct {
-	hgraph_in_t in;
-	hgraph_out_t out;
-	FILE* handle;
-} std_file_t;
+#define HED_IO_BUFFER_SIZE (16 * 1024)
 
 typedef struct {
 	const hgraph_t* graph;
 	neEditorContext* editor;
-	std_file_t file;
+	hgraph_in_t* in;
+	hgraph_out_t* out;
 	hgraph_io_status_t status;
 	ImVec2 origin;
 } graph_io_ctx_t;
@@ -26,26 +25,6 @@ typedef struct {
 	ImVec2 max;
 } graph_bound_ctx_t;
 
-static size_t
-write_file(
-	struct hgraph_out_s* output,
-	const void* buffer,
-	size_t size
-) {
-	std_file_t* std_file = HED_CONTAINER_OF(output, std_file_t, out);
-	return fwrite(buffer, 1, size, std_file->handle);
-}
-
-static size_t
-read_file(
-	struct hgraph_in_s* input,
-	void* buffer,
-	size_t size
-) {
-	std_file_t* std_file = HED_CONTAINER_OF(input, std_file_t, in);
-	return fread(buffer, 1, size, std_file->handle);
-}
-
 static hgraph_io_status_t
 write_imvec2(ImVec2 vec2, hgraph_out_t* out) {
 	HGRAPH_CHECK_IO(hgraph_io_write_f32(vec2.x, out));
@@ -73,7 +52,9 @@ save_node_position(
 	neGetNodePosition(node_id, &pos);
 	pos.x -= ctx->origin.x;
 	pos.y -= ctx->origin.y;
-	ctx->status = write_imvec2(pos, &ctx->file.out);
+	ctx->status = hgraph_io_write_uint(node_id, ctx->out);
+	if (ctx->status != HGRAPH_IO_OK) { return false; }
+	ctx->status = write_imvec2(pos, ctx->out);
 
 	return ctx->status == HGRAPH_IO_OK;
 }
@@ -107,27 +88,14 @@ load_node_position(
 	graph_io_ctx_t* ctx = userdata;
 
 	ImVec2 pos = { 0 };
-	ctx->status = read_imvec2(&pos, &ctx->file.in);
+	ctx->status = read_imvec2(&pos, ctx->in);
 	neSetNodePosition(node_id, pos);
 
 	return ctx->status == HGRAPH_IO_OK;
 }
 
-hgraph_io_status_t
-save_graph(
-	const struct hgraph_s* graph,
-	FILE* file
-) {
-	std_file_t std_file = {
-		.out.write = write_file,
-		.handle = file,
-	};
-	hgraph_out_t* out = &std_file.out;
-
-	HGRAPH_CHECK_IO(hgraph_write_header(out));
-	HGRAPH_CHECK_IO(hgraph_write_graph(graph, out));
-
-	// Save position info
+static hgraph_io_status_t
+write_node_positions(const hgraph_t* graph, hgraph_out_t* out) {
 	graph_bound_ctx_t bound_ctx = {
 		.min = { FLT_MAX, FLT_MAX },
 		.max = { -FLT_MAX, -FLT_MAX },
@@ -135,44 +103,153 @@ save_graph(
 	hgraph_iterate_nodes(graph, find_graph_bound, &bound_ctx);
 	graph_io_ctx_t io_ctx = {
 		.graph = graph,
-		.file = std_file,
+		.out = out,
 		.status = HGRAPH_IO_OK,
 		.origin = {
 			.x = bound_ctx.min.x * 0.5f + bound_ctx.max.x * 0.5f,
 			.y = bound_ctx.min.y * 0.5f + bound_ctx.max.y * 0.5f,
 		},
 	};
+	// Positions are keyed by node id which is kept from version 2 on
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(hgraph_get_info(graph).num_nodes, out));
 	hgraph_iterate_nodes(graph, save_node_position, &io_ctx);
-	HGRAPH_CHECK_IO(io_ctx.status);
+	return io_ctx.status;
+}
+
+static hgraph_io_status_t
+read_node_positions(hgraph_t* graph, hgraph_in_t* in) {
+	uint64_t num_positions;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&num_positions, in));
+	for (uint64_t i = 0; i < num_positions; ++i) {
+		uint64_t node_id;
+		ImVec2 pos;
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&node_id, in));
+		HGRAPH_CHECK_IO(read_imvec2(&pos, in));
+		if (hgraph_get_node_type(graph, (hgraph_index_t)node_id) != NULL) {
+			neSetNodePosition((hgraph_index_t)node_id, pos);
+		}
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+static long
+get_file_size(FILE* file) {
+	long position = ftell(file);
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	fseek(file, position, SEEK_SET);
+	return size;
+}
 
+// The stream reads ahead of what was consumed
+static long
+get_stream_position(FILE* file, const hgraph_in_t* in) {
+	return ftell(file) - (long)hgraph_io_available(in);
+}
+
+// Each save appended a segment of edits followed by all node positions
+static hgraph_io_status_t
+load_graph_edits(hgraph_t* graph, FILE* file, hgraph_in_t* in, long* saved_size) {
+	long file_size = get_file_size(file);
+	while (get_stream_position(file, in) < file_size) {
+		uint64_t segment_size;
+		if (hgraph_read_edits_header(&segment_size, in) != HGRAPH_IO_OK) { break; }
+
+		// Edits cut short by a crash are left out
+		long position = get_stream_position(file, in);
+		if (segment_size > (uint64_t)(file_size - position)) { break; }
+
+		HGRAPH_CHECK_IO(hgraph_read_edits(graph, in));
+		if (read_node_positions(graph, in) != HGRAPH_IO_OK) { break; }
+	}
+
+	// Appending after an incomplete segment would hide the next ones
+	*saved_size = get_stream_position(file, in) == file_size ? file_size : 0;
 	return HGRAPH_IO_OK;
 }
 
+hgraph_io_status_t
+save_graph(
+	const struct hgraph_s* graph,
+	FILE* file
+) {
+	char buffer[HED_IO_BUFFER_SIZE];
+	hgraph_stream_out_t stream;
+	hgraph_out_t* out = hgraph_stream_out_init_file(&stream, file, buffer, sizeof(buffer));
+
+	HGRAPH_CHECK_IO(hgraph_write_header(out));
+	HGRAPH_CHECK_IO(hgraph_write_graph(graph, out));
+	HGRAPH_CHECK_IO(write_node_positions(graph, out));
+
+	return hgraph_stream_flush(&stream);
+}
+
+hgraph_io_status_t
+append_graph_edits(
+	const struct hgraph_s* graph,
+	FILE* file
+) {
+	char buffer[HED_IO_BUFFER_SIZE];
+	hgraph_stream_out_t stream;
+	hgraph_out_t* out = hgraph_stream_out_init_file(&stream, file, buffer, sizeof(buffer));
+
+	HGRAPH_CHECK_IO(hgraph_write_edits(graph, out));
+	// Nodes are not tracked as they move so all positions are written again
+	HGRAPH_CHECK_IO(write_node_positions(graph, out));
+
+	return hgraph_stream_flush(&stream);
+}
+
 hgraph_io_status_t
 load_graph(
 	struct hgraph_s* graph,
-	FILE* file
+	FILE* file,
+	long* base_size,
+	long* saved_size
 ) {
-	std_file_t std_file = {
-		.in.read = read_file,
-		.handle = file,
-	};
-	hgraph_in_t* in = &std_file.in;
+	*base_size = 0;
+	*saved_size = 0;
+
+	char buffer[HED_IO_BUFFER_SIZE];
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in = hgraph_stream_in_init_file(&stream, file, buffer, sizeof(buffer));
 
 	hgraph_header_t header;
 	HGRAPH_CHECK_IO(hgraph_read_header(&header, in));
+
+	static char lz_buffer[HGRAPH_LZ_MAX_BLOCK_SIZE];
+	hgraph_lz_in_t lz;
+	if (header.compressed) {
+		in = hgraph_lz_in_init(&lz, in, lz_buffer, sizeof(lz_buffer));
+	}
+
 	hgraph_config_t config;
 	HGRAPH_CHECK_IO(hgraph_read_graph_config(&header, &config, in));
 	HGRAPH_CHECK_IO(hgraph_read_graph(&header, graph, in));
 
 	// Load position info
-	graph_io_ctx_t io_ctx = {
-		.graph = graph,
-		.file = std_file,
-		.status = HGRAPH_IO_OK,
-	};
-	hgraph_iterate_nodes(graph, load_node_position, &io_ctx);
-	HGRAPH_CHECK_IO(io_ctx.status);
+	if (header.version >= 2) {
+		HGRAPH_CHECK_IO(read_node_positions(graph, in));
+
+		// Edits are only appended to files written in full by save_graph
+		if (!header.compressed) {
+			*base_size = get_stream_position(file, in);
+			HGRAPH_CHECK_IO(load_graph_edits(graph, file, in, saved_size));
+		}
+	} else {
+		// Version 1 stored positions in the order nodes were read
+		graph_io_ctx_t io_ctx = {
+			.graph = graph,
+			.in = in,
+			.status = HGRAPH_IO_OK,
+		};
+		hgraph_iterate_nodes(graph, load_node_position, &io_ctx);
+		HGRAPH_CHECK_IO(io_ctx.status);
+	}
+
+	// Reordering slots must wait until positions were matched to nodes
+	hgraph_defragment(graph);
 
 	return HGRAPH_IO_OK;
 }
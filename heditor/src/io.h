@@ -10,7 +10,15 @@ struct neEditorContext;
 hgraph_io_status_t
 save_graph(const struct hgraph_s* graph, FILE* file);
 
+// Append the edits since the graph was last saved to file.
+// The file must be positioned at the end of the last save.
 hgraph_io_status_t
-load_graph(struct hgraph_s* graph, FILE* file);
+append_graph_edits(const struct hgraph_s* graph, FILE* file);
+
+// base_size receives the size of the graph written whole by save_graph and
+// saved_size where edits can be appended, 0 when the graph must be written
+// whole again.
+hgraph_io_status_t
+load_graph(struct hgraph_s* graph, FILE* file, long* base_size, long* saved_size);
 
 #endif
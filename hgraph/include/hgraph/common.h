@@ -22,12 +22,18 @@ typedef struct hgraph_str_s {
 	const char* data;
 } hgraph_str_t;
 
+// The optional [pos, end) window holds bytes which the helpers in io.h can
+// consume (or fill) directly.
+// read/write are only called once the window runs out.
+// Streams without a buffer leave both pointers NULL.
 typedef struct hgraph_in_s {
 	size_t (*read)(
 		struct hgraph_in_s* input,
 		void* buffer,
 		size_t size
 	);
+	const char* pos;
+	const char* end;
 } hgraph_in_t;
 
 typedef struct hgraph_out_s {
@@ -36,6 +42,8 @@ typedef struct hgraph_out_s {
 		const void* buffer,
 		size_t size
 	);
+	char* pos;
+	char* end;
 } hgraph_out_t;
 
 typedef enum hgraph_io_status_e {
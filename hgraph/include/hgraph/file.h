@@ -0,0 +1,106 @@
+#ifndef HGRAPH_FILE_H
+#define HGRAPH_FILE_H
+
+// Random access to a graph file in memory which was written with an index,
+// see hgraph_write_graph_index.
+// Metadata is read in place and nodes can be loaded one at a time without
+// parsing the rest of the file.
+// Nodes are located by group, which are the nodes of the same type, and
+// their position in the group.
+
+#include "runtime.h"
+
+typedef struct hgraph_file_s {
+	hgraph_index_t version;
+	const char* graph;
+	size_t graph_size;
+	const char* index;
+	size_t index_size;
+	hgraph_index_t num_groups;
+	hgraph_index_t num_nodes;
+	hgraph_index_t num_edges;
+} hgraph_file_t;
+
+// Call task(task_data, i) for every i in [0, num_tasks) and return once all
+// of them are done, the calls may run concurrently on a thread pool.
+typedef void (*hgraph_parallel_for_t)(
+	void (*task)(void* task_data, hgraph_index_t index),
+	void* task_data,
+	hgraph_index_t num_tasks,
+	void* userdata
+);
+
+typedef struct hgraph_file_info_s {
+	hgraph_index_t num_groups;
+	hgraph_index_t num_nodes;
+	hgraph_index_t num_edges;
+} hgraph_file_info_t;
+
+typedef struct hgraph_file_group_s {
+	// Points into the file
+	hgraph_str_t type;
+	hgraph_index_t num_nodes;
+} hgraph_file_group_t;
+
+typedef struct hgraph_file_node_s {
+	hgraph_index_t id;
+	// Points into the file
+	hgraph_str_t name;
+} hgraph_file_node_t;
+
+// The file must stay alive and unchanged for as long as it is used.
+// Returns HGRAPH_IO_MALFORMED for files without an index.
+HGRAPH_API hgraph_io_status_t
+hgraph_file_open(hgraph_file_t* file, const void* data, size_t size);
+
+HGRAPH_API hgraph_file_info_t
+hgraph_file_get_info(const hgraph_file_t* file);
+
+// The config of a graph which can hold every node of the file
+HGRAPH_API hgraph_io_status_t
+hgraph_file_get_config(const hgraph_file_t* file, hgraph_config_t* config);
+
+HGRAPH_API hgraph_io_status_t
+hgraph_file_get_group(
+	const hgraph_file_t* file,
+	hgraph_index_t group,
+	hgraph_file_group_t* info
+);
+
+HGRAPH_API hgraph_io_status_t
+hgraph_file_get_node(
+	const hgraph_file_t* file,
+	hgraph_index_t group,
+	hgraph_index_t index,
+	hgraph_file_node_t* info
+);
+
+// Create a node with its id, name and attributes from the file.
+// node_id is set to HGRAPH_INVALID_INDEX when the type is not registered.
+HGRAPH_API hgraph_io_status_t
+hgraph_file_load_node(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	hgraph_index_t group,
+	hgraph_index_t index,
+	hgraph_index_t* node_id
+);
+
+// Connect the edges of the file between nodes which were loaded
+HGRAPH_API hgraph_io_status_t
+hgraph_file_load_edges(const hgraph_file_t* file, hgraph_t* graph);
+
+// Load the whole file into an empty graph.
+// Nodes are created up front, then their attributes are decoded in tasks of
+// consecutive nodes of a group and the edges are connected at the end.
+// The deserialize function of every data type in the file must be safe to
+// call concurrently for different values.
+HGRAPH_API hgraph_io_status_t
+hgraph_read_graph_parallel(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	hgraph_parallel_for_t parallel_for,
+	void* userdata
+);
+
+#endif
@@ -10,22 +10,67 @@
 		if (status != HGRAPH_IO_OK) { return status; } \
 	} while(0)
 
+#define HGRAPH_IO_MAX_VARINT_SIZE 10
+
+static inline size_t
+hgraph_io_available(const hgraph_in_t* input) {
+	return (size_t)(input->end - input->pos);
+}
+
+static inline size_t
+hgraph_io_space(const hgraph_out_t* output) {
+	return (size_t)(output->end - output->pos);
+}
+
 static inline hgraph_io_status_t
 hgraph_io_read(hgraph_in_t* input, void* buffer, size_t size) {
+	if (size > 0 && hgraph_io_available(input) >= size) {
+		memcpy(buffer, input->pos, size);
+		input->pos += size;
+		return HGRAPH_IO_OK;
+	}
+
 	return input->read(input, buffer, size) == size ? HGRAPH_IO_OK : HGRAPH_IO_ERROR;
 }
 
 static inline hgraph_io_status_t
 hgraph_io_write(hgraph_out_t* output, const void* buffer, size_t size) {
+	if (size > 0 && hgraph_io_space(output) >= size) {
+		memcpy(output->pos, buffer, size);
+		output->pos += size;
+		return HGRAPH_IO_OK;
+	}
+
 	return output->write(output, buffer, size) == size ? HGRAPH_IO_OK : HGRAPH_IO_ERROR;
 }
 
+static inline hgraph_io_status_t
+hgraph_io_skip(hgraph_in_t* input, size_t size) {
+	size_t available = hgraph_io_available(input);
+	if (available > 0) {
+		available = available < size ? available : size;
+		input->pos += available;
+		size -= available;
+	}
+
+	char buf[256];
+	while (size > 0) {
+		size_t chunk_size = size < sizeof(buf) ? size : sizeof(buf);
+		HGRAPH_CHECK_IO(hgraph_io_read(input, buf, chunk_size));
+		size -= chunk_size;
+	}
+
+	return HGRAPH_IO_OK;
+}
+
 static inline hgraph_io_status_t
 hgraph_io_write_uint(uint64_t x, hgraph_out_t* out) {
-    char buf[10];
+	char tmp[HGRAPH_IO_MAX_VARINT_SIZE];
+	// Encode straight into the window when it has room for the longest varint
+	char* buf = hgraph_io_space(out) >= HGRAPH_IO_MAX_VARINT_SIZE ? out->pos : tmp;
     size_t n = 0;
 
-	for (int i = 0; i < 10; ++i) {
+	for (int i = 0; i < HGRAPH_IO_MAX_VARINT_SIZE; ++i) {
 		n += x >= 0x80;
 		buf[i] = x | 0x80;
 		x >>= 7;
@@ -34,6 +79,11 @@ hgraph_io_write_uint(uint64_t x, hgraph_out_t* out) {
     buf[n] ^= 0x80;
 	n += 1;
 
+	if (buf == out->pos) {
+		out->pos += n;
+		return HGRAPH_IO_OK;
+	}
+
 	return hgraph_io_write(out, buf, n);
 }
 
@@ -50,7 +100,23 @@ hgraph_io_read_uint(uint64_t* x, hgraph_in_t* in) {
 	char c;
 	uint64_t tmp = 0;
 
-	for (int i = 0; i < 10; ++i) {
+	// Decode straight from the window when it holds the longest varint
+	if (hgraph_io_available(in) >= HGRAPH_IO_MAX_VARINT_SIZE) {
+		const uint8_t* buf = (const uint8_t*)in->pos;
+		for (int i = 0; i < HGRAPH_IO_MAX_VARINT_SIZE; ++i) {
+			b = buf[i];
+			tmp |= (b & 0x7f) << (7 * i);
+			if (b < 0x80) {
+				in->pos += i + 1;
+				*x = tmp;
+				return HGRAPH_IO_OK;
+			}
+		}
+
+		return HGRAPH_IO_MALFORMED;
+	}
+
+	for (int i = 0; i < HGRAPH_IO_MAX_VARINT_SIZE; ++i) {
 		HGRAPH_CHECK_IO(hgraph_io_read(in, &c, 1));
 
 		b = c;
@@ -79,6 +145,30 @@ hgraph_io_read_sint(int64_t* x, hgraph_in_t* in) {
     return HGRAPH_IO_OK;
 }
 
+static inline hgraph_io_status_t
+hgraph_io_write_u64(uint64_t u64, hgraph_out_t* out) {
+	uint8_t buf[sizeof(u64)];
+	for (size_t i = 0; i < sizeof(u64); ++i) {
+		buf[i] = u64 >> (i * 8);
+	}
+
+	return hgraph_io_write(out, buf, sizeof(buf));
+}
+
+static inline hgraph_io_status_t
+hgraph_io_read_u64(uint64_t* u64, hgraph_in_t* in) {
+	uint8_t buf[sizeof(*u64)];
+	HGRAPH_CHECK_IO(hgraph_io_read(in, buf, sizeof(buf)));
+
+	uint64_t value = 0;
+	for (size_t i = 0; i < sizeof(value); ++i) {
+		value |= (uint64_t)buf[i] << (i * 8);
+	}
+	*u64 = value;
+
+	return HGRAPH_IO_OK;
+}
+
 static inline hgraph_io_status_t
 hgraph_io_write_f32(float f32, hgraph_out_t* out) {
 	uint32_t ivalue;
@@ -0,0 +1,63 @@
+#ifndef HGRAPH_LZ_H
+#define HGRAPH_LZ_H
+
+// Block compression for graph files, see hgraph_write_compressed_header.
+// Data is split into blocks which are compressed independently with a small
+// LZ77 codec in the spirit of LZ4, so memory use is bounded by the block
+// buffer provided by the caller.
+//
+// Block: varint uncompressed size, 0 ends the stream, then sequences of
+//   token: high nibble literal count, low nibble match length - 4,
+//          15 in either continues in a varint after the token
+//   literals
+//   2 byte little endian match offset and the match length varint, left out
+//   in the last sequence of the block
+
+#include "runtime.h"
+
+// Matches are located with 16 bit offsets
+#define HGRAPH_LZ_MAX_BLOCK_SIZE 65536
+#define HGRAPH_LZ_HASH_BITS 12
+
+typedef struct hgraph_lz_out_s {
+	hgraph_out_t out;
+	hgraph_out_t* inner;
+	char* buffer;
+	size_t buffer_size;
+	uint16_t table[1 << HGRAPH_LZ_HASH_BITS];
+} hgraph_lz_out_t;
+
+typedef struct hgraph_lz_in_s {
+	hgraph_in_t in;
+	hgraph_in_t* inner;
+	char* buffer;
+	size_t buffer_size;
+	bool finished;
+} hgraph_lz_in_t;
+
+// The buffer holds one uncompressed block, it is capped at
+// HGRAPH_LZ_MAX_BLOCK_SIZE bytes
+HGRAPH_API hgraph_out_t*
+hgraph_lz_out_init(
+	hgraph_lz_out_t* lz,
+	hgraph_out_t* inner,
+	void* buffer,
+	size_t buffer_size
+);
+
+// Compress what is left and end the stream.
+// This must be called when done writing, the inner stream is not flushed.
+HGRAPH_API hgraph_io_status_t
+hgraph_lz_finish(hgraph_lz_out_t* lz);
+
+// The buffer must be able to hold the largest block of the stream,
+// HGRAPH_LZ_MAX_BLOCK_SIZE bytes always are
+HGRAPH_API hgraph_in_t*
+hgraph_lz_in_init(
+	hgraph_lz_in_t* lz,
+	hgraph_in_t* inner,
+	void* buffer,
+	size_t buffer_size
+);
+
+#endif
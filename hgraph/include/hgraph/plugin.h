@@ -9,6 +9,7 @@
 
 typedef struct hgraph_node_api_s hgraph_node_api_t;
 typedef struct hgraph_plugin_api_s hgraph_plugin_api_t;
+typedef struct hgraph_subgraph_s hgraph_subgraph_t;
 
 typedef enum hgraph_lifetime_e {
 	HGRAPH_LIFETIME_STEP,
@@ -88,6 +89,10 @@ typedef struct hgraph_node_type_s {
 	const hgraph_pin_description_t** output_pins;
 	const hgraph_attribute_description_t** attributes;
 
+	// When set, the node runs another graph instead of execute.
+	// Its pins are bound to pins inside that graph.
+	const hgraph_subgraph_t* subgraph;
+
 	void (*begin_pipeline)(const hgraph_node_api_t* api);
 
 	void (*execute)(const hgraph_node_api_t* api);
@@ -28,6 +28,7 @@ typedef struct hgraph_registry_s hgraph_registry_t;
 typedef struct hgraph_s hgraph_t;
 typedef struct hgraph_migration_s hgraph_migration_t;
 typedef struct hgraph_pipeline_s hgraph_pipeline_t;
+typedef struct hgraph_journal_s hgraph_journal_t;
 
 typedef struct hgraph_registry_config_s {
 	hgraph_index_t max_data_types;
@@ -38,6 +39,9 @@ typedef struct hgraph_config_s {
 	const hgraph_registry_t* registry;
 	hgraph_index_t max_nodes;
 	hgraph_index_t max_name_length;
+	// Bytes shared by all node names, 0 for a default which does not grow
+	// with max_name_length
+	hgraph_index_t name_storage_size;
 } hgraph_config_t;
 
 typedef struct hgraph_pipeline_config_s {
@@ -46,9 +50,83 @@ typedef struct hgraph_pipeline_config_s {
 	const hgraph_pipeline_t* previous_pipeline;
 } hgraph_pipeline_config_t;
 
+// Nodes are identified by their slot, edges by their id
+typedef struct hgraph_adjacency_s {
+	hgraph_index_t num_nodes;
+	hgraph_index_t num_edges;
+	const hgraph_index_t* node_ids;
+	const hgraph_index_t* node_slots;
+
+	const hgraph_index_t* forward_offsets;
+	const hgraph_index_t* forward_nodes;
+	const hgraph_index_t* forward_edges;
+
+	const hgraph_index_t* reverse_offsets;
+	const hgraph_index_t* reverse_nodes;
+	const hgraph_index_t* reverse_edges;
+} hgraph_adjacency_t;
+
+struct hgraph_subgraph_s {
+	const hgraph_t* graph;
+	// Pin ids in graph, one for each pin of the node type in the same order
+	const hgraph_index_t* input_pins;
+	const hgraph_index_t* output_pins;
+};
+
+// Per node arrays are indexed by node id
+typedef struct hgraph_analysis_s {
+	hgraph_index_t num_nodes;
+	hgraph_index_t num_levels;
+	hgraph_index_t max_width;
+	float total_cost;
+
+	float critical_path_cost;
+	hgraph_index_t critical_path_length;
+	const hgraph_index_t* critical_path;
+
+	const hgraph_index_t* levels;
+	const float* finish_times;
+	const float* slacks;
+} hgraph_analysis_t;
+
+#define HGRAPH_CURSOR_MAX_STARTS 16
+
+// The graph must not be modified while a cursor is in use
+typedef struct hgraph_node_cursor_s {
+	const hgraph_index_t* ids_for_slot;
+	hgraph_index_t num_nodes;
+	hgraph_index_t position;
+} hgraph_node_cursor_t;
+
+typedef struct hgraph_edge_cursor_s {
+	const hgraph_index_t* ids_for_slot;
+	const hgraph_index_t* slots_for_id;
+	// Edges are only made of indices
+	const hgraph_index_t* edges;
+	hgraph_index_t edge_stride;
+	hgraph_index_t next_field;
+	hgraph_index_t from_pin_field;
+	hgraph_index_t to_pin_field;
+
+	// Walk every slot or follow chains from a few starting edges
+	bool walk_slots;
+	bool follow_links;
+	hgraph_index_t num_edges;
+	hgraph_index_t position;
+	hgraph_index_t current;
+	hgraph_index_t num_starts;
+	hgraph_index_t starts[HGRAPH_CURSOR_MAX_STARTS];
+} hgraph_edge_cursor_t;
+
+typedef struct hgraph_journal_config_s {
+	size_t max_size;
+} hgraph_journal_config_t;
+
 typedef struct hgraph_registry_info_s {
 	hgraph_index_t num_data_types;
 	hgraph_index_t num_node_types;
+	// Equal for registries which lay out graphs the same way
+	uint64_t fingerprint;
 } hgraph_registry_info_t;
 
 typedef struct hgraph_info_s {
@@ -71,10 +149,14 @@ typedef enum hgraph_pipeline_execution_status_e {
 	HGRAPH_PIPELINE_EXEC_OOM,
 	HGRAPH_PIPELINE_EXEC_INCOMPLETE_OUTPUT,
 	HGRAPH_PIPELINE_EXEC_OUT_OF_SYNC,
+	// A subgraph contains a node which is itself a subgraph
+	HGRAPH_PIPELINE_EXEC_NESTED_SUBGRAPH,
 } hgraph_pipeline_execution_status_t;
 
 typedef struct hgraph_header_s {
 	hgraph_index_t version;
+	// Everything after the header must be read through hgraph_lz_in_t
+	bool compressed;
 } hgraph_header_t;
 
 typedef struct hgraph_pipeline_event_s {
@@ -193,7 +275,7 @@ hgraph_disconnect(hgraph_t* graph, hgraph_index_t edge);
 HGRAPH_API hgraph_str_t
 hgraph_get_node_name(const hgraph_t* graph, hgraph_index_t node);
 
-HGRAPH_API void
+HGRAPH_API bool
 hgraph_set_node_name(hgraph_t* graph, hgraph_index_t node, hgraph_str_t name);
 
 HGRAPH_API hgraph_index_t
@@ -214,6 +296,28 @@ hgraph_get_node_attribute(
 	const hgraph_attribute_description_t* attribute
 );
 
+// A stride of 0 sets every node to the same value
+HGRAPH_API hgraph_index_t
+hgraph_set_attribute_bulk(
+	hgraph_t* graph,
+	const hgraph_attribute_description_t* attribute,
+	const hgraph_index_t* node_ids,
+	const void* values,
+	size_t stride,
+	hgraph_index_t count
+);
+
+// Values of nodes without the attribute are left untouched
+HGRAPH_API hgraph_index_t
+hgraph_get_attribute_bulk(
+	const hgraph_t* graph,
+	const hgraph_attribute_description_t* attribute,
+	const hgraph_index_t* node_ids,
+	void* values,
+	size_t stride,
+	hgraph_index_t count
+);
+
 HGRAPH_API void
 hgraph_iterate_nodes(
 	const hgraph_t* graph,
@@ -221,9 +325,92 @@ hgraph_iterate_nodes(
 	void* userdata
 );
 
+HGRAPH_API void
+hgraph_iterate_nodes_of_type(
+	const hgraph_t* graph,
+	const hgraph_node_type_t* type,
+	hgraph_node_iterator_t iterator,
+	void* userdata
+);
+
+// Move node slots into topological order so execution walks memory
+// sequentially. Ids are unchanged. Returns the number of swaps made.
+HGRAPH_API hgraph_index_t
+hgraph_defragment(hgraph_t* graph);
+
+HGRAPH_API void
+hgraph_iterate_nodes_topological(
+	const hgraph_t* graph,
+	hgraph_node_iterator_t iterator,
+	void* userdata
+);
+
+// Changes whenever the content of the graph changes, equal graphs built
+// with the same node ids have the same digest
+HGRAPH_API uint64_t
+hgraph_get_digest(const hgraph_t* graph);
+
+HGRAPH_API uint64_t
+hgraph_get_node_hash(const hgraph_t* graph, hgraph_index_t node_id);
+
 HGRAPH_API hgraph_info_t
 hgraph_get_info(const hgraph_t* graph);
 
+HGRAPH_API hgraph_config_t
+hgraph_get_config(const hgraph_t* graph);
+
+HGRAPH_API size_t
+hgraph_copy(hgraph_t* dst, size_t size, const hgraph_t* src);
+
+HGRAPH_API bool
+hgraph_snapshot(hgraph_t* snapshot, const hgraph_t* graph);
+
+HGRAPH_API size_t
+hgraph_build_adjacency(
+	hgraph_adjacency_t* adjacency,
+	size_t size,
+	const hgraph_t* graph
+);
+
+HGRAPH_API size_t
+hgraph_analyze(
+	hgraph_analysis_t* analysis,
+	size_t size,
+	const hgraph_t* graph,
+	const float* costs
+);
+
+HGRAPH_API size_t
+hgraph_journal_init(
+	hgraph_journal_t* journal,
+	size_t size,
+	const hgraph_journal_config_t* config
+);
+
+HGRAPH_API void
+hgraph_set_journal(hgraph_t* graph, hgraph_journal_t* journal);
+
+HGRAPH_API void
+hgraph_begin_edit(hgraph_t* graph);
+
+HGRAPH_API void
+hgraph_end_edit(hgraph_t* graph);
+
+HGRAPH_API bool
+hgraph_undo(hgraph_t* graph);
+
+HGRAPH_API bool
+hgraph_redo(hgraph_t* graph);
+
+// Remember the current state as the saved one, see hgraph_write_edits
+HGRAPH_API void
+hgraph_mark_saved(hgraph_t* graph);
+
+// Whether the journal still holds every edit since the last save.
+// Otherwise the graph has to be written whole again.
+HGRAPH_API bool
+hgraph_can_append_edits(const hgraph_t* graph);
+
 HGRAPH_API void
 hgraph_iterate_edges(
 	const hgraph_t* graph,
@@ -253,6 +440,43 @@ hgraph_is_pin_connected(
 	hgraph_index_t pin_id
 );
 
+HGRAPH_API hgraph_node_cursor_t
+hgraph_node_cursor(const hgraph_t* graph);
+
+HGRAPH_API hgraph_edge_cursor_t
+hgraph_edge_cursor(const hgraph_t* graph);
+
+HGRAPH_API hgraph_edge_cursor_t
+hgraph_edge_cursor_to(const hgraph_t* graph, hgraph_index_t node_id);
+
+HGRAPH_API hgraph_edge_cursor_t
+hgraph_edge_cursor_from(const hgraph_t* graph, hgraph_index_t node_id);
+
+HGRAPH_API uint32_t
+hgraph_read_begin(const hgraph_t* graph);
+
+HGRAPH_API bool
+hgraph_read_validate(const hgraph_t* graph, uint32_t sequence);
+
+HGRAPH_API size_t
+hgraph_read_scratch_size(const hgraph_t* graph);
+
+HGRAPH_API void
+hgraph_iterate_nodes_consistent(
+	const hgraph_t* graph,
+	void* scratch,
+	hgraph_node_iterator_t iterator,
+	void* userdata
+);
+
+HGRAPH_API void
+hgraph_iterate_edges_consistent(
+	const hgraph_t* graph,
+	void* scratch,
+	hgraph_edge_iterator_t iterator,
+	void* userdata
+);
+
 HGRAPH_API size_t
 hgraph_migration_init(
 	hgraph_migration_t* migration,
@@ -300,12 +524,23 @@ hgraph_pipeline_reset_stats(hgraph_pipeline_t* pipeline);
 HGRAPH_API hgraph_io_status_t
 hgraph_write_header(hgraph_out_t* out);
 
+// Flag everything written after the header as compressed, it must be written
+// through hgraph_lz_out_t, see lz.h
+HGRAPH_API hgraph_io_status_t
+hgraph_write_compressed_header(hgraph_out_t* out);
+
 HGRAPH_API hgraph_io_status_t
 hgraph_read_header(hgraph_header_t* header, hgraph_in_t* in);
 
 HGRAPH_API hgraph_io_status_t
 hgraph_write_graph(const hgraph_t* graph, hgraph_out_t* out);
 
+// Write an index of the graph just written with hgraph_write_graph so it can
+// be inspected and partially loaded with hgraph_file_t, see file.h.
+// Readers which do not use the index stop before it.
+HGRAPH_API hgraph_io_status_t
+hgraph_write_graph_index(const hgraph_t* graph, hgraph_out_t* out);
+
 HGRAPH_API hgraph_io_status_t
 hgraph_read_graph_config(
 	const hgraph_header_t* header,
@@ -320,6 +555,131 @@ hgraph_read_graph(
 	hgraph_in_t* input
 );
 
+// CRC32C (Castagnoli) of data, chained through crc which starts at 0.
+// Sections of graph files are checked with it.
+HGRAPH_API uint32_t
+hgraph_crc32c(uint32_t crc, const void* data, size_t size);
+
+// Write the edits since the last save as a segment to append to the saved
+// file.
+// Fails when hgraph_can_append_edits is false.
+HGRAPH_API hgraph_io_status_t
+hgraph_write_edits(const hgraph_t* graph, hgraph_out_t* out);
+
+// Read the size of the next segment of edits.
+// A segment cut short by a crash can be told apart before applying any of it.
+HGRAPH_API hgraph_io_status_t
+hgraph_read_edits_header(uint64_t* size, hgraph_in_t* in);
+
+// Apply a segment of edits after its header.
+// The config read from the file only covers the graph before the edits, the
+// graph must have room for the nodes they create.
+HGRAPH_API hgraph_io_status_t
+hgraph_read_edits(hgraph_t* graph, hgraph_in_t* in);
+
+// Write the graph memory as is so it can be mapped back without parsing.
+// A regular graph file is appended for readers with a different registry.
+// Attributes must not own memory outside of the graph.
+HGRAPH_API hgraph_io_status_t
+hgraph_write_image(const hgraph_t* graph, hgraph_out_t* out);
+
+// Use an image in place as a graph.
+// Returns NULL when the image was written with a different registry layout or
+// is not aligned to max_align_t, hgraph_get_image_fallback can be read instead.
+// The image must be writable, mapping a file privately is enough.
+HGRAPH_API hgraph_t*
+hgraph_map_graph(void* image, size_t size, const hgraph_registry_t* registry);
+
+HGRAPH_API bool
+hgraph_get_image_fallback(
+	const void* image,
+	size_t size,
+	const void** file,
+	size_t* file_size
+);
+
+static inline hgraph_index_t
+hgraph_adjacency_num_successors(const hgraph_adjacency_t* adjacency, hgraph_index_t slot) {
+	return adjacency->forward_offsets[slot + 1] - adjacency->forward_offsets[slot];
+}
+
+static inline const hgraph_index_t*
+hgraph_adjacency_successors(const hgraph_adjacency_t* adjacency, hgraph_index_t slot) {
+	return adjacency->forward_nodes + adjacency->forward_offsets[slot];
+}
+
+static inline const hgraph_index_t*
+hgraph_adjacency_out_edges(const hgraph_adjacency_t* adjacency, hgraph_index_t slot) {
+	return adjacency->forward_edges + adjacency->forward_offsets[slot];
+}
+
+static inline hgraph_index_t
+hgraph_adjacency_num_predecessors(const hgraph_adjacency_t* adjacency, hgraph_index_t slot) {
+	return adjacency->reverse_offsets[slot + 1] - adjacency->reverse_offsets[slot];
+}
+
+static inline const hgraph_index_t*
+hgraph_adjacency_predecessors(const hgraph_adjacency_t* adjacency, hgraph_index_t slot) {
+	return adjacency->reverse_nodes + adjacency->reverse_offsets[slot];
+}
+
+static inline const hgraph_index_t*
+hgraph_adjacency_in_edges(const hgraph_adjacency_t* adjacency, hgraph_index_t slot) {
+	return adjacency->reverse_edges + adjacency->reverse_offsets[slot];
+}
+
+static inline bool
+hgraph_node_cursor_next(hgraph_node_cursor_t* cursor, hgraph_index_t* node_id) {
+	while (cursor->position < cursor->num_nodes) {
+		hgraph_index_t id = cursor->ids_for_slot[cursor->position++];
+		if (HGRAPH_IS_VALID_INDEX(id)) {
+			*node_id = id;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static inline bool
+hgraph_edge_cursor_next(
+	hgraph_edge_cursor_t* cursor,
+	hgraph_index_t* edge_id,
+	hgraph_index_t* from_pin,
+	hgraph_index_t* to_pin
+) {
+	hgraph_index_t id, slot;
+	if (cursor->walk_slots) {
+		do {
+			if (cursor->position >= cursor->num_edges) { return false; }
+
+			slot = cursor->position++;
+			id = cursor->ids_for_slot[slot];
+		} while (!HGRAPH_IS_VALID_INDEX(id));
+	} else {
+		while (!HGRAPH_IS_VALID_INDEX(cursor->current)) {
+			if (cursor->position >= cursor->num_starts) { return false; }
+
+			cursor->current = cursor->starts[cursor->position++];
+		}
+
+		id = cursor->current;
+		slot = cursor->slots_for_id[id];
+	}
+
+	const hgraph_index_t* edge = cursor->edges + slot * cursor->edge_stride;
+	if (!cursor->walk_slots) {
+		cursor->current = cursor->follow_links
+			? edge[cursor->next_field]
+			: HGRAPH_INVALID_INDEX;
+	}
+
+	*edge_id = id;
+	*from_pin = edge[cursor->from_pin_field];
+	*to_pin = edge[cursor->to_pin_field];
+	return true;
+}
+
 #ifdef __cplusplus
 }
 #endif
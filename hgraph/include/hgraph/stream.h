@@ -0,0 +1,81 @@
+#ifndef HGRAPH_STREAM_H
+#define HGRAPH_STREAM_H
+
+// Buffered hgraph_in_t/hgraph_out_t over memory, FILE* and file descriptors.
+// The buffer is provided by the caller and exposed as the stream window so
+// the helpers in io.h decode from and encode into it directly.
+
+#include "runtime.h"
+#include <stdio.h>
+
+typedef struct hgraph_stream_in_s {
+	hgraph_in_t in;
+	size_t (*fill)(struct hgraph_stream_in_s* stream, void* buffer, size_t size);
+	union {
+		FILE* file;
+		int fd;
+	} source;
+	char* buffer;
+	size_t buffer_size;
+} hgraph_stream_in_t;
+
+typedef struct hgraph_stream_out_s {
+	hgraph_out_t out;
+	size_t (*drain)(struct hgraph_stream_out_s* stream, const void* buffer, size_t size);
+	union {
+		FILE* file;
+		int fd;
+	} sink;
+	char* buffer;
+	size_t buffer_size;
+	size_t num_bytes_drained;
+} hgraph_stream_out_t;
+
+HGRAPH_API hgraph_in_t*
+hgraph_stream_in_init_mem(hgraph_stream_in_t* stream, const void* data, size_t size);
+
+HGRAPH_API hgraph_in_t*
+hgraph_stream_in_init_file(
+	hgraph_stream_in_t* stream,
+	FILE* file,
+	void* buffer,
+	size_t buffer_size
+);
+
+HGRAPH_API hgraph_in_t*
+hgraph_stream_in_init_fd(
+	hgraph_stream_in_t* stream,
+	int fd,
+	void* buffer,
+	size_t buffer_size
+);
+
+HGRAPH_API hgraph_out_t*
+hgraph_stream_out_init_mem(hgraph_stream_out_t* stream, void* data, size_t size);
+
+HGRAPH_API hgraph_out_t*
+hgraph_stream_out_init_file(
+	hgraph_stream_out_t* stream,
+	FILE* file,
+	void* buffer,
+	size_t buffer_size
+);
+
+HGRAPH_API hgraph_out_t*
+hgraph_stream_out_init_fd(
+	hgraph_stream_out_t* stream,
+	int fd,
+	void* buffer,
+	size_t buffer_size
+);
+
+// Write out everything in the buffer.
+// This must be called when done writing to a file or fd stream.
+HGRAPH_API hgraph_io_status_t
+hgraph_stream_flush(hgraph_stream_out_t* stream);
+
+// Total number of bytes written to the stream, flushed or not
+HGRAPH_API size_t
+hgraph_stream_out_size(const hgraph_stream_out_t* stream);
+
+#endif
@@ -0,0 +1,156 @@
+#include "internal.h"
+#include "graph.h"
+#include "mem_layout.h"
+
+// Turn per-node counts into start offsets while the lists are being filled.
+// After filling, offsets[i] is the end of node i and is shifted back into
+// the start of node i + 1.
+HGRAPH_PRIVATE void
+hgraph_adjacency_prefix_sum(hgraph_index_t* offsets, hgraph_index_t num_nodes) {
+	hgraph_index_t sum = 0;
+	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
+		hgraph_index_t count = offsets[i];
+		offsets[i] = sum;
+		sum += count;
+	}
+	offsets[num_nodes] = sum;
+}
+
+HGRAPH_PRIVATE void
+hgraph_adjacency_shift(hgraph_index_t* offsets, hgraph_index_t num_nodes) {
+	for (hgraph_index_t i = num_nodes; i > 0; --i) {
+		offsets[i] = offsets[i - 1];
+	}
+	offsets[0] = 0;
+}
+
+HGRAPH_PRIVATE hgraph_index_t
+hgraph_adjacency_slot_for_pin(const hgraph_index_t* node_slots, hgraph_index_t pin_id) {
+	hgraph_index_t node_id, pin_index;
+	bool is_output;
+	hgraph_decode_pin_id(pin_id, &node_id, &pin_index, &is_output);
+	return node_slots[node_id];
+}
+
+size_t
+hgraph_build_adjacency(
+	hgraph_adjacency_t* adjacency,
+	size_t size,
+	const hgraph_t* graph
+) {
+	hgraph_index_t max_nodes = graph->node_slot_map.max_items;
+	hgraph_index_t num_nodes = graph->node_slot_map.num_items;
+	hgraph_index_t num_edges = graph->edge_slot_map.num_items;
+
+	mem_layout_t layout = { 0 };
+	mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_adjacency_t),
+		_Alignof(hgraph_adjacency_t)
+	);
+	ptrdiff_t node_ids_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t node_slots_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t forward_offsets_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * (num_nodes + 1),
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t forward_nodes_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_edges,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t forward_edges_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_edges,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t reverse_offsets_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * (num_nodes + 1),
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t reverse_nodes_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_edges,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t reverse_edges_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_edges,
+		_Alignof(hgraph_index_t)
+	);
+
+	size_t required_size = mem_layout_size(&layout);
+	if (adjacency == NULL || size < required_size) { return required_size; }
+
+	hgraph_index_t* node_ids = mem_layout_locate(adjacency, node_ids_offset);
+	hgraph_index_t* node_slots = mem_layout_locate(adjacency, node_slots_offset);
+	hgraph_index_t* forward_offsets = mem_layout_locate(adjacency, forward_offsets_offset);
+	hgraph_index_t* forward_nodes = mem_layout_locate(adjacency, forward_nodes_offset);
+	hgraph_index_t* forward_edges = mem_layout_locate(adjacency, forward_edges_offset);
+	hgraph_index_t* reverse_offsets = mem_layout_locate(adjacency, reverse_offsets_offset);
+	hgraph_index_t* reverse_nodes = mem_layout_locate(adjacency, reverse_nodes_offset);
+	hgraph_index_t* reverse_edges = mem_layout_locate(adjacency, reverse_edges_offset);
+
+	memcpy(
+		node_ids,
+		hgraph_slot_map_ids_for_slot(&graph->node_slot_map),
+		sizeof(hgraph_index_t) * num_nodes
+	);
+	for (hgraph_index_t i = 0; i < max_nodes; ++i) {
+		node_slots[i] = hgraph_slot_map_slot_for_id(&graph->node_slot_map, i);
+	}
+
+	// Count the degree of each node
+	memset(forward_offsets, 0, sizeof(hgraph_index_t) * (num_nodes + 1));
+	memset(reverse_offsets, 0, sizeof(hgraph_index_t) * (num_nodes + 1));
+	for (hgraph_index_t i = 0; i < num_edges; ++i) {
+		const hgraph_edge_t* edge = &hgraph_edges(graph)[i];
+		++forward_offsets[hgraph_adjacency_slot_for_pin(node_slots, edge->from_pin)];
+		++reverse_offsets[hgraph_adjacency_slot_for_pin(node_slots, edge->to_pin)];
+	}
+	hgraph_adjacency_prefix_sum(forward_offsets, num_nodes);
+	hgraph_adjacency_prefix_sum(reverse_offsets, num_nodes);
+
+	// Fill the neighbour lists in edge slot order
+	for (hgraph_index_t i = 0; i < num_edges; ++i) {
+		const hgraph_edge_t* edge = &hgraph_edges(graph)[i];
+		hgraph_index_t edge_id = hgraph_slot_map_id_for_slot(&graph->edge_slot_map, i);
+		hgraph_index_t from_slot = hgraph_adjacency_slot_for_pin(node_slots, edge->from_pin);
+		hgraph_index_t to_slot = hgraph_adjacency_slot_for_pin(node_slots, edge->to_pin);
+
+		hgraph_index_t forward_index = forward_offsets[from_slot]++;
+		forward_nodes[forward_index] = to_slot;
+		forward_edges[forward_index] = edge_id;
+
+		hgraph_index_t reverse_index = reverse_offsets[to_slot]++;
+		reverse_nodes[reverse_index] = from_slot;
+		reverse_edges[reverse_index] = edge_id;
+	}
+	hgraph_adjacency_shift(forward_offsets, num_nodes);
+	hgraph_adjacency_shift(reverse_offsets, num_nodes);
+
+	*adjacency = (hgraph_adjacency_t){
+		.num_nodes = num_nodes,
+		.num_edges = num_edges,
+		.node_ids = node_ids,
+		.node_slots = node_slots,
+		.forward_offsets = forward_offsets,
+		.forward_nodes = forward_nodes,
+		.forward_edges = forward_edges,
+		.reverse_offsets = reverse_offsets,
+		.reverse_nodes = reverse_nodes,
+		.reverse_edges = reverse_edges,
+	};
+
+	return required_size;
+}
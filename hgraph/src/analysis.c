@@ -0,0 +1,191 @@
+#include "internal.h"
+#include "graph.h"
+#include "mem_layout.h"
+
+HGRAPH_PRIVATE float
+hgraph_analysis_cost(const float* costs, hgraph_index_t node_id) {
+	return costs != NULL ? costs[node_id] : 1.f;
+}
+
+size_t
+hgraph_analyze(
+	hgraph_analysis_t* analysis,
+	size_t size,
+	const hgraph_t* graph,
+	const float* costs
+) {
+	hgraph_index_t max_nodes = graph->node_slot_map.max_items;
+	hgraph_index_t num_nodes = graph->node_slot_map.num_items;
+
+	mem_layout_t layout = { 0 };
+	mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_analysis_t),
+		_Alignof(hgraph_analysis_t)
+	);
+	ptrdiff_t levels_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t finish_times_offset = mem_layout_reserve(
+		&layout,
+		sizeof(float) * max_nodes,
+		_Alignof(float)
+	);
+	ptrdiff_t slacks_offset = mem_layout_reserve(
+		&layout,
+		sizeof(float) * max_nodes,
+		_Alignof(float)
+	);
+	ptrdiff_t critical_path_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	// Scratch
+	ptrdiff_t predecessors_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t widths_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_nodes,
+		_Alignof(hgraph_index_t)
+	);
+
+	size_t required_size = mem_layout_size(&layout);
+	if (analysis == NULL || size < required_size) { return required_size; }
+
+	hgraph_index_t* levels = mem_layout_locate(analysis, levels_offset);
+	float* finish_times = mem_layout_locate(analysis, finish_times_offset);
+	float* slacks = mem_layout_locate(analysis, slacks_offset);
+	hgraph_index_t* critical_path = mem_layout_locate(analysis, critical_path_offset);
+	hgraph_index_t* predecessors = mem_layout_locate(analysis, predecessors_offset);
+	hgraph_index_t* widths = mem_layout_locate(analysis, widths_offset);
+
+	for (hgraph_index_t i = 0; i < max_nodes; ++i) {
+		levels[i] = HGRAPH_INVALID_INDEX;
+		finish_times[i] = 0.f;
+		slacks[i] = 0.f;
+		predecessors[i] = HGRAPH_INVALID_INDEX;
+	}
+	memset(widths, 0, sizeof(hgraph_index_t) * num_nodes);
+
+	// Forward pass in topological order: every predecessor is final by the
+	// time a node is reached
+	const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	hgraph_index_t num_levels = 0;
+	hgraph_index_t max_width = 0;
+	float total_cost = 0.f;
+	float critical_path_cost = 0.f;
+	hgraph_index_t critical_path_end = HGRAPH_INVALID_INDEX;
+	for (hgraph_index_t i = 0; i < graph->order_end; ++i) {
+		hgraph_index_t node_id = ordered_nodes[i];
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { continue; }
+
+		const hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+		const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
+
+		hgraph_index_t level = 0;
+		float start_time = 0.f;
+		for (hgraph_index_t j = 0; j < type_info->num_input_pins; ++j) {
+			hgraph_index_t edge_id = *(hgraph_index_t*)((char*)node + type_info->input_pins[j].offset);
+			hgraph_index_t edge_slot = hgraph_slot_map_slot_for_id(&graph->edge_slot_map, edge_id);
+			if (!HGRAPH_IS_VALID_INDEX(edge_slot)) { continue; }
+
+			hgraph_index_t from_node_id, from_pin_index;
+			bool is_output;
+			hgraph_decode_pin_id(
+				hgraph_edges(graph)[edge_slot].from_pin,
+				&from_node_id, &from_pin_index, &is_output
+			);
+			level = HGRAPH_MAX(level, levels[from_node_id] + 1);
+			if (
+				!HGRAPH_IS_VALID_INDEX(predecessors[node_id])
+				|| finish_times[from_node_id] > start_time
+			) {
+				start_time = finish_times[from_node_id];
+				predecessors[node_id] = from_node_id;
+			}
+		}
+
+		float cost = hgraph_analysis_cost(costs, node_id);
+		levels[node_id] = level;
+		finish_times[node_id] = start_time + cost;
+		total_cost += cost;
+
+		num_levels = HGRAPH_MAX(num_levels, level + 1);
+		hgraph_index_t width = ++widths[level];
+		max_width = HGRAPH_MAX(max_width, width);
+		if (
+			!HGRAPH_IS_VALID_INDEX(critical_path_end)
+			|| finish_times[node_id] > critical_path_cost
+		) {
+			critical_path_cost = finish_times[node_id];
+			critical_path_end = node_id;
+		}
+	}
+
+	// Backward pass: slack is how much a node can be delayed without delaying
+	// the whole graph.
+	// Slacks hold the latest finish times until each node is reached.
+	for (hgraph_index_t i = 0; i < max_nodes; ++i) {
+		slacks[i] = critical_path_cost;
+	}
+	for (hgraph_index_t i = graph->order_end; i > 0; --i) {
+		hgraph_index_t node_id = ordered_nodes[i - 1];
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { continue; }
+
+		const hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+		const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
+
+		float latest_start = slacks[node_id] - hgraph_analysis_cost(costs, node_id);
+		slacks[node_id] -= finish_times[node_id];
+
+		for (hgraph_index_t j = 0; j < type_info->num_input_pins; ++j) {
+			hgraph_index_t edge_id = *(hgraph_index_t*)((char*)node + type_info->input_pins[j].offset);
+			hgraph_index_t edge_slot = hgraph_slot_map_slot_for_id(&graph->edge_slot_map, edge_id);
+			if (!HGRAPH_IS_VALID_INDEX(edge_slot)) { continue; }
+
+			hgraph_index_t from_node_id, from_pin_index;
+			bool is_output;
+			hgraph_decode_pin_id(
+				hgraph_edges(graph)[edge_slot].from_pin,
+				&from_node_id, &from_pin_index, &is_output
+			);
+			slacks[from_node_id] = HGRAPH_MIN(slacks[from_node_id], latest_start);
+		}
+	}
+
+	// Walk the critical path back from its end
+	hgraph_index_t critical_path_length = 0;
+	for (
+		hgraph_index_t node_id = critical_path_end;
+		HGRAPH_IS_VALID_INDEX(node_id);
+		node_id = predecessors[node_id]
+	) {
+		critical_path[critical_path_length++] = node_id;
+	}
+	for (hgraph_index_t i = 0; i < critical_path_length / 2; ++i) {
+		hgraph_index_t tmp = critical_path[i];
+		critical_path[i] = critical_path[critical_path_length - 1 - i];
+		critical_path[critical_path_length - 1 - i] = tmp;
+	}
+
+	*analysis = (hgraph_analysis_t){
+		.num_nodes = num_nodes,
+		.num_levels = num_levels,
+		.max_width = max_width,
+		.total_cost = total_cost,
+		.critical_path_cost = critical_path_cost,
+		.critical_path_length = critical_path_length,
+		.critical_path = critical_path,
+		.levels = levels,
+		.finish_times = finish_times,
+		.slacks = slacks,
+	};
+
+	return required_size;
+}
@@ -0,0 +1,43 @@
+#ifndef HGRAPH_CRC_H
+#define HGRAPH_CRC_H
+
+#include "internal.h"
+
+// Checksum what goes through an underlying stream.
+// The window of the underlying stream is lent out so nothing is copied, the
+// checksum is updated over what was consumed whenever the window runs out or
+// a section ends.
+typedef struct {
+	hgraph_in_t impl;
+	hgraph_in_t* inner;
+	const char* start;
+	uint32_t crc;
+} hgraph_crc_in_t;
+
+typedef struct {
+	hgraph_out_t impl;
+	hgraph_out_t* inner;
+	char* start;
+	uint32_t crc;
+} hgraph_crc_out_t;
+
+HGRAPH_INTERNAL hgraph_in_t*
+hgraph_crc_in_init(hgraph_crc_in_t* crc_in, hgraph_in_t* inner);
+
+// Read the checksum which follows the section and start the next one.
+// The underlying stream is up to date afterward.
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_crc_in_end_section(hgraph_crc_in_t* crc_in);
+
+HGRAPH_INTERNAL hgraph_out_t*
+hgraph_crc_out_init(hgraph_crc_out_t* crc_out, hgraph_out_t* inner);
+
+// Bring the underlying stream up to date
+HGRAPH_INTERNAL void
+hgraph_crc_out_sync(hgraph_crc_out_t* crc_out);
+
+// Write the checksum of the section and start the next one
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_crc_out_end_section(hgraph_crc_out_t* crc_out);
+
+#endif
@@ -0,0 +1,125 @@
+#include "internal.h"
+#include "graph.h"
+#include "hash.h"
+
+#include <hgraph/io.h>
+
+// The digest is the wrapping sum of the hashes of all nodes so it can be
+// updated one node at a time.
+// A node hash covers its id, type, name, attributes and where each of its
+// input pins is connected from, so every edge is covered by the node it
+// leads to.
+// Attributes are hashed in their serialized form so padding and other bytes
+// which are not saved do not make equal graphs differ.
+
+typedef struct {
+	hgraph_out_t impl;
+	uint64_t hash;
+	size_t size;
+	char buffer[64];
+} hgraph_hash_out_t;
+
+HGRAPH_PRIVATE void
+hgraph_hash_out_drain(hgraph_hash_out_t* hash_out) {
+	size_t size = (size_t)(hash_out->impl.pos - hash_out->buffer);
+	hash_out->hash = hash_fnv1a_continue(hash_out->hash, hash_out->buffer, size);
+	hash_out->size += size;
+	hash_out->impl.pos = hash_out->buffer;
+}
+
+HGRAPH_PRIVATE size_t
+hgraph_hash_out_write(hgraph_out_t* impl, const void* buffer, size_t size) {
+	hgraph_hash_out_t* hash_out = HGRAPH_CONTAINER_OF(impl, hgraph_hash_out_t, impl);
+	hgraph_hash_out_drain(hash_out);
+	hash_out->hash = hash_fnv1a_continue(hash_out->hash, buffer, size);
+	hash_out->size += size;
+	return size;
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_digest_hash_value(
+	uint64_t h,
+	const hgraph_data_type_info_t* data_type,
+	const void* value
+) {
+	hgraph_hash_out_t hash_out = {
+		.impl = {
+			.write = hgraph_hash_out_write,
+			.pos = hash_out.buffer,
+			.end = hash_out.buffer + sizeof(hash_out.buffer),
+		},
+		.hash = h,
+	};
+	hgraph_io_status_t result = data_type->definition->serialize(value, &hash_out.impl);
+	hgraph_hash_out_drain(&hash_out);
+
+	// The size separates values which would otherwise run into each other
+	h = hash_fnv1a_continue(hash_out.hash, &hash_out.size, sizeof(hash_out.size));
+	return hash_fnv1a_continue(h, &result, sizeof(result));
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_digest_hash_node(
+	const hgraph_t* graph,
+	hgraph_index_t node_id,
+	const hgraph_node_t* node
+) {
+	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
+	const hgraph_data_type_info_t* data_types = graph->registry->data_types;
+
+	uint64_t h = hash_fnv1a(type_info->name.data, type_info->name.length);
+	h = hash_fnv1a_continue(h, &node_id, sizeof(node_id));
+
+	hgraph_str_t name = hgraph_name_get(graph, node->name);
+	h = hash_fnv1a_continue(h, &name.length, sizeof(name.length));
+	h = hash_fnv1a_continue(h, name.data, name.length);
+
+	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
+		const hgraph_var_t* var = &type_info->attributes[i];
+		h = hgraph_digest_hash_value(h, &data_types[var->type], (const char*)node + var->offset);
+	}
+
+	for (hgraph_index_t i = 0; i < type_info->num_input_pins; ++i) {
+		hgraph_index_t edge_id = *(const hgraph_index_t*)((const char*)node + type_info->input_pins[i].offset);
+		hgraph_index_t edge_slot = hgraph_slot_map_slot_for_id(&graph->edge_slot_map, edge_id);
+		hgraph_index_t from_pin = HGRAPH_IS_VALID_INDEX(edge_slot)
+			? hgraph_edges(graph)[edge_slot].from_pin
+			: HGRAPH_INVALID_INDEX;
+		h = hash_fnv1a_continue(h, &from_pin, sizeof(from_pin));
+	}
+
+	return hash_murmur64(h);
+}
+
+HGRAPH_INTERNAL void
+hgraph_digest_update_node(hgraph_t* graph, hgraph_index_t node_id) {
+	const hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+	HGRAPH_ASSERT(node != NULL);
+
+	uint64_t* node_hashes = hgraph_node_hashes(graph);
+	uint64_t hash = hgraph_digest_hash_node(graph, node_id, node);
+	graph->digest += hash - node_hashes[node_id];
+	node_hashes[node_id] = hash;
+	hgraph_mark_dirty(graph, &node_hashes[node_id], sizeof(uint64_t));
+}
+
+HGRAPH_INTERNAL void
+hgraph_digest_remove_node(hgraph_t* graph, hgraph_index_t node_id) {
+	uint64_t* node_hashes = hgraph_node_hashes(graph);
+	graph->digest -= node_hashes[node_id];
+	node_hashes[node_id] = 0;
+	hgraph_mark_dirty(graph, &node_hashes[node_id], sizeof(uint64_t));
+}
+
+uint64_t
+hgraph_get_digest(const hgraph_t* graph) {
+	return graph->digest;
+}
+
+uint64_t
+hgraph_get_node_hash(const hgraph_t* graph, hgraph_index_t node_id) {
+	hgraph_index_t node_slot = hgraph_slot_map_slot_for_id(&graph->node_slot_map, node_id);
+	if (!HGRAPH_IS_VALID_INDEX(node_slot)) { return 0; }
+
+	return hgraph_node_hashes(graph)[node_id];
+}
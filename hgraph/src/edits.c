@@ -0,0 +1,415 @@
+#include "internal.h"
+#include <hgraph/io.h>
+#include "graph.h"
+#include "journal.h"
+
+// The edits since a graph was saved are appended to the saved file as a
+// segment:
+//
+//   magic, size of the records (u64), records, end record
+//
+// Records are taken from the journal.
+// Like in v2, nodes are referred to by id and everything else by name so the
+// edits can be applied to a graph with another registry.
+
+static const char HGRAPH_EDITS_MAGIC[] = { 'H', 'E', 'J', 1 };
+
+typedef enum hgraph_edit_type_e {
+	HGRAPH_EDIT_END,
+	HGRAPH_EDIT_CREATE_NODE,
+	HGRAPH_EDIT_DESTROY_NODE,
+	HGRAPH_EDIT_CONNECT,
+	HGRAPH_EDIT_DISCONNECT,
+	HGRAPH_EDIT_SET_NAME,
+	HGRAPH_EDIT_SET_ATTRIBUTE,
+} hgraph_edit_type_t;
+
+typedef struct {
+	const hgraph_registry_t* registry;
+	hgraph_out_t* out;
+	hgraph_io_status_t status;
+} hgraph_edits_out_t;
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_edit_attribute(
+	const hgraph_registry_t* registry,
+	hgraph_index_t node_id,
+	const hgraph_var_t* var,
+	const void* value,
+	hgraph_out_t* out
+) {
+	const hgraph_data_type_info_t* data_type = &registry->data_types[var->type];
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(HGRAPH_EDIT_SET_ATTRIBUTE, out));
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(node_id, out));
+	HGRAPH_CHECK_IO(hgraph_io_write_str(data_type->name, out));
+	HGRAPH_CHECK_IO(hgraph_io_write_str(var->name, out));
+	return hgraph_write_value(data_type, value, out);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_edit_name(hgraph_index_t node_id, hgraph_str_t name, hgraph_out_t* out) {
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(HGRAPH_EDIT_SET_NAME, out));
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(node_id, out));
+	return hgraph_io_write_str(name, out);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_edit_node(
+	const hgraph_registry_t* registry,
+	const hgraph_journal_record_t* record,
+	bool create,
+	hgraph_out_t* out
+) {
+	if (!create) {
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(HGRAPH_EDIT_DESTROY_NODE, out));
+		return hgraph_io_write_uint(record->node.id, out);
+	}
+
+	const hgraph_node_type_info_t* type_info = &registry->node_types[record->node.type];
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(HGRAPH_EDIT_CREATE_NODE, out));
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(record->node.id, out));
+	HGRAPH_CHECK_IO(hgraph_io_write_str(type_info->name, out));
+	if (record->type == HGRAPH_JOURNAL_CREATE_NODE) { return HGRAPH_IO_OK; }
+
+	// Bring back a destroyed node from its old state
+	const char* data = hgraph_journal_record_old_data(record);
+	if (record->node.name_length > 0) {
+		HGRAPH_CHECK_IO(hgraph_write_edit_name(
+			record->node.id,
+			(hgraph_str_t){ .data = data, .length = record->node.name_length },
+			out
+		));
+	}
+
+	size_t offset = record->node.name_length;
+	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
+		const hgraph_var_t* var = &type_info->attributes[i];
+		const hgraph_data_type_info_t* data_type = &registry->data_types[var->type];
+		offset = hgraph_journal_attribute_offset(offset, data_type);
+		HGRAPH_CHECK_IO(hgraph_write_edit_attribute(
+			registry, record->node.id, var, data + offset, out
+		));
+		offset += data_type->size;
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_edit_edge(
+	const hgraph_registry_t* registry,
+	const hgraph_journal_record_t* record,
+	bool connect,
+	hgraph_out_t* out
+) {
+	bool is_output;
+	hgraph_index_t from_node_id, from_pin_index, to_node_id, to_pin_index;
+	hgraph_decode_pin_id(record->edge.from_pin, &from_node_id, &from_pin_index, &is_output);
+	hgraph_decode_pin_id(record->edge.to_pin, &to_node_id, &to_pin_index, &is_output);
+	const hgraph_node_type_info_t* from_type_info = &registry->node_types[record->edge.from_type];
+	const hgraph_node_type_info_t* to_type_info = &registry->node_types[record->edge.to_type];
+
+	if (connect) {
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(HGRAPH_EDIT_CONNECT, out));
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(from_node_id, out));
+		HGRAPH_CHECK_IO(hgraph_io_write_str(from_type_info->output_pins[from_pin_index].name, out));
+	} else {
+		// An input pin has at most one edge
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(HGRAPH_EDIT_DISCONNECT, out));
+	}
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(to_node_id, out));
+	return hgraph_io_write_str(to_type_info->input_pins[to_pin_index].name, out);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_edit_record(
+	const hgraph_registry_t* registry,
+	const hgraph_journal_record_t* record,
+	bool forward,
+	hgraph_out_t* out
+) {
+	switch ((hgraph_journal_record_type_t)record->type) {
+		case HGRAPH_JOURNAL_STEP:
+			break;
+		case HGRAPH_JOURNAL_CREATE_NODE:
+		case HGRAPH_JOURNAL_DESTROY_NODE:
+			return hgraph_write_edit_node(
+				registry,
+				record,
+				forward == (record->type == HGRAPH_JOURNAL_CREATE_NODE),
+				out
+			);
+		case HGRAPH_JOURNAL_CONNECT:
+		case HGRAPH_JOURNAL_DISCONNECT:
+			return hgraph_write_edit_edge(
+				registry,
+				record,
+				forward == (record->type == HGRAPH_JOURNAL_CONNECT),
+				out
+			);
+		case HGRAPH_JOURNAL_SET_NAME:
+			return hgraph_write_edit_name(
+				record->var.node,
+				forward
+					? (hgraph_str_t){
+						.data = hgraph_journal_record_new_data(record),
+						.length = record->new_size,
+					}
+					: (hgraph_str_t){
+						.data = hgraph_journal_record_old_data(record),
+						.length = record->old_size,
+					},
+				out
+			);
+		case HGRAPH_JOURNAL_SET_ATTRIBUTE:
+			return hgraph_write_edit_attribute(
+				registry,
+				record->var.node,
+				&registry->node_types[record->var.type].attributes[record->var.index],
+				forward
+					? hgraph_journal_record_new_data(record)
+					: hgraph_journal_record_old_data(record),
+				out
+			);
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE bool
+hgraph_write_edit(const hgraph_journal_record_t* record, bool forward, void* userdata) {
+	hgraph_edits_out_t* edits_out = userdata;
+	edits_out->status = hgraph_write_edit_record(
+		edits_out->registry, record, forward, edits_out->out
+	);
+	return edits_out->status == HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_edit_records(const hgraph_t* graph, hgraph_out_t* out) {
+	hgraph_edits_out_t edits_out = {
+		.registry = graph->registry,
+		.out = out,
+		.status = HGRAPH_IO_OK,
+	};
+	if (!hgraph_journal_iterate_unsaved(graph->journal, hgraph_write_edit, &edits_out)) {
+		return edits_out.status != HGRAPH_IO_OK ? edits_out.status : HGRAPH_IO_ERROR;
+	}
+
+	return hgraph_io_write_uint(HGRAPH_EDIT_END, out);
+}
+
+// Returns a node id which may not be in use
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_edit_node_id(const hgraph_t* graph, hgraph_index_t* node_id, hgraph_in_t* in) {
+	uint64_t id;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&id, in));
+	if (id >= (uint64_t)graph->node_slot_map.max_items) { return HGRAPH_IO_MALFORMED; }
+
+	*node_id = (hgraph_index_t)id;
+	return HGRAPH_IO_OK;
+}
+
+// Returns HGRAPH_INVALID_INDEX when either the node or the pin is unknown
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_edit_pin(
+	const hgraph_t* graph,
+	hgraph_name_kind_t kind,
+	hgraph_index_t* pin_id,
+	hgraph_in_t* in
+) {
+	hgraph_index_t node_id;
+	HGRAPH_CHECK_IO(hgraph_read_edit_node_id(graph, &node_id, in));
+
+	char name_buf[256];
+	size_t len = sizeof(name_buf) - 1;
+	HGRAPH_CHECK_IO(hgraph_io_read_str(name_buf, &len, in));
+	hgraph_str_t name = { .data = name_buf, .length = (hgraph_index_t)len };
+
+	*pin_id = HGRAPH_INVALID_INDEX;
+	const hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+	if (node == NULL) { return HGRAPH_IO_OK; }
+
+	hgraph_index_t pin_index = hgraph_registry_find_var(
+		graph->registry, hgraph_get_node_type_internal(graph, node), kind, name
+	);
+	if (HGRAPH_IS_VALID_INDEX(pin_index)) {
+		*pin_id = hgraph_encode_pin_id(node_id, pin_index, kind == HGRAPH_NAME_OUTPUT_PIN);
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_edit_create_node(hgraph_t* graph, hgraph_in_t* in) {
+	hgraph_index_t node_id;
+	HGRAPH_CHECK_IO(hgraph_read_edit_node_id(graph, &node_id, in));
+
+	char type_buf[256];
+	size_t len = sizeof(type_buf) - 1;
+	HGRAPH_CHECK_IO(hgraph_io_read_str(type_buf, &len, in));
+	hgraph_str_t type = { .data = type_buf, .length = (hgraph_index_t)len };
+
+	// Like in v2, nodes of an unknown type are skipped along with their edits
+	const hgraph_node_type_info_t* type_info = hgraph_registry_find_node_type(
+		graph->registry, type
+	);
+	if (type_info == NULL) { return HGRAPH_IO_OK; }
+
+	hgraph_index_t created_id = hgraph_create_node_with_id(graph, type_info, node_id);
+	return HGRAPH_IS_VALID_INDEX(created_id) ? HGRAPH_IO_OK : HGRAPH_IO_MALFORMED;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_edit_set_name(hgraph_t* graph, hgraph_in_t* in) {
+	hgraph_index_t node_id;
+	HGRAPH_CHECK_IO(hgraph_read_edit_node_id(graph, &node_id, in));
+
+	// Read the name straight into the free space of the name storage
+	char* name_storage = hgraph_name_reserve(graph, graph->max_name_length);
+	if (name_storage == NULL) { return HGRAPH_IO_MALFORMED; }
+	size_t name_length = graph->max_name_length;
+	HGRAPH_CHECK_IO(hgraph_io_read_str(name_storage, &name_length, in));
+	hgraph_str_t name = { .data = name_storage, .length = (hgraph_index_t)name_length };
+
+	if (hgraph_find_node_by_id(graph, node_id) == NULL) { return HGRAPH_IO_OK; }
+
+	return hgraph_set_node_name(graph, node_id, name) ? HGRAPH_IO_OK : HGRAPH_IO_MALFORMED;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_edit_set_attribute(hgraph_t* graph, hgraph_in_t* in) {
+	const hgraph_registry_t* registry = graph->registry;
+
+	hgraph_index_t node_id;
+	HGRAPH_CHECK_IO(hgraph_read_edit_node_id(graph, &node_id, in));
+
+	char type_buf[256];
+	size_t len = sizeof(type_buf) - 1;
+	HGRAPH_CHECK_IO(hgraph_io_read_str(type_buf, &len, in));
+	hgraph_str_t type = { .data = type_buf, .length = (hgraph_index_t)len };
+
+	char name_buf[256];
+	len = sizeof(name_buf) - 1;
+	HGRAPH_CHECK_IO(hgraph_io_read_str(name_buf, &len, in));
+	hgraph_str_t name = { .data = name_buf, .length = (hgraph_index_t)len };
+
+	uint64_t size;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&size, in));
+
+	hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+	const hgraph_var_t* attribute = node != NULL
+		? hgraph_find_attribute(registry, hgraph_get_node_type_internal(graph, node), type, name)
+		: NULL;
+	if (attribute == NULL) { return hgraph_io_skip(in, size); }
+
+	const hgraph_data_type_info_t* data_type = &registry->data_types[attribute->type];
+	void* value = (char*)node + attribute->offset;
+	HGRAPH_CHECK_IO(hgraph_read_value(data_type, value, size, in));
+	hgraph_mark_dirty(graph, value, data_type->size);
+	hgraph_digest_update_node(graph, node_id);
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_edit_records(hgraph_t* graph, hgraph_in_t* in) {
+	while (true) {
+		uint64_t type;
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&type, in));
+
+		switch (type) {
+			case HGRAPH_EDIT_END:
+				return HGRAPH_IO_OK;
+			case HGRAPH_EDIT_CREATE_NODE:
+				HGRAPH_CHECK_IO(hgraph_read_edit_create_node(graph, in));
+				break;
+			case HGRAPH_EDIT_DESTROY_NODE:
+				{
+					hgraph_index_t node_id;
+					HGRAPH_CHECK_IO(hgraph_read_edit_node_id(graph, &node_id, in));
+					hgraph_destroy_node(graph, node_id);
+				}
+				break;
+			case HGRAPH_EDIT_CONNECT:
+				{
+					hgraph_index_t from_pin, to_pin;
+					HGRAPH_CHECK_IO(hgraph_read_edit_pin(
+						graph, HGRAPH_NAME_OUTPUT_PIN, &from_pin, in
+					));
+					HGRAPH_CHECK_IO(hgraph_read_edit_pin(
+						graph, HGRAPH_NAME_INPUT_PIN, &to_pin, in
+					));
+					if (HGRAPH_IS_VALID_INDEX(from_pin) && HGRAPH_IS_VALID_INDEX(to_pin)) {
+						HGRAPH_CHECK_IO(hgraph_read_connect(graph, from_pin, to_pin));
+					}
+				}
+				break;
+			case HGRAPH_EDIT_DISCONNECT:
+				{
+					hgraph_index_t to_pin;
+					HGRAPH_CHECK_IO(hgraph_read_edit_pin(
+						graph, HGRAPH_NAME_INPUT_PIN, &to_pin, in
+					));
+					if (!HGRAPH_IS_VALID_INDEX(to_pin)) { break; }
+
+					bool is_output;
+					hgraph_index_t node_id, pin_index;
+					hgraph_decode_pin_id(to_pin, &node_id, &pin_index, &is_output);
+					hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+					const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(
+						graph, node
+					);
+					hgraph_index_t edge_id = *(hgraph_index_t*)(
+						(char*)node + type_info->input_pins[pin_index].offset
+					);
+					if (HGRAPH_IS_VALID_INDEX(edge_id)) {
+						hgraph_disconnect(graph, edge_id);
+					}
+				}
+				break;
+			case HGRAPH_EDIT_SET_NAME:
+				HGRAPH_CHECK_IO(hgraph_read_edit_set_name(graph, in));
+				break;
+			case HGRAPH_EDIT_SET_ATTRIBUTE:
+				HGRAPH_CHECK_IO(hgraph_read_edit_set_attribute(graph, in));
+				break;
+			default:
+				return HGRAPH_IO_MALFORMED;
+		}
+	}
+}
+
+hgraph_io_status_t
+hgraph_write_edits(const hgraph_t* graph, hgraph_out_t* out) {
+	if (!hgraph_can_append_edits(graph)) { return HGRAPH_IO_ERROR; }
+
+	// Replay the writer without output to learn the size of the segment.
+	// It only holds what changed since the last save, so the extra pass is
+	// cheap.
+	hgraph_measure_out_t measure;
+	hgraph_out_t* measure_out = hgraph_measure_out_init(&measure);
+	HGRAPH_CHECK_IO(hgraph_write_edit_records(graph, measure_out));
+
+	HGRAPH_CHECK_IO(hgraph_io_write(out, HGRAPH_EDITS_MAGIC, sizeof(HGRAPH_EDITS_MAGIC)));
+	HGRAPH_CHECK_IO(hgraph_io_write_u64(hgraph_measure_out_size(measure_out), out));
+	return hgraph_write_edit_records(graph, out);
+}
+
+hgraph_io_status_t
+hgraph_read_edits_header(uint64_t* size, hgraph_in_t* in) {
+	char magic[sizeof(HGRAPH_EDITS_MAGIC)];
+	HGRAPH_CHECK_IO(hgraph_io_read(in, magic, sizeof(magic)));
+	if (memcmp(magic, HGRAPH_EDITS_MAGIC, sizeof(magic)) != 0) {
+		return HGRAPH_IO_MALFORMED;
+	}
+
+	return hgraph_io_read_u64(size, in);
+}
+
+hgraph_io_status_t
+hgraph_read_edits(hgraph_t* graph, hgraph_in_t* in) {
+	hgraph_write_begin(graph);
+	hgraph_io_status_t records_status = hgraph_read_edit_records(graph, in);
+	hgraph_write_end(graph);
+	return records_status;
+}
@@ -0,0 +1,518 @@
+#include <hgraph/file.h>
+#include <hgraph/stream.h>
+#include <hgraph/io.h>
+#include "internal.h"
+#include "graph.h"
+#include <stdatomic.h>
+
+// See hgraph_write_graph_v3 for the layout of the index
+#define HGRAPH_FILE_TRAILER_SIZE (sizeof(uint64_t) + INDEX_MAGIC_SIZE)
+#define HGRAPH_FILE_NODES_PER_TASK 64
+
+typedef struct {
+	const hgraph_file_t* file;
+	hgraph_t* graph;
+	// The first failure of any task
+	atomic_int status;
+} hgraph_file_load_ctx_t;
+
+// Entries are validated when the file is opened
+HGRAPH_PRIVATE uint64_t
+hgraph_file_entry(const hgraph_file_t* file, uint64_t entry) {
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(
+		&stream,
+		file->index + entry * sizeof(uint64_t),
+		sizeof(uint64_t)
+	);
+
+	uint64_t value = 0;
+	hgraph_io_read_u64(&value, in);
+	return value;
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_file_group_size(uint64_t num_nodes, uint64_t num_attributes) {
+	return 3 + num_nodes + num_attributes * (1 + num_nodes);
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_file_next_group(const hgraph_file_t* file, uint64_t entry) {
+	return entry + hgraph_file_group_size(
+		hgraph_file_entry(file, entry + 1),
+		hgraph_file_entry(file, entry + 2)
+	);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_find_group(const hgraph_file_t* file, hgraph_index_t group, uint64_t* entry) {
+	if (group < 0 || group >= file->num_groups) { return HGRAPH_IO_ERROR; }
+
+	*entry = 1;
+	for (hgraph_index_t i = 0; i < group; ++i) {
+		*entry = hgraph_file_next_group(file, *entry);
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_seek(
+	const hgraph_file_t* file,
+	uint64_t offset,
+	hgraph_stream_in_t* stream,
+	hgraph_in_t** in
+) {
+	if (offset > file->graph_size) { return HGRAPH_IO_MALFORMED; }
+
+	*in = hgraph_stream_in_init_mem(
+		stream,
+		file->graph + offset,
+		file->graph_size - (size_t)offset
+	);
+	return HGRAPH_IO_OK;
+}
+
+// The string is not copied, it points into the file
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_read_str(hgraph_str_t* str, hgraph_in_t* in) {
+	uint64_t length;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&length, in));
+	if (length > hgraph_io_available(in) || length > INT32_MAX) {
+		return HGRAPH_IO_MALFORMED;
+	}
+
+	str->data = in->pos;
+	str->length = (hgraph_index_t)length;
+	in->pos += length;
+	return HGRAPH_IO_OK;
+}
+
+hgraph_io_status_t
+hgraph_file_open(hgraph_file_t* file, const void* data, size_t size) {
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&stream, data, size);
+	hgraph_header_t header;
+	HGRAPH_CHECK_IO(hgraph_read_header(&header, in));
+	if (header.version < 2 || header.compressed) { return HGRAPH_IO_MALFORMED; }
+
+	size_t header_size = size - hgraph_io_available(in);
+	if (size - header_size < HGRAPH_FILE_TRAILER_SIZE) { return HGRAPH_IO_MALFORMED; }
+
+	const char* trailer = (const char*)data + size - HGRAPH_FILE_TRAILER_SIZE;
+	if (memcmp(trailer + sizeof(uint64_t), INDEX_MAGIC, INDEX_MAGIC_SIZE) != 0) {
+		return HGRAPH_IO_MALFORMED;
+	}
+
+	uint64_t graph_size;
+	in = hgraph_stream_in_init_mem(&stream, trailer, sizeof(uint64_t));
+	HGRAPH_CHECK_IO(hgraph_io_read_u64(&graph_size, in));
+	size_t sections_size = size - header_size - HGRAPH_FILE_TRAILER_SIZE;
+	if (graph_size > sections_size) { return HGRAPH_IO_MALFORMED; }
+
+	file->version = header.version;
+	file->graph = (const char*)data + header_size;
+	file->graph_size = (size_t)graph_size;
+	file->index = file->graph + graph_size;
+	file->index_size = sections_size - (size_t)graph_size;
+	if (file->index_size % sizeof(uint64_t) != 0) { return HGRAPH_IO_MALFORMED; }
+
+	// Check that the groups add up to the size of the index so they can be
+	// walked without checks later
+	uint64_t num_entries = file->index_size / sizeof(uint64_t);
+	if (num_entries < 1) { return HGRAPH_IO_MALFORMED; }
+
+	uint64_t num_groups = hgraph_file_entry(file, 0);
+	uint64_t num_nodes = 0;
+	uint64_t entry = 1;
+	for (uint64_t i = 0; i < num_groups; ++i) {
+		if (num_entries - entry < 3) { return HGRAPH_IO_MALFORMED; }
+
+		uint64_t group_num_nodes = hgraph_file_entry(file, entry + 1);
+		uint64_t group_num_attributes = hgraph_file_entry(file, entry + 2);
+		if (
+			group_num_nodes >= num_entries
+			|| group_num_attributes >= num_entries
+			|| (
+				group_num_attributes > 0
+				&& 1 + group_num_nodes > num_entries / group_num_attributes
+			)
+		) {
+			return HGRAPH_IO_MALFORMED;
+		}
+
+		uint64_t group_size = hgraph_file_group_size(group_num_nodes, group_num_attributes);
+		if (group_size > num_entries - entry) { return HGRAPH_IO_MALFORMED; }
+
+		entry += group_size;
+		num_nodes += group_num_nodes;
+	}
+
+	// Followed by the edges offset and count
+	if (num_entries - entry != 2) { return HGRAPH_IO_MALFORMED; }
+
+	uint64_t num_edges = hgraph_file_entry(file, entry + 1);
+	if (num_nodes > INT32_MAX || num_edges > INT32_MAX) { return HGRAPH_IO_MALFORMED; }
+
+	file->num_groups = (hgraph_index_t)num_groups;
+	file->num_nodes = (hgraph_index_t)num_nodes;
+	file->num_edges = (hgraph_index_t)num_edges;
+	return HGRAPH_IO_OK;
+}
+
+hgraph_file_info_t
+hgraph_file_get_info(const hgraph_file_t* file) {
+	return (hgraph_file_info_t){
+		.num_groups = file->num_groups,
+		.num_nodes = file->num_nodes,
+		.num_edges = file->num_edges,
+	};
+}
+
+hgraph_io_status_t
+hgraph_file_get_config(const hgraph_file_t* file, hgraph_config_t* config) {
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&stream, file->graph, file->graph_size);
+	hgraph_header_t header = { .version = file->version };
+	return hgraph_read_graph_config(&header, config, in);
+}
+
+hgraph_io_status_t
+hgraph_file_get_group(
+	const hgraph_file_t* file,
+	hgraph_index_t group,
+	hgraph_file_group_t* info
+) {
+	uint64_t entry;
+	HGRAPH_CHECK_IO(hgraph_file_find_group(file, group, &entry));
+
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in;
+	HGRAPH_CHECK_IO(hgraph_file_seek(file, hgraph_file_entry(file, entry), &stream, &in));
+	HGRAPH_CHECK_IO(hgraph_file_read_str(&info->type, in));
+	info->num_nodes = (hgraph_index_t)hgraph_file_entry(file, entry + 1);
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_read_node_info(
+	const hgraph_file_t* file,
+	uint64_t entry,
+	uint64_t index,
+	hgraph_file_node_t* info
+) {
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in;
+	HGRAPH_CHECK_IO(hgraph_file_seek(file, hgraph_file_entry(file, entry + 3 + index), &stream, &in));
+
+	uint64_t node_id;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&node_id, in));
+	if (node_id > INT32_MAX) { return HGRAPH_IO_MALFORMED; }
+	info->id = (hgraph_index_t)node_id;
+	return hgraph_file_read_str(&info->name, in);
+}
+
+hgraph_io_status_t
+hgraph_file_get_node(
+	const hgraph_file_t* file,
+	hgraph_index_t group,
+	hgraph_index_t index,
+	hgraph_file_node_t* info
+) {
+	uint64_t entry;
+	HGRAPH_CHECK_IO(hgraph_file_find_group(file, group, &entry));
+	uint64_t num_nodes = hgraph_file_entry(file, entry + 1);
+	if (index < 0 || (uint64_t)index >= num_nodes) { return HGRAPH_IO_ERROR; }
+
+	return hgraph_file_read_node_info(file, entry, (uint64_t)index, info);
+}
+
+// Decode the attributes of the nodes in [begin, end) of a group.
+// Only the memory of those nodes is written to so disjoint ranges can be
+// decoded concurrently, marking the nodes as changed is left to the caller.
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_read_attributes(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	const hgraph_node_type_info_t* type_info,
+	uint64_t entry,
+	uint64_t begin,
+	uint64_t end
+) {
+	const hgraph_registry_t* registry = graph->registry;
+	uint64_t num_nodes = hgraph_file_entry(file, entry + 1);
+	uint64_t num_attributes = hgraph_file_entry(file, entry + 2);
+
+	for (uint64_t i = 0; i < num_attributes; ++i) {
+		uint64_t column_entry = entry + 3 + num_nodes + i * (1 + num_nodes);
+
+		hgraph_stream_in_t stream;
+		hgraph_in_t* in;
+		hgraph_str_t type, name;
+		HGRAPH_CHECK_IO(hgraph_file_seek(
+			file, hgraph_file_entry(file, column_entry), &stream, &in
+		));
+		HGRAPH_CHECK_IO(hgraph_file_read_str(&type, in));
+		HGRAPH_CHECK_IO(hgraph_file_read_str(&name, in));
+
+		const hgraph_var_t* attribute = hgraph_find_attribute(registry, type_info, type, name);
+		if (attribute == NULL) { continue; }
+
+		for (uint64_t j = begin; j < end; ++j) {
+			hgraph_file_node_t node_info;
+			HGRAPH_CHECK_IO(hgraph_file_read_node_info(file, entry, j, &node_info));
+			hgraph_node_t* node = hgraph_find_node_by_id(graph, node_info.id);
+			if (node == NULL) { return HGRAPH_IO_MALFORMED; }
+
+			uint64_t size;
+			HGRAPH_CHECK_IO(hgraph_file_seek(
+				file, hgraph_file_entry(file, column_entry + 1 + j), &stream, &in
+			));
+			HGRAPH_CHECK_IO(hgraph_io_read_uint(&size, in));
+			HGRAPH_CHECK_IO(hgraph_read_value(
+				&registry->data_types[attribute->type],
+				(char*)node + attribute->offset,
+				size,
+				in
+			));
+		}
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_create_node(
+	hgraph_t* graph,
+	const hgraph_node_type_info_t* type_info,
+	const hgraph_file_node_t* node_info
+) {
+	if (node_info->id >= graph->node_slot_map.max_items) { return HGRAPH_IO_MALFORMED; }
+
+	hgraph_index_t created_id = hgraph_create_node_with_id(graph, type_info, node_info->id);
+	if (!HGRAPH_IS_VALID_INDEX(created_id)) { return HGRAPH_IO_MALFORMED; }
+	if (!hgraph_set_node_name(graph, created_id, node_info->name)) {
+		return HGRAPH_IO_MALFORMED;
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE void
+hgraph_file_finish_node(hgraph_t* graph, hgraph_index_t node_id) {
+	hgraph_mark_node_dirty(graph, hgraph_find_node_by_id(graph, node_id));
+	hgraph_digest_update_node(graph, node_id);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_read_node(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	const hgraph_node_type_info_t* type_info,
+	uint64_t entry,
+	hgraph_index_t index,
+	const hgraph_file_node_t* node_info
+) {
+	HGRAPH_CHECK_IO(hgraph_file_create_node(graph, type_info, node_info));
+	HGRAPH_CHECK_IO(hgraph_file_read_attributes(
+		file, graph, type_info, entry, (uint64_t)index, (uint64_t)index + 1
+	));
+	hgraph_file_finish_node(graph, node_info->id);
+
+	return HGRAPH_IO_OK;
+}
+
+hgraph_io_status_t
+hgraph_file_load_node(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	hgraph_index_t group,
+	hgraph_index_t index,
+	hgraph_index_t* node_id
+) {
+	*node_id = HGRAPH_INVALID_INDEX;
+
+	hgraph_file_node_t node_info;
+	HGRAPH_CHECK_IO(hgraph_file_get_node(file, group, index, &node_info));
+
+	uint64_t entry;
+	HGRAPH_CHECK_IO(hgraph_file_find_group(file, group, &entry));
+
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in;
+	HGRAPH_CHECK_IO(hgraph_file_seek(file, hgraph_file_entry(file, entry), &stream, &in));
+	const hgraph_node_type_info_t* type_info;
+	HGRAPH_CHECK_IO(hgraph_read_group_header_v2(graph, &type_info, in));
+	if (type_info == NULL) { return HGRAPH_IO_OK; }
+
+	hgraph_write_begin(graph);
+	hgraph_io_status_t node_status = hgraph_file_read_node(
+		file, graph, type_info, entry, index, &node_info
+	);
+	hgraph_write_end(graph);
+	HGRAPH_CHECK_IO(node_status);
+
+	*node_id = node_info.id;
+	return HGRAPH_IO_OK;
+}
+
+hgraph_io_status_t
+hgraph_file_load_edges(const hgraph_file_t* file, hgraph_t* graph) {
+	// Edges refer to pins by their index in the group headers
+	hgraph_reset_pin_remaps_v2(graph);
+
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in;
+	uint64_t entry = 1;
+	for (hgraph_index_t i = 0; i < file->num_groups; ++i) {
+		HGRAPH_CHECK_IO(hgraph_file_seek(file, hgraph_file_entry(file, entry), &stream, &in));
+		const hgraph_node_type_info_t* type_info;
+		HGRAPH_CHECK_IO(hgraph_read_group_header_v2(graph, &type_info, in));
+		entry = hgraph_file_next_group(file, entry);
+	}
+
+	HGRAPH_CHECK_IO(hgraph_file_seek(file, hgraph_file_entry(file, entry), &stream, &in));
+	return hgraph_read_edges_v2(graph, in);
+}
+
+HGRAPH_PRIVATE hgraph_index_t
+hgraph_file_num_tasks(uint64_t num_nodes) {
+	return (hgraph_index_t)(
+		(num_nodes + HGRAPH_FILE_NODES_PER_TASK - 1) / HGRAPH_FILE_NODES_PER_TASK
+	);
+}
+
+// Create the nodes of every known type so the tasks only fill them in
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_create_nodes(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	hgraph_index_t* num_tasks
+) {
+	*num_tasks = 0;
+	uint64_t entry = 1;
+	for (hgraph_index_t i = 0; i < file->num_groups; ++i) {
+		hgraph_stream_in_t stream;
+		hgraph_in_t* in;
+		HGRAPH_CHECK_IO(hgraph_file_seek(file, hgraph_file_entry(file, entry), &stream, &in));
+		const hgraph_node_type_info_t* type_info;
+		HGRAPH_CHECK_IO(hgraph_read_group_header_v2(graph, &type_info, in));
+
+		uint64_t num_nodes = hgraph_file_entry(file, entry + 1);
+		*num_tasks += hgraph_file_num_tasks(num_nodes);
+		for (uint64_t j = 0; type_info != NULL && j < num_nodes; ++j) {
+			hgraph_file_node_t node_info;
+			HGRAPH_CHECK_IO(hgraph_file_read_node_info(file, entry, j, &node_info));
+			HGRAPH_CHECK_IO(hgraph_file_create_node(graph, type_info, &node_info));
+		}
+
+		entry = hgraph_file_next_group(file, entry);
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE void
+hgraph_file_load_task(void* task_data, hgraph_index_t task) {
+	hgraph_file_load_ctx_t* ctx = task_data;
+	const hgraph_file_t* file = ctx->file;
+	hgraph_t* graph = ctx->graph;
+
+	// Tasks are numbered through the groups in order
+	uint64_t entry = 1;
+	hgraph_index_t first_task = 0;
+	for (hgraph_index_t i = 0; i < file->num_groups; ++i) {
+		uint64_t num_nodes = hgraph_file_entry(file, entry + 1);
+		hgraph_index_t num_tasks = hgraph_file_num_tasks(num_nodes);
+		if (task >= first_task + num_tasks) {
+			first_task += num_tasks;
+			entry = hgraph_file_next_group(file, entry);
+			continue;
+		}
+
+		uint64_t begin = (uint64_t)(task - first_task) * HGRAPH_FILE_NODES_PER_TASK;
+		uint64_t end = HGRAPH_MIN(begin + HGRAPH_FILE_NODES_PER_TASK, num_nodes);
+
+		// Nodes were only created for a known type
+		hgraph_file_node_t node_info;
+		hgraph_io_status_t task_status = hgraph_file_read_node_info(file, entry, begin, &node_info);
+		if (task_status == HGRAPH_IO_OK) {
+			const hgraph_node_t* node = hgraph_find_node_by_id(graph, node_info.id);
+			if (node == NULL) { return; }
+
+			task_status = hgraph_file_read_attributes(
+				file,
+				graph,
+				&graph->registry->node_types[node->type],
+				entry,
+				begin,
+				end
+			);
+		}
+
+		if (task_status != HGRAPH_IO_OK) {
+			int expected = HGRAPH_IO_OK;
+			atomic_compare_exchange_strong(&ctx->status, &expected, (int)task_status);
+		}
+		return;
+	}
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_finish_nodes(const hgraph_file_t* file, hgraph_t* graph) {
+	uint64_t entry = 1;
+	for (hgraph_index_t i = 0; i < file->num_groups; ++i) {
+		uint64_t num_nodes = hgraph_file_entry(file, entry + 1);
+		for (uint64_t j = 0; j < num_nodes; ++j) {
+			hgraph_file_node_t node_info;
+			HGRAPH_CHECK_IO(hgraph_file_read_node_info(file, entry, j, &node_info));
+			// Nodes of an unknown type were not created
+			if (hgraph_find_node_by_id(graph, node_info.id) == NULL) { break; }
+
+			hgraph_file_finish_node(graph, node_info.id);
+		}
+
+		entry = hgraph_file_next_group(file, entry);
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_file_read_nodes_parallel(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	hgraph_parallel_for_t parallel_for,
+	void* userdata
+) {
+	hgraph_index_t num_tasks;
+	HGRAPH_CHECK_IO(hgraph_file_create_nodes(file, graph, &num_tasks));
+
+	hgraph_file_load_ctx_t ctx = {
+		.file = file,
+		.graph = graph,
+	};
+	atomic_init(&ctx.status, HGRAPH_IO_OK);
+	parallel_for(hgraph_file_load_task, &ctx, num_tasks, userdata);
+	HGRAPH_CHECK_IO((hgraph_io_status_t)atomic_load(&ctx.status));
+
+	return hgraph_file_finish_nodes(file, graph);
+}
+
+hgraph_io_status_t
+hgraph_read_graph_parallel(
+	const hgraph_file_t* file,
+	hgraph_t* graph,
+	hgraph_parallel_for_t parallel_for,
+	void* userdata
+) {
+	hgraph_write_begin(graph);
+	hgraph_io_status_t nodes_status = hgraph_file_read_nodes_parallel(
+		file, graph, parallel_for, userdata
+	);
+	hgraph_write_end(graph);
+	HGRAPH_CHECK_IO(nodes_status);
+
+	return hgraph_file_load_edges(file, graph);
+}
@@ -1,7 +1,12 @@
 #include "internal.h"
 #include "mem_layout.h"
 #include "ptr_table.h"
+#include "graph.h"
+#include "journal.h"
 #include <string.h>
+#include <stdatomic.h>
+
+static atomic_uint_least64_t hgraph_next_instance = 1;
 
 HGRAPH_INTERNAL const hgraph_node_type_info_t*
 hgraph_get_node_type_internal(
@@ -19,23 +24,17 @@ hgraph_find_node_by_id(
 	hgraph_index_t node_slot = hgraph_slot_map_slot_for_id(&graph->node_slot_map, node_id);
 	if (!HGRAPH_IS_VALID_INDEX(node_slot)) { return NULL; }
 
-	return (hgraph_node_t*)(graph->nodes + graph->node_size * node_slot);
+	return (hgraph_node_t*)(hgraph_nodes(graph) + graph->node_size * node_slot);
 }
 
 HGRAPH_INTERNAL hgraph_node_t*
 hgraph_get_node_by_slot(const hgraph_t* graph, hgraph_index_t slot) {
-	return (hgraph_node_t*)(graph->nodes + graph->node_size * slot);
+	return (hgraph_node_t*)(hgraph_nodes(graph) + graph->node_size * slot);
 }
 
 HGRAPH_INTERNAL hgraph_str_t
 hgraph_get_node_name_internal(const hgraph_t* graph, const hgraph_node_t* node) {
-	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
-
-	char* name_storage = (char*)node + type_info->size;
-	return (hgraph_str_t){
-		.data = name_storage,
-		.length = node->name_len,
-	};
+	return hgraph_name_get(graph, node->name);
 }
 
 HGRAPH_INTERNAL hgraph_index_t
@@ -70,7 +69,176 @@ hgraph_resolve_edge(
 		edge_id
 	);
 
-	return HGRAPH_IS_VALID_INDEX(slot) ? &graph->edges[slot].output_pin_link : pin;
+	return HGRAPH_IS_VALID_INDEX(slot) ? &hgraph_edges(graph)[slot].output_pin_link : pin;
+}
+
+HGRAPH_INTERNAL uint64_t
+hgraph_new_instance(void) {
+	return atomic_fetch_add(&hgraph_next_instance, 1);
+}
+
+HGRAPH_INTERNAL void
+hgraph_mark_dirty(hgraph_t* graph, const void* ptr, size_t size) {
+	if (size == 0) { return; }
+
+	ptrdiff_t offset = (const char*)ptr - ((char*)graph + graph->body_offset);
+	HGRAPH_ASSERT(0 <= offset && (size_t)offset + size <= graph->body_size);
+
+	size_t first_chunk = (size_t)offset / HGRAPH_CHUNK_SIZE;
+	size_t last_chunk = ((size_t)offset + size - 1) / HGRAPH_CHUNK_SIZE;
+	uint64_t revision = ++graph->revision;
+	for (size_t i = first_chunk; i <= last_chunk; ++i) {
+		hgraph_chunk_revisions(graph)[i] = revision;
+	}
+}
+
+HGRAPH_INTERNAL void
+hgraph_mark_node_dirty(hgraph_t* graph, const hgraph_node_t* node) {
+	hgraph_mark_dirty(graph, node, graph->node_size);
+}
+
+HGRAPH_INTERNAL void
+hgraph_mark_slot_dirty(
+	hgraph_t* graph,
+	const hgraph_slot_map_t* slot_map,
+	hgraph_index_t slot
+) {
+	hgraph_index_t* ids_for_slot = hgraph_slot_map_ids_for_slot(slot_map);
+	hgraph_index_t* slots_for_id = hgraph_slot_map_slots_for_id(slot_map);
+	hgraph_index_t id = ids_for_slot[slot];
+	hgraph_mark_dirty(graph, &ids_for_slot[slot], sizeof(hgraph_index_t));
+	hgraph_mark_dirty(graph, &slots_for_id[id], sizeof(hgraph_index_t));
+}
+
+HGRAPH_PRIVATE void
+hgraph_type_list_set_next(
+	hgraph_t* graph,
+	hgraph_index_t type,
+	hgraph_index_t node_id,
+	hgraph_index_t next
+) {
+	hgraph_index_t* target = HGRAPH_IS_VALID_INDEX(node_id)
+		? &hgraph_type_links(graph)[node_id].next
+		: &hgraph_type_heads(graph)[type];
+	*target = next;
+	hgraph_mark_dirty(graph, target, sizeof(hgraph_index_t));
+}
+
+HGRAPH_PRIVATE void
+hgraph_type_list_set_prev(
+	hgraph_t* graph,
+	hgraph_index_t node_id,
+	hgraph_index_t prev
+) {
+	if (!HGRAPH_IS_VALID_INDEX(node_id)) { return; }
+
+	hgraph_index_t* target = &hgraph_type_links(graph)[node_id].prev;
+	*target = prev;
+	hgraph_mark_dirty(graph, target, sizeof(hgraph_index_t));
+}
+
+HGRAPH_PRIVATE void
+hgraph_type_list_add(hgraph_t* graph, hgraph_index_t type, hgraph_index_t node_id) {
+	hgraph_node_link_t* link = &hgraph_type_links(graph)[node_id];
+	link->prev = HGRAPH_INVALID_INDEX;
+	link->next = hgraph_type_heads(graph)[type];
+	hgraph_mark_dirty(graph, link, sizeof(*link));
+
+	hgraph_type_list_set_prev(graph, link->next, node_id);
+	hgraph_type_list_set_next(graph, type, HGRAPH_INVALID_INDEX, node_id);
+}
+
+HGRAPH_PRIVATE void
+hgraph_type_list_remove(hgraph_t* graph, hgraph_index_t type, hgraph_index_t node_id) {
+	hgraph_node_link_t link = hgraph_type_links(graph)[node_id];
+	hgraph_type_list_set_next(graph, type, link.prev, link.next);
+	hgraph_type_list_set_prev(graph, link.next, link.prev);
+}
+
+HGRAPH_PRIVATE void
+hgraph_type_list_move(
+	hgraph_t* graph,
+	hgraph_index_t type,
+	hgraph_index_t old_node_id,
+	hgraph_index_t new_node_id
+) {
+	hgraph_node_link_t* links = hgraph_type_links(graph);
+	hgraph_node_link_t link = links[old_node_id];
+	links[new_node_id] = link;
+	hgraph_mark_dirty(graph, &links[new_node_id], sizeof(link));
+
+	hgraph_type_list_set_next(graph, type, link.prev, new_node_id);
+	hgraph_type_list_set_prev(graph, link.next, new_node_id);
+}
+
+HGRAPH_INTERNAL void
+hgraph_swap_id(
+	hgraph_t* graph,
+	hgraph_slot_map_t* slot_map,
+	hgraph_index_t occupied_id,
+	hgraph_index_t vacant_id
+) {
+	hgraph_slot_map_swap_id(slot_map, occupied_id, vacant_id);
+	if (slot_map == &graph->node_slot_map) {
+		hgraph_digest_remove_node(graph, occupied_id);
+		hgraph_digest_update_node(graph, vacant_id);
+		hgraph_order_move_node(graph, occupied_id, vacant_id);
+		hgraph_type_list_move(
+			graph,
+			hgraph_find_node_by_id(graph, vacant_id)->type,
+			occupied_id,
+			vacant_id
+		);
+	}
+	hgraph_index_t* slots_for_id = hgraph_slot_map_slots_for_id(slot_map);
+	hgraph_mark_slot_dirty(graph, slot_map, slots_for_id[occupied_id]);
+	hgraph_mark_slot_dirty(graph, slot_map, slots_for_id[vacant_id]);
+}
+
+HGRAPH_INTERNAL void
+hgraph_write_begin(hgraph_t* graph) {
+	if (graph->write_depth++ > 0) { return; }
+
+	uint_least32_t sequence = atomic_load_explicit(&graph->sequence, memory_order_relaxed);
+	atomic_store_explicit(&graph->sequence, sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+HGRAPH_INTERNAL void
+hgraph_write_end(hgraph_t* graph) {
+	HGRAPH_ASSERT(graph->write_depth > 0);
+	if (--graph->write_depth > 0) { return; }
+
+	uint_least32_t sequence = atomic_load_explicit(&graph->sequence, memory_order_relaxed);
+	atomic_store_explicit(&graph->sequence, sequence + 1, memory_order_release);
+}
+
+HGRAPH_PRIVATE void
+hgraph_mutation_begin(hgraph_t* graph) {
+	hgraph_write_begin(graph);
+	if (graph->journal != NULL) {
+		hgraph_journal_begin_step(graph->journal);
+	}
+}
+
+HGRAPH_PRIVATE void
+hgraph_mutation_end(hgraph_t* graph) {
+	if (graph->journal != NULL) {
+		hgraph_journal_end_step(graph->journal);
+	}
+	hgraph_write_end(graph);
+}
+
+HGRAPH_PRIVATE void
+hgraph_record(
+	hgraph_t* graph,
+	hgraph_journal_record_t record,
+	const void* old_data,
+	const void* new_data
+) {
+	if (graph->journal != NULL) {
+		hgraph_journal_write(graph->journal, record, old_data, new_data);
+	}
 }
 
 size_t
@@ -83,8 +251,9 @@ hgraph_init(hgraph_t* graph, size_t size, const hgraph_config_t* config) {
 	);
 
 	const hgraph_registry_t* registry = config->registry;
-	size_t node_size = registry->max_node_size + config->max_name_length + 1;
-	node_size = mem_layout_align_ptr((intptr_t)node_size, _Alignof(max_align_t));
+	size_t node_size = mem_layout_align_ptr(
+		(intptr_t)registry->max_node_size, _Alignof(max_align_t)
+	);
 	ptrdiff_t nodes_offset = mem_layout_reserve(
 		&layout,
 		node_size * config->max_nodes,
@@ -106,18 +275,121 @@ hgraph_init(hgraph_t* graph, size_t size, const hgraph_config_t* config) {
 		_Alignof(hgraph_edge_t)
 	);
 
+	ptrdiff_t node_orders_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * config->max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t ordered_nodes_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * config->max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+
+	ptrdiff_t node_hashes_offset = mem_layout_reserve(
+		&layout,
+		sizeof(uint64_t) * config->max_nodes,
+		_Alignof(uint64_t)
+	);
+
+	ptrdiff_t type_heads_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * registry->num_node_types,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t type_links_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_node_link_t) * config->max_nodes,
+		_Alignof(hgraph_node_link_t)
+	);
+
+	// Most names are far shorter than the limit and compacting reclaims the
+	// space of dead ones, so only a single name of the maximum length is kept
+	// room for
+	hgraph_index_t name_storage_size = config->name_storage_size > 0
+		? config->name_storage_size
+		: config->max_nodes * hgraph_name_entry_size(HGRAPH_DEFAULT_NAME_LENGTH)
+			+ hgraph_name_entry_size(config->max_name_length);
+	ptrdiff_t name_table_offset = hgraph_name_table_reserve(&layout, config->max_nodes);
+	ptrdiff_t name_storage_offset = mem_layout_reserve(
+		&layout,
+		name_storage_size,
+		_Alignof(hgraph_name_t)
+	);
+
+	// Chunk revisions are not part of the body and are never copied
+	size_t body_size = mem_layout_size(&layout) - (size_t)nodes_offset;
+	size_t num_chunks = (body_size + HGRAPH_CHUNK_SIZE - 1) / HGRAPH_CHUNK_SIZE;
+	ptrdiff_t chunk_revisions_offset = mem_layout_reserve(
+		&layout,
+		sizeof(uint64_t) * num_chunks,
+		_Alignof(uint64_t)
+	);
+
+	ptrdiff_t order_marks_offset = mem_layout_reserve(
+		&layout,
+		sizeof(uint8_t) * config->max_nodes,
+		_Alignof(uint8_t)
+	);
+	ptrdiff_t order_stack_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * config->max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t order_affected_nodes_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * config->max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t order_affected_positions_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * config->max_nodes,
+		_Alignof(hgraph_index_t)
+	);
+
+	ptrdiff_t pin_remaps_offset = mem_layout_reserve(
+		&layout,
+		sizeof(int8_t) * registry->num_node_types * HGRAPH_MAX_PINS * 2,
+		_Alignof(int8_t)
+	);
+
 	size_t required_size = mem_layout_size(&layout);
 	if (graph == NULL || size < required_size) { return required_size; }
 
 	*graph = (hgraph_t){
 		.registry = registry,
 		.max_name_length = config->max_name_length,
+		.size = required_size,
 		.node_size = node_size,
-		.node_versions = mem_layout_locate(graph, node_versions_offset),
-		.nodes = mem_layout_locate(graph, nodes_offset),
-		.edges = mem_layout_locate(graph, edges_offset),
+		.node_versions_offset = node_versions_offset,
+		.nodes_offset = nodes_offset,
+		.edges_offset = edges_offset,
+		.node_orders_offset = node_orders_offset,
+		.ordered_nodes_offset = ordered_nodes_offset,
+		.order_marks_offset = order_marks_offset,
+		.order_stack_offset = order_stack_offset,
+		.order_affected_nodes_offset = order_affected_nodes_offset,
+		.order_affected_positions_offset = order_affected_positions_offset,
+		.pin_remaps_offset = pin_remaps_offset,
+		.type_heads_offset = type_heads_offset,
+		.type_links_offset = type_links_offset,
+		.node_hashes_offset = node_hashes_offset,
+		.name_storage_size = name_storage_size,
+		.name_storage_offset = name_storage_offset,
+		.name_table_offset = name_table_offset,
+		.instance = hgraph_new_instance(),
+		.body_offset = nodes_offset,
+		.body_size = body_size,
+		.chunk_revisions_offset = chunk_revisions_offset,
 	};
-	memset(graph->node_versions, 0, sizeof(hgraph_index_t) * config->max_nodes);
+	memset(hgraph_node_versions(graph), 0, sizeof(hgraph_index_t) * config->max_nodes);
+	memset(hgraph_node_hashes(graph), 0, sizeof(uint64_t) * config->max_nodes);
+	memset(hgraph_chunk_revisions(graph), 0, sizeof(uint64_t) * num_chunks);
+	memset(hgraph_order_marks(graph), 0, sizeof(uint8_t) * config->max_nodes);
+	for (hgraph_index_t i = 0; i < registry->num_node_types; ++i) {
+		hgraph_type_heads(graph)[i] = HGRAPH_INVALID_INDEX;
+	}
+	hgraph_name_init(graph, config->max_nodes);
 	hgraph_slot_map_init(
 		&graph->node_slot_map,
 		config->max_nodes,
@@ -132,24 +404,55 @@ hgraph_init(hgraph_t* graph, size_t size, const hgraph_config_t* config) {
 	return required_size;
 }
 
-hgraph_index_t
-hgraph_create_node(hgraph_t* graph, const hgraph_node_type_t* type) {
+size_t
+hgraph_copy(hgraph_t* dst, size_t size, const hgraph_t* src) {
+	if (dst == NULL || size < src->size) { return src->size; }
+
+	memcpy(dst, src, src->size);
+	// The copy has its own write history
+	dst->instance = hgraph_new_instance();
+	dst->journal = NULL;
+
+	return src->size;
+}
+
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_create_node_with_id(
+	hgraph_t* graph,
+	const hgraph_node_type_info_t* type_info,
+	hgraph_index_t node_id
+) {
 	const hgraph_registry_t* registry = graph->registry;
-	const hgraph_node_type_info_t* type_info = hgraph_ptr_table_lookup(&registry->node_type_by_definition, type);
-	if (type_info == NULL) { return HGRAPH_INVALID_INDEX; }
+	const hgraph_node_type_t* type = type_info->definition;
 
-	hgraph_index_t node_id, node_slot;
-	hgraph_slot_map_allocate(
-		&graph->node_slot_map,
-		&node_id,
-		&node_slot
-	);
-	if (!HGRAPH_IS_VALID_INDEX(node_id)) { return HGRAPH_INVALID_INDEX; }
+	hgraph_index_t node_slot;
+	if (HGRAPH_IS_VALID_INDEX(node_id)) {
+		hgraph_index_t vacant_slot = hgraph_slot_map_slot_for_id(&graph->node_slot_map, node_id);
+		if (HGRAPH_IS_VALID_INDEX(vacant_slot)) { return HGRAPH_INVALID_INDEX; }
+
+		vacant_slot = hgraph_slot_map_slots_for_id(&graph->node_slot_map)[node_id];
+		hgraph_slot_map_allocate_id(&graph->node_slot_map, node_id, &node_slot);
+		if (!HGRAPH_IS_VALID_INDEX(node_slot)) { return HGRAPH_INVALID_INDEX; }
+
+		hgraph_mark_slot_dirty(graph, &graph->node_slot_map, node_slot);
+		hgraph_mark_slot_dirty(graph, &graph->node_slot_map, vacant_slot);
+	} else {
+		hgraph_slot_map_allocate(
+			&graph->node_slot_map,
+			&node_id,
+			&node_slot
+		);
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { return HGRAPH_INVALID_INDEX; }
+	}
 
 	hgraph_node_t* node = hgraph_get_node_by_slot(graph, node_slot);
-	++graph->node_versions[node_id];
-	node->name_len = 0;
+	hgraph_order_add_node(graph, node_id);
+	++hgraph_node_versions(graph)[node_id];
+	hgraph_mark_dirty(graph, &hgraph_node_versions(graph)[node_id], sizeof(hgraph_index_t));
+	hgraph_mark_node_dirty(graph, node);
+	node->name = HGRAPH_INVALID_INDEX;
 	node->type = type_info - registry->node_types;
+	hgraph_type_list_add(graph, node->type, node_id);
 
 	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
 		void* value = (char*)node + type_info->attributes[i].offset;
@@ -173,16 +476,92 @@ hgraph_create_node(hgraph_t* graph, const hgraph_node_type_t* type) {
 		pin->next = HGRAPH_INVALID_INDEX;
 		pin->prev = HGRAPH_INVALID_INDEX;
 	}
+	hgraph_digest_update_node(graph, node_id);
 
 	++graph->version;
 	return node_id;
 }
 
+hgraph_index_t
+hgraph_create_node(hgraph_t* graph, const hgraph_node_type_t* type) {
+	const hgraph_registry_t* registry = graph->registry;
+	const hgraph_node_type_info_t* type_info = hgraph_ptr_table_lookup(&registry->node_type_by_definition, type);
+	if (type_info == NULL) { return HGRAPH_INVALID_INDEX; }
+
+	hgraph_mutation_begin(graph);
+	hgraph_index_t node_id = hgraph_create_node_with_id(
+		graph, type_info, HGRAPH_INVALID_INDEX
+	);
+	if (HGRAPH_IS_VALID_INDEX(node_id)) {
+		hgraph_record(
+			graph,
+			(hgraph_journal_record_t){
+				.type = HGRAPH_JOURNAL_CREATE_NODE,
+				.node = {
+					.id = node_id,
+					.type = type_info - registry->node_types,
+				},
+			},
+			NULL, NULL
+		);
+	}
+	hgraph_mutation_end(graph);
+
+	return node_id;
+}
+
+HGRAPH_PRIVATE void
+hgraph_record_destroy_node(
+	hgraph_t* graph,
+	hgraph_index_t id,
+	const hgraph_node_t* node
+) {
+	if (graph->journal == NULL) { return; }
+
+	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
+	hgraph_str_t name = hgraph_get_node_name_internal(graph, node);
+	size_t old_size = name.length;
+	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
+		const hgraph_var_t* var = &type_info->attributes[i];
+		const hgraph_data_type_info_t* data_type = &graph->registry->data_types[var->type];
+		old_size = hgraph_journal_attribute_offset(old_size, data_type) + data_type->size;
+	}
+
+	hgraph_journal_record_t* record = hgraph_journal_write(
+		graph->journal,
+		(hgraph_journal_record_t){
+			.type = HGRAPH_JOURNAL_DESTROY_NODE,
+			.node = {
+				.id = id,
+				.type = node->type,
+				.name_length = (uint32_t)name.length,
+			},
+			.old_size = (uint32_t)old_size,
+		},
+		NULL, NULL
+	);
+	if (record == NULL) { return; }
+
+	// Pack the name and the attributes
+	char* data = (char*)hgraph_journal_record_old_data(record);
+	memcpy(data, name.data, name.length);
+	size_t offset = name.length;
+	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
+		const hgraph_var_t* var = &type_info->attributes[i];
+		const hgraph_data_type_info_t* data_type = &graph->registry->data_types[var->type];
+		offset = hgraph_journal_attribute_offset(offset, data_type);
+		memcpy(data + offset, (const char*)node + var->offset, data_type->size);
+		offset += data_type->size;
+	}
+}
+
 void
 hgraph_destroy_node(hgraph_t* graph, hgraph_index_t id) {
 	hgraph_node_t* node = hgraph_find_node_by_id(graph, id);
 	if (node == NULL) { return; }
 
+	hgraph_mutation_begin(graph);
+
 	// Destroy edges
 	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
 
@@ -199,7 +578,7 @@ hgraph_destroy_node(hgraph_t* graph, hgraph_index_t id) {
 			if (link == output_pin) { break; }
 
 			hgraph_edge_t* edge = HGRAPH_CONTAINER_OF(link, hgraph_edge_t, output_pin_link);
-			hgraph_index_t edge_slot = edge - graph->edges;
+			hgraph_index_t edge_slot = edge - hgraph_edges(graph);
 			hgraph_index_t edge_id = hgraph_slot_map_id_for_slot(
 				&graph->edge_slot_map,
 				edge_slot
@@ -209,16 +588,26 @@ hgraph_destroy_node(hgraph_t* graph, hgraph_index_t id) {
 	}
 
 	// Destroy node
+	hgraph_record_destroy_node(graph, id, node);
+	hgraph_order_remove_node(graph, id);
+	hgraph_type_list_remove(graph, node->type, id);
+	hgraph_name_release(graph, node->name);
+	hgraph_digest_remove_node(graph, id);
+
 	hgraph_index_t src_slot, dst_slot;
 	hgraph_slot_map_free(&graph->node_slot_map, id, &dst_slot, &src_slot);
 	HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(src_slot));
 
 	size_t node_size = graph->node_size;
-	char* src_node = graph->nodes + node_size * src_slot;
-	char* dst_node = graph->nodes + node_size * dst_slot;
+	char* src_node = hgraph_nodes(graph) + node_size * src_slot;
+	char* dst_node = hgraph_nodes(graph) + node_size * dst_slot;
 	memcpy(dst_node, src_node, node_size);
+	hgraph_mark_dirty(graph, dst_node, node_size);
+	hgraph_mark_slot_dirty(graph, &graph->node_slot_map, dst_slot);
+	hgraph_mark_slot_dirty(graph, &graph->node_slot_map, src_slot);
 
 	++graph->version;
+	hgraph_mutation_end(graph);
 }
 
 const hgraph_node_type_t*
@@ -335,14 +724,15 @@ hgraph_can_connect(
 	hgraph_index_t* input_pin = (hgraph_index_t*)((char*)to_node + to_type_info->input_pins[to_pin_index].offset);
 	if (HGRAPH_IS_VALID_INDEX(*input_pin)) { return false; }
 
-	return true;
+	return hgraph_order_can_add_edge(graph, from_node_id, to_node_id);
 }
 
-hgraph_index_t
-hgraph_connect(
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_connect_with_id(
 	hgraph_t* graph,
 	hgraph_index_t from_pin,
-	hgraph_index_t to_pin
+	hgraph_index_t to_pin,
+	hgraph_index_t edge_id
 ) {
 	if (!(HGRAPH_IS_VALID_INDEX(from_pin) && HGRAPH_IS_VALID_INDEX(to_pin))) {
 		return HGRAPH_INVALID_INDEX;
@@ -360,7 +750,7 @@ hgraph_connect(
 	hgraph_node_t* from_node = hgraph_find_node_by_id(graph, from_node_id);
 	hgraph_node_t* to_node = hgraph_find_node_by_id(graph, to_node_id);
 	if ((from_node == NULL) || (to_node == NULL) || (from_node == to_node)) {
-		return false;
+		return HGRAPH_INVALID_INDEX;
 	}
 
 	const hgraph_node_type_info_t* from_type_info = hgraph_get_node_type_internal(
@@ -382,17 +772,34 @@ hgraph_connect(
 	hgraph_index_t* input_pin = (hgraph_index_t*)((char*)to_node + to_type_info->input_pins[to_pin_index].offset);
 	if (HGRAPH_IS_VALID_INDEX(*input_pin)) { return HGRAPH_INVALID_INDEX; }
 
+	// Reject cycles
+	if (!hgraph_order_add_edge(graph, from_node_id, to_node_id)) {
+		return HGRAPH_INVALID_INDEX;
+	}
+
 	hgraph_edge_link_t* output_pin = (hgraph_edge_link_t*)((char*)from_node + from_type_info->output_pins[from_pin_index].offset);
 
 	// Create edge
-	hgraph_index_t edge_id, edge_slot;
-	hgraph_slot_map_allocate(
-		&graph->edge_slot_map,
-		&edge_id,
-		&edge_slot
-	);
-	if (!HGRAPH_IS_VALID_INDEX(edge_id)) { return HGRAPH_INVALID_INDEX; }
-	hgraph_edge_t* edge = &graph->edges[edge_slot];
+	hgraph_index_t edge_slot;
+	if (HGRAPH_IS_VALID_INDEX(edge_id)) {
+		hgraph_index_t vacant_slot = hgraph_slot_map_slot_for_id(&graph->edge_slot_map, edge_id);
+		if (HGRAPH_IS_VALID_INDEX(vacant_slot)) { return HGRAPH_INVALID_INDEX; }
+
+		vacant_slot = hgraph_slot_map_slots_for_id(&graph->edge_slot_map)[edge_id];
+		hgraph_slot_map_allocate_id(&graph->edge_slot_map, edge_id, &edge_slot);
+		if (!HGRAPH_IS_VALID_INDEX(edge_slot)) { return HGRAPH_INVALID_INDEX; }
+
+		hgraph_mark_slot_dirty(graph, &graph->edge_slot_map, edge_slot);
+		hgraph_mark_slot_dirty(graph, &graph->edge_slot_map, vacant_slot);
+	} else {
+		hgraph_slot_map_allocate(
+			&graph->edge_slot_map,
+			&edge_id,
+			&edge_slot
+		);
+		if (!HGRAPH_IS_VALID_INDEX(edge_id)) { return HGRAPH_INVALID_INDEX; }
+	}
+	hgraph_edge_t* edge = &hgraph_edges(graph)[edge_slot];
 	edge->from_pin = from_pin;
 	edge->to_pin = to_pin;
 
@@ -406,6 +813,51 @@ hgraph_connect(
 	prev->next = edge_id;
 	output_pin->prev = edge_id;
 
+	hgraph_mark_dirty(graph, edge, sizeof(*edge));
+	hgraph_mark_dirty(graph, input_pin, sizeof(*input_pin));
+	hgraph_mark_dirty(graph, output_pin, sizeof(*output_pin));
+	hgraph_mark_dirty(graph, prev, sizeof(*prev));
+	hgraph_digest_update_node(graph, to_node_id);
+
+	return edge_id;
+}
+
+HGRAPH_PRIVATE hgraph_index_t
+hgraph_get_pin_node_type(const hgraph_t* graph, hgraph_index_t pin_id) {
+	bool is_output;
+	hgraph_index_t node_id, pin_index;
+	hgraph_decode_pin_id(pin_id, &node_id, &pin_index, &is_output);
+	return hgraph_find_node_by_id(graph, node_id)->type;
+}
+
+hgraph_index_t
+hgraph_connect(
+	hgraph_t* graph,
+	hgraph_index_t from_pin,
+	hgraph_index_t to_pin
+) {
+	hgraph_mutation_begin(graph);
+	hgraph_index_t edge_id = hgraph_connect_with_id(
+		graph, from_pin, to_pin, HGRAPH_INVALID_INDEX
+	);
+	if (HGRAPH_IS_VALID_INDEX(edge_id)) {
+		hgraph_record(
+			graph,
+			(hgraph_journal_record_t){
+				.type = HGRAPH_JOURNAL_CONNECT,
+				.edge = {
+					.id = edge_id,
+					.from_pin = from_pin,
+					.to_pin = to_pin,
+					.from_type = hgraph_get_pin_node_type(graph, from_pin),
+					.to_type = hgraph_get_pin_node_type(graph, to_pin),
+				},
+			},
+			NULL, NULL
+		);
+	}
+	hgraph_mutation_end(graph);
+
 	return edge_id;
 }
 
@@ -417,7 +869,23 @@ hgraph_disconnect(hgraph_t* graph, hgraph_index_t edge_id) {
 	);
 	if (!HGRAPH_IS_VALID_INDEX(edge_slot)) { return; }
 
-	hgraph_edge_t* edge = &graph->edges[edge_slot];
+	hgraph_edge_t* edge = &hgraph_edges(graph)[edge_slot];
+	hgraph_mutation_begin(graph);
+	hgraph_record(
+		graph,
+		(hgraph_journal_record_t){
+			.type = HGRAPH_JOURNAL_DISCONNECT,
+			.edge = {
+				.id = edge_id,
+				.from_pin = edge->from_pin,
+				.to_pin = edge->to_pin,
+				.from_type = hgraph_get_pin_node_type(graph, edge->from_pin),
+				.to_type = hgraph_get_pin_node_type(graph, edge->to_pin),
+			},
+		},
+		NULL, NULL
+	);
+
 	bool is_output;
 	hgraph_index_t from_node_id, from_pin_index, to_node_id, to_pin_index;
 	hgraph_decode_pin_id(edge->from_pin, &from_node_id, &from_pin_index, &is_output);
@@ -434,6 +902,7 @@ hgraph_disconnect(hgraph_t* graph, hgraph_index_t edge_id) {
 	hgraph_index_t* input_pin = (hgraph_index_t*)((char*)to_node + to_type_info->input_pins[to_pin_index].offset);
 	HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(*input_pin));
 	*input_pin = HGRAPH_INVALID_INDEX;
+	hgraph_digest_update_node(graph, to_node_id);
 
 	// Disconnect output pin
 	const hgraph_node_type_info_t* from_type_info = hgraph_get_node_type_internal(
@@ -445,6 +914,9 @@ hgraph_disconnect(hgraph_t* graph, hgraph_index_t edge_id) {
 	hgraph_edge_link_t* next = hgraph_resolve_edge(graph, output_pin, edge->output_pin_link.next);
 	prev->next = edge->output_pin_link.next;
 	next->prev = edge->output_pin_link.prev;
+	hgraph_mark_dirty(graph, input_pin, sizeof(*input_pin));
+	hgraph_mark_dirty(graph, prev, sizeof(*prev));
+	hgraph_mark_dirty(graph, next, sizeof(*next));
 
 	// Destroy edge
 	hgraph_index_t dst_slot, src_slot;
@@ -457,7 +929,12 @@ hgraph_disconnect(hgraph_t* graph, hgraph_index_t edge_id) {
 	HGRAPH_ASSERT(
 		HGRAPH_IS_VALID_INDEX(dst_slot) && HGRAPH_IS_VALID_INDEX(src_slot)
 	);
-	graph->edges[dst_slot] = graph->edges[src_slot];
+	hgraph_edge_t* edges = hgraph_edges(graph);
+	edges[dst_slot] = edges[src_slot];
+	hgraph_mark_dirty(graph, &edges[dst_slot], sizeof(hgraph_edge_t));
+	hgraph_mark_slot_dirty(graph, &graph->edge_slot_map, dst_slot);
+	hgraph_mark_slot_dirty(graph, &graph->edge_slot_map, src_slot);
+	hgraph_mutation_end(graph);
 }
 
 HGRAPH_INTERNAL hgraph_str_t
@@ -468,30 +945,55 @@ hgraph_get_node_name(const hgraph_t* graph, hgraph_index_t node_id) {
 	return hgraph_get_node_name_internal(graph, node);
 }
 
-void
+bool
 hgraph_set_node_name(hgraph_t* graph, hgraph_index_t node_id, hgraph_str_t name) {
-	if (name.length > graph->max_name_length) { return; }
+	if (name.length > graph->max_name_length) { return false; }
 
 	hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
-	if (node == NULL) { return; }
+	if (node == NULL) { return false; }
+
+	hgraph_mutation_begin(graph);
+	hgraph_index_t new_name = HGRAPH_INVALID_INDEX;
+	if (name.length > 0) {
+		// Interning may compact the storage so the old name is only read after
+		new_name = hgraph_name_intern(graph, name);
+		if (!HGRAPH_IS_VALID_INDEX(new_name)) {
+			hgraph_mutation_end(graph);
+			return false;
+		}
+	}
 
-	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(
-		graph, node
+	hgraph_str_t old_name = hgraph_name_get(graph, node->name);
+	hgraph_record(
+		graph,
+		(hgraph_journal_record_t){
+			.type = HGRAPH_JOURNAL_SET_NAME,
+			.var = { .node = node_id, .type = node->type },
+			.old_size = (uint32_t)old_name.length,
+			.new_size = (uint32_t)name.length,
+		},
+		old_name.data, name.data
 	);
+	hgraph_name_release(graph, node->name);
+	node->name = new_name;
+	hgraph_mark_dirty(graph, &node->name, sizeof(node->name));
+	hgraph_digest_update_node(graph, node_id);
+	hgraph_mutation_end(graph);
 
-	char* name_storage = (char*)node + type_info->size;
-	memcpy(name_storage, name.data, name.length);
-	name_storage[name.length] = '\0';
-	node->name_len = name.length;
+	return true;
 }
 
 hgraph_index_t
 hgraph_get_node_by_name(const hgraph_t* graph, hgraph_str_t name) {
+	// Interned names are compared by offset
+	hgraph_index_t name_offset = hgraph_name_find(graph, name);
+	if (name.length > 0 && !HGRAPH_IS_VALID_INDEX(name_offset)) {
+		return HGRAPH_INVALID_INDEX;
+	}
+
 	for (hgraph_index_t i = 0; i < graph->node_slot_map.num_items; ++i) {
 		hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
-		hgraph_str_t node_name = hgraph_get_node_name_internal(graph, node);
-
-		if (hgraph_str_equal(name, node_name)) {
+		if (node->name == name_offset) {
 			return hgraph_slot_map_id_for_slot(&graph->node_slot_map, i);
 		}
 	}
@@ -516,7 +1018,22 @@ hgraph_set_node_attribute(
 	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
 		if (type_info->definition->attributes[i] == attribute) {
 			char* storage = (char*)node + type_info->attributes[i].offset;
-			memcpy(storage, value, attribute->data_type->size);
+			size_t size = attribute->data_type->size;
+			hgraph_mutation_begin(graph);
+			hgraph_record(
+				graph,
+				(hgraph_journal_record_t){
+					.type = HGRAPH_JOURNAL_SET_ATTRIBUTE,
+					.var = { .node = node_id, .index = i, .type = node->type },
+					.old_size = (uint32_t)size,
+					.new_size = (uint32_t)size,
+				},
+				storage, value
+			);
+			memcpy(storage, value, size);
+			hgraph_mark_dirty(graph, storage, size);
+			hgraph_digest_update_node(graph, node_id);
+			hgraph_mutation_end(graph);
 			break;
 		}
 	}
@@ -544,6 +1061,105 @@ hgraph_get_node_attribute(
 	return NULL;
 }
 
+// Nodes of the same type tend to come in runs so only the last resolution is
+// kept
+typedef struct {
+	hgraph_index_t type;
+	hgraph_index_t index;
+	ptrdiff_t offset;
+} hgraph_attribute_lookup_t;
+
+HGRAPH_PRIVATE bool
+hgraph_lookup_attribute(
+	const hgraph_t* graph,
+	hgraph_attribute_lookup_t* lookup,
+	const hgraph_node_t* node,
+	const hgraph_attribute_description_t* attribute
+) {
+	if (node->type == lookup->type) { return HGRAPH_IS_VALID_INDEX(lookup->index); }
+
+	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(
+		graph, node
+	);
+	lookup->type = node->type;
+	lookup->index = HGRAPH_INVALID_INDEX;
+	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
+		if (type_info->definition->attributes[i] == attribute) {
+			lookup->index = i;
+			lookup->offset = type_info->attributes[i].offset;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+hgraph_index_t
+hgraph_set_attribute_bulk(
+	hgraph_t* graph,
+	const hgraph_attribute_description_t* attribute,
+	const hgraph_index_t* node_ids,
+	const void* values,
+	size_t stride,
+	hgraph_index_t count
+) {
+	size_t size = attribute->data_type->size;
+	hgraph_attribute_lookup_t lookup = { .type = HGRAPH_INVALID_INDEX };
+	hgraph_index_t num_written = 0;
+
+	hgraph_mutation_begin(graph);
+	for (hgraph_index_t i = 0; i < count; ++i) {
+		hgraph_node_t* node = hgraph_find_node_by_id(graph, node_ids[i]);
+		if (node == NULL) { continue; }
+		if (!hgraph_lookup_attribute(graph, &lookup, node, attribute)) { continue; }
+
+		const char* value = (const char*)values + stride * (size_t)i;
+		char* storage = (char*)node + lookup.offset;
+		hgraph_record(
+			graph,
+			(hgraph_journal_record_t){
+				.type = HGRAPH_JOURNAL_SET_ATTRIBUTE,
+				.var = { .node = node_ids[i], .index = lookup.index, .type = node->type },
+				.old_size = (uint32_t)size,
+				.new_size = (uint32_t)size,
+			},
+			storage, value
+		);
+		memcpy(storage, value, size);
+		hgraph_mark_dirty(graph, storage, size);
+		hgraph_digest_update_node(graph, node_ids[i]);
+		++num_written;
+	}
+	hgraph_mutation_end(graph);
+
+	return num_written;
+}
+
+hgraph_index_t
+hgraph_get_attribute_bulk(
+	const hgraph_t* graph,
+	const hgraph_attribute_description_t* attribute,
+	const hgraph_index_t* node_ids,
+	void* values,
+	size_t stride,
+	hgraph_index_t count
+) {
+	size_t size = attribute->data_type->size;
+	hgraph_attribute_lookup_t lookup = { .type = HGRAPH_INVALID_INDEX };
+	hgraph_index_t num_read = 0;
+
+	for (hgraph_index_t i = 0; i < count; ++i) {
+		const hgraph_node_t* node = hgraph_find_node_by_id(graph, node_ids[i]);
+		if (node == NULL) { continue; }
+		if (!hgraph_lookup_attribute(graph, &lookup, node, attribute)) { continue; }
+
+		memcpy((char*)values + stride * (size_t)i, (const char*)node + lookup.offset, size);
+		++num_read;
+	}
+
+	return num_read;
+}
+
 void
 hgraph_iterate_nodes(
 	const hgraph_t* graph,
@@ -569,7 +1185,7 @@ hgraph_iterate_edges(
 	void* userdata
 ) {
 	for (hgraph_index_t i = 0; i < graph->edge_slot_map.num_items; ++i) {
-		const hgraph_edge_t* edge = &graph->edges[i];
+		const hgraph_edge_t* edge = &hgraph_edges(graph)[i];
 		hgraph_index_t id = hgraph_slot_map_id_for_slot(&graph->edge_slot_map, i);
 
 		// May happen if removal occurs during iteration
@@ -602,7 +1218,7 @@ hgraph_iterate_edges_to(
 		);
 		if (!HGRAPH_IS_VALID_INDEX(edge_slot)) { continue; }
 
-		hgraph_edge_t* edge = &graph->edges[edge_slot];
+		hgraph_edge_t* edge = &hgraph_edges(graph)[edge_slot];
 
 		if (!iterator(edge_id, edge->from_pin, edge->to_pin, userdata)) {
 			break;
@@ -633,7 +1249,7 @@ hgraph_iterate_edges_from(
 			if (link == output_pin) { break; }
 
 			hgraph_edge_t* edge = HGRAPH_CONTAINER_OF(link, hgraph_edge_t, output_pin_link);
-			hgraph_index_t edge_slot = edge - graph->edges;
+			hgraph_index_t edge_slot = edge - hgraph_edges(graph);
 			hgraph_index_t edge_id = hgraph_slot_map_id_for_slot(
 				&graph->edge_slot_map,
 				edge_slot
@@ -647,6 +1263,189 @@ hgraph_iterate_edges_from(
 	}
 }
 
+void
+hgraph_iterate_nodes_of_type(
+	const hgraph_t* graph,
+	const hgraph_node_type_t* type,
+	hgraph_node_iterator_t iterator,
+	void* userdata
+) {
+	const hgraph_node_type_info_t* type_info = hgraph_ptr_table_lookup(
+		&graph->registry->node_type_by_definition, type
+	);
+	if (type_info == NULL) { return; }
+
+	const hgraph_node_link_t* links = hgraph_type_links(graph);
+	hgraph_index_t node_id = hgraph_type_heads(graph)[type_info - graph->registry->node_types];
+	while (HGRAPH_IS_VALID_INDEX(node_id)) {
+		// Read ahead in case the iterator destroys the node
+		hgraph_index_t next = links[node_id].next;
+		if (!iterator(node_id, type, userdata)) { break; }
+		node_id = next;
+	}
+}
+
+_Static_assert(
+	HGRAPH_MAX_PINS <= HGRAPH_CURSOR_MAX_STARTS,
+	"A cursor must be able to start from every pin"
+);
+_Static_assert(
+	sizeof(hgraph_edge_t) % sizeof(hgraph_index_t) == 0,
+	"Edges must be made of indices"
+);
+
+HGRAPH_PRIVATE hgraph_edge_cursor_t
+hgraph_edge_cursor_init(const hgraph_t* graph) {
+	return (hgraph_edge_cursor_t){
+		.ids_for_slot = hgraph_slot_map_ids_for_slot(&graph->edge_slot_map),
+		.slots_for_id = hgraph_slot_map_slots_for_id(&graph->edge_slot_map),
+		.edges = (const hgraph_index_t*)hgraph_edges(graph),
+		.edge_stride = sizeof(hgraph_edge_t) / sizeof(hgraph_index_t),
+		.next_field = (offsetof(hgraph_edge_t, output_pin_link) + offsetof(hgraph_edge_link_t, next))
+			/ sizeof(hgraph_index_t),
+		.from_pin_field = offsetof(hgraph_edge_t, from_pin) / sizeof(hgraph_index_t),
+		.to_pin_field = offsetof(hgraph_edge_t, to_pin) / sizeof(hgraph_index_t),
+		.current = HGRAPH_INVALID_INDEX,
+	};
+}
+
+hgraph_node_cursor_t
+hgraph_node_cursor(const hgraph_t* graph) {
+	return (hgraph_node_cursor_t){
+		.ids_for_slot = hgraph_slot_map_ids_for_slot(&graph->node_slot_map),
+		.num_nodes = graph->node_slot_map.num_items,
+	};
+}
+
+hgraph_edge_cursor_t
+hgraph_edge_cursor(const hgraph_t* graph) {
+	hgraph_edge_cursor_t cursor = hgraph_edge_cursor_init(graph);
+	cursor.walk_slots = true;
+	cursor.num_edges = graph->edge_slot_map.num_items;
+	return cursor;
+}
+
+hgraph_edge_cursor_t
+hgraph_edge_cursor_to(const hgraph_t* graph, hgraph_index_t node_id) {
+	hgraph_edge_cursor_t cursor = hgraph_edge_cursor_init(graph);
+	hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+	if (node == NULL) { return cursor; }
+
+	// Each input pin holds at most one edge
+	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
+	for (hgraph_index_t i = 0; i < type_info->num_input_pins; ++i) {
+		hgraph_index_t* input_pin = (hgraph_index_t*)((char*)node + type_info->input_pins[i].offset);
+		cursor.starts[cursor.num_starts++] = *input_pin;
+	}
+	return cursor;
+}
+
+hgraph_edge_cursor_t
+hgraph_edge_cursor_from(const hgraph_t* graph, hgraph_index_t node_id) {
+	hgraph_edge_cursor_t cursor = hgraph_edge_cursor_init(graph);
+	hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+	if (node == NULL) { return cursor; }
+
+	// Follow the list of each output pin
+	const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(graph, node);
+	for (hgraph_index_t i = 0; i < type_info->num_output_pins; ++i) {
+		hgraph_edge_link_t* output_pin = (hgraph_edge_link_t*)((char*)node + type_info->output_pins[i].offset);
+		cursor.starts[cursor.num_starts++] = output_pin->next;
+	}
+	cursor.follow_links = true;
+	return cursor;
+}
+
+uint32_t
+hgraph_read_begin(const hgraph_t* graph) {
+	while (true) {
+		uint_least32_t sequence = atomic_load_explicit(&graph->sequence, memory_order_acquire);
+		if ((sequence & 1) == 0) { return (uint32_t)sequence; }
+	}
+}
+
+bool
+hgraph_read_validate(const hgraph_t* graph, uint32_t sequence) {
+	atomic_thread_fence(memory_order_acquire);
+	return atomic_load_explicit(&graph->sequence, memory_order_relaxed) == sequence;
+}
+
+size_t
+hgraph_read_scratch_size(const hgraph_t* graph) {
+	hgraph_index_t max_entries = HGRAPH_MAX(
+		graph->node_slot_map.max_items * 2,
+		graph->edge_slot_map.max_items * 3
+	);
+	return sizeof(hgraph_index_t) * max_entries;
+}
+
+void
+hgraph_iterate_nodes_consistent(
+	const hgraph_t* graph,
+	void* scratch,
+	hgraph_node_iterator_t iterator,
+	void* userdata
+) {
+	// Copy (id, type) pairs until a copy is made without a concurrent write.
+	// Nothing read during the copy is dereferenced before validation.
+	hgraph_index_t* entries = scratch;
+	hgraph_index_t num_nodes;
+	uint32_t sequence;
+	do {
+		sequence = hgraph_read_begin(graph);
+		num_nodes = HGRAPH_MIN(
+			graph->node_slot_map.num_items,
+			graph->node_slot_map.max_items
+		);
+		const hgraph_index_t* ids_for_slot = hgraph_slot_map_ids_for_slot(&graph->node_slot_map);
+		for (hgraph_index_t i = 0; i < num_nodes; ++i) {
+			entries[i * 2 + 0] = ids_for_slot[i];
+			entries[i * 2 + 1] = hgraph_get_node_by_slot(graph, i)->type;
+		}
+	} while (!hgraph_read_validate(graph, sequence));
+
+	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
+		hgraph_index_t id = entries[i * 2 + 0];
+		if (!HGRAPH_IS_VALID_INDEX(id)) { continue; }
+
+		const hgraph_node_type_t* type = graph->registry->node_types[entries[i * 2 + 1]].definition;
+		if (!iterator(id, type, userdata)) { break; }
+	}
+}
+
+void
+hgraph_iterate_edges_consistent(
+	const hgraph_t* graph,
+	void* scratch,
+	hgraph_edge_iterator_t iterator,
+	void* userdata
+) {
+	hgraph_index_t* entries = scratch;
+	hgraph_index_t num_edges;
+	uint32_t sequence;
+	do {
+		sequence = hgraph_read_begin(graph);
+		num_edges = HGRAPH_MIN(
+			graph->edge_slot_map.num_items,
+			graph->edge_slot_map.max_items
+		);
+		const hgraph_index_t* ids_for_slot = hgraph_slot_map_ids_for_slot(&graph->edge_slot_map);
+		const hgraph_edge_t* edges = hgraph_edges(graph);
+		for (hgraph_index_t i = 0; i < num_edges; ++i) {
+			entries[i * 3 + 0] = ids_for_slot[i];
+			entries[i * 3 + 1] = edges[i].from_pin;
+			entries[i * 3 + 2] = edges[i].to_pin;
+		}
+	} while (!hgraph_read_validate(graph, sequence));
+
+	for (hgraph_index_t i = 0; i < num_edges; ++i) {
+		hgraph_index_t id = entries[i * 3 + 0];
+		if (!HGRAPH_IS_VALID_INDEX(id)) { continue; }
+
+		if (!iterator(id, entries[i * 3 + 1], entries[i * 3 + 2], userdata)) { break; }
+	}
+}
+
 bool
 hgraph_is_pin_connected(
 	const hgraph_t* graph,
@@ -680,6 +1479,16 @@ hgraph_is_pin_connected(
 	}
 }
 
+hgraph_config_t
+hgraph_get_config(const hgraph_t* graph) {
+	return (hgraph_config_t){
+		.registry = graph->registry,
+		.max_nodes = graph->node_slot_map.max_items,
+		.max_name_length = graph->max_name_length,
+		.name_storage_size = graph->name_storage_size,
+	};
+}
+
 hgraph_info_t
 hgraph_get_info(const hgraph_t* graph) {
 	return (hgraph_info_t){
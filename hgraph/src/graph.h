@@ -39,4 +39,180 @@ hgraph_resolve_edge(
 	hgraph_index_t edge_id
 );
 
+HGRAPH_INTERNAL uint64_t
+hgraph_new_instance(void);
+
+HGRAPH_INTERNAL void
+hgraph_mark_dirty(hgraph_t* graph, const void* ptr, size_t size);
+
+HGRAPH_INTERNAL void
+hgraph_mark_node_dirty(hgraph_t* graph, const hgraph_node_t* node);
+
+HGRAPH_INTERNAL void
+hgraph_mark_slot_dirty(
+	hgraph_t* graph,
+	const hgraph_slot_map_t* slot_map,
+	hgraph_index_t slot
+);
+
+HGRAPH_INTERNAL void
+hgraph_write_begin(hgraph_t* graph);
+
+HGRAPH_INTERNAL void
+hgraph_write_end(hgraph_t* graph);
+
+HGRAPH_INTERNAL void
+hgraph_swap_id(
+	hgraph_t* graph,
+	hgraph_slot_map_t* slot_map,
+	hgraph_index_t occupied_id,
+	hgraph_index_t vacant_id
+);
+
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_create_node_with_id(
+	hgraph_t* graph,
+	const hgraph_node_type_info_t* type_info,
+	hgraph_index_t node_id
+);
+
+HGRAPH_INTERNAL ptrdiff_t
+hgraph_name_table_reserve(mem_layout_t* layout, hgraph_index_t max_nodes);
+
+HGRAPH_INTERNAL void
+hgraph_name_init(hgraph_t* graph, hgraph_index_t max_nodes);
+
+HGRAPH_INTERNAL char*
+hgraph_name_reserve(hgraph_t* graph, hgraph_index_t length);
+
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_name_find(const hgraph_t* graph, hgraph_str_t str);
+
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_name_intern(hgraph_t* graph, hgraph_str_t str);
+
+HGRAPH_INTERNAL void
+hgraph_name_release(hgraph_t* graph, hgraph_index_t name);
+
+HGRAPH_INTERNAL hgraph_str_t
+hgraph_name_get(const hgraph_t* graph, hgraph_index_t name);
+
+HGRAPH_INTERNAL void
+hgraph_digest_update_node(hgraph_t* graph, hgraph_index_t node_id);
+
+HGRAPH_INTERNAL void
+hgraph_digest_remove_node(hgraph_t* graph, hgraph_index_t node_id);
+
+HGRAPH_INTERNAL void
+hgraph_order_add_node(hgraph_t* graph, hgraph_index_t node_id);
+
+HGRAPH_INTERNAL void
+hgraph_order_remove_node(hgraph_t* graph, hgraph_index_t node_id);
+
+HGRAPH_INTERNAL void
+hgraph_order_move_node(
+	hgraph_t* graph,
+	hgraph_index_t old_node_id,
+	hgraph_index_t new_node_id
+);
+
+HGRAPH_INTERNAL bool
+hgraph_order_can_add_edge(
+	hgraph_t* graph,
+	hgraph_index_t from_node_id,
+	hgraph_index_t to_node_id
+);
+
+HGRAPH_INTERNAL bool
+hgraph_order_add_edge(
+	hgraph_t* graph,
+	hgraph_index_t from_node_id,
+	hgraph_index_t to_node_id
+);
+
+HGRAPH_INTERNAL const hgraph_var_t*
+hgraph_registry_get_vars(
+	const hgraph_node_type_info_t* type_info,
+	hgraph_name_kind_t kind,
+	hgraph_index_t* num_vars
+);
+
+// Returns NULL when there is no such type
+HGRAPH_INTERNAL const hgraph_node_type_info_t*
+hgraph_registry_find_node_type(const hgraph_registry_t* registry, hgraph_str_t name);
+
+// Returns the index of the var in its kind or HGRAPH_INVALID_INDEX
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_registry_find_var(
+	const hgraph_registry_t* registry,
+	const hgraph_node_type_info_t* type_info,
+	hgraph_name_kind_t kind,
+	hgraph_str_t name
+);
+
+// Ends an indexed graph file, see io.c
+#define INDEX_MAGIC_SIZE 4
+extern const char INDEX_MAGIC[INDEX_MAGIC_SIZE];
+
+// Measures the serialized size of what is written without storing it
+typedef struct {
+	hgraph_out_t impl;
+	size_t size;
+	char buffer[64];
+} hgraph_measure_out_t;
+
+HGRAPH_INTERNAL hgraph_out_t*
+hgraph_measure_out_init(hgraph_measure_out_t* measure);
+
+HGRAPH_INTERNAL size_t
+hgraph_measure_out_size(const hgraph_out_t* impl);
+
+// Write a value prefixed with its serialized size
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_write_value(
+	const hgraph_data_type_info_t* data_type,
+	const void* value,
+	hgraph_out_t* out
+);
+
+HGRAPH_INTERNAL const hgraph_var_t*
+hgraph_find_attribute(
+	const hgraph_registry_t* registry,
+	const hgraph_node_type_info_t* type_info,
+	hgraph_str_t type,
+	hgraph_str_t name
+);
+
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_value(
+	const hgraph_data_type_info_t* data_type,
+	void* value,
+	size_t size,
+	hgraph_in_t* in
+);
+
+HGRAPH_INTERNAL void
+hgraph_reset_pin_remaps_v2(hgraph_t* graph);
+
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_group_header_v2(
+	hgraph_t* graph,
+	const hgraph_node_type_info_t** type_info_out,
+	hgraph_in_t* in
+);
+
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_edges_v2(hgraph_t* graph, hgraph_in_t* in);
+
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_connect(hgraph_t* graph, hgraph_index_t from_pin, hgraph_index_t to_pin);
+
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_connect_with_id(
+	hgraph_t* graph,
+	hgraph_index_t from_pin,
+	hgraph_index_t to_pin,
+	hgraph_index_t edge_id
+);
+
 #endif
@@ -2,6 +2,7 @@
 #define HGRAPH_HASH_H
 
 #include <stdint.h>
+#include <stddef.h>
 
 #ifdef _MSC_VER
 
@@ -54,4 +55,19 @@ hash_murmur64(uint64_t h) {
 	return h;
 }
 
+static inline uint64_t
+hash_fnv1a_continue(uint64_t h, const void* data, size_t length) {
+	const unsigned char* bytes = data;
+	for (size_t i = 0; i < length; ++i) {
+		h ^= bytes[i];
+		h *= 0x100000001b3;
+	}
+	return h;
+}
+
+static inline uint64_t
+hash_fnv1a(const void* data, size_t length) {
+	return hash_fnv1a_continue(0xcbf29ce484222325, data, length);
+}
+
 #endif
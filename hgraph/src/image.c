@@ -0,0 +1,122 @@
+#include "internal.h"
+#include <hgraph/io.h>
+#include "graph.h"
+#include "hash.h"
+
+// An image is the graph memory stored as is, preceded by a header and
+// followed by a regular graph file for when the image cannot be mapped.
+// Everything in the graph is located by offset so mapping only has to patch
+// the few pointers in the graph header.
+
+#define HGRAPH_IMAGE_HEADER_SIZE 64
+#define HGRAPH_IMAGE_BYTE_ORDER 0x01020304
+
+static const char HGRAPH_IMAGE_MAGIC[] = { 'H', 'E', 'I', 1 };
+
+typedef struct {
+	char magic[4];
+	// Written in native byte order, a reader with a different one sees
+	// another value
+	uint32_t byte_order;
+	uint64_t fingerprint;
+	uint64_t graph_size;
+	uint64_t fallback_offset;
+} hgraph_image_header_t;
+
+HGRAPH_STATIC_ASSERT(
+	sizeof(hgraph_image_header_t) <= HGRAPH_IMAGE_HEADER_SIZE,
+	"Image header is too large"
+);
+HGRAPH_STATIC_ASSERT(
+	HGRAPH_IMAGE_HEADER_SIZE % _Alignof(max_align_t) == 0,
+	"Image header would misalign the graph"
+);
+
+// The registry fingerprint only covers the node memory, the graph header
+// itself must also match
+HGRAPH_PRIVATE uint64_t
+hgraph_image_fingerprint(const hgraph_registry_t* registry) {
+	size_t layout[] = { sizeof(hgraph_t), sizeof(void*), _Alignof(max_align_t) };
+	return hash_fnv1a_continue(registry->fingerprint, layout, sizeof(layout));
+}
+
+HGRAPH_PRIVATE bool
+hgraph_read_image_header(
+	hgraph_image_header_t* header,
+	const void* image,
+	size_t size
+) {
+	if (size < HGRAPH_IMAGE_HEADER_SIZE) { return false; }
+
+	memcpy(header, image, sizeof(*header));
+	return memcmp(header->magic, HGRAPH_IMAGE_MAGIC, sizeof(HGRAPH_IMAGE_MAGIC)) == 0
+		&& header->byte_order == HGRAPH_IMAGE_BYTE_ORDER
+		&& header->fallback_offset <= size
+		&& header->fallback_offset >= HGRAPH_IMAGE_HEADER_SIZE
+		&& header->graph_size >= sizeof(hgraph_t)
+		&& header->graph_size <= header->fallback_offset - HGRAPH_IMAGE_HEADER_SIZE;
+}
+
+hgraph_io_status_t
+hgraph_write_image(const hgraph_t* graph, hgraph_out_t* out) {
+	HGRAPH_ASSERT(graph->write_depth == 0);
+
+	char header_bytes[HGRAPH_IMAGE_HEADER_SIZE] = { 0 };
+	hgraph_image_header_t header = {
+		.byte_order = HGRAPH_IMAGE_BYTE_ORDER,
+		.fingerprint = hgraph_image_fingerprint(graph->registry),
+		.graph_size = graph->size,
+		.fallback_offset = HGRAPH_IMAGE_HEADER_SIZE + graph->size,
+	};
+	memcpy(header.magic, HGRAPH_IMAGE_MAGIC, sizeof(HGRAPH_IMAGE_MAGIC));
+	memcpy(header_bytes, &header, sizeof(header));
+	HGRAPH_CHECK_IO(hgraph_io_write(out, header_bytes, sizeof(header_bytes)));
+
+	// Pointers are meaningless in another process
+	hgraph_t graph_header;
+	memcpy(&graph_header, graph, sizeof(graph_header));
+	graph_header.registry = NULL;
+	graph_header.journal = NULL;
+	HGRAPH_CHECK_IO(hgraph_io_write(out, &graph_header, sizeof(graph_header)));
+	HGRAPH_CHECK_IO(hgraph_io_write(
+		out,
+		(const char*)graph + sizeof(graph_header),
+		graph->size - sizeof(graph_header)
+	));
+
+	HGRAPH_CHECK_IO(hgraph_write_header(out));
+	return hgraph_write_graph(graph, out);
+}
+
+hgraph_t*
+hgraph_map_graph(void* image, size_t size, const hgraph_registry_t* registry) {
+	hgraph_image_header_t header;
+	if (!hgraph_read_image_header(&header, image, size)) { return NULL; }
+	if (header.fingerprint != hgraph_image_fingerprint(registry)) { return NULL; }
+	if ((intptr_t)image % (intptr_t)_Alignof(max_align_t) != 0) { return NULL; }
+
+	hgraph_t* graph = (hgraph_t*)((char*)image + HGRAPH_IMAGE_HEADER_SIZE);
+	if (graph->size != header.graph_size) { return NULL; }
+
+	// Only the graph header is written to so a private mapping copies a
+	// single page until the graph is modified
+	graph->registry = registry;
+	graph->journal = NULL;
+	graph->instance = hgraph_new_instance();
+	return graph;
+}
+
+bool
+hgraph_get_image_fallback(
+	const void* image,
+	size_t size,
+	const void** file,
+	size_t* file_size
+) {
+	hgraph_image_header_t header;
+	if (!hgraph_read_image_header(&header, image, size)) { return false; }
+
+	*file = (const char*)image + header.fallback_offset;
+	*file_size = size - header.fallback_offset;
+	return true;
+}
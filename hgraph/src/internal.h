@@ -7,6 +7,7 @@
 #include "assert.h"
 #include <string.h>
 #include <limits.h>
+#include <stdatomic.h>
 
 #define HGRAPH_PRIVATE static inline
 #define HGRAPH_INTERNAL
@@ -16,6 +17,8 @@
 #define HGRAPH_CONTAINER_OF(PTR, TYPE, MEMBER) \
     (TYPE*)((char*)(PTR) - offsetof(TYPE, MEMBER))
 #define HGRAPH_MAX_PINS ((hgraph_index_t)(sizeof(hgraph_bitset_t) * CHAR_BIT))
+#define HGRAPH_CHUNK_SIZE 4096
+#define HGRAPH_DEFAULT_NAME_LENGTH 24
 
 typedef int16_t hgraph_bitset_t;
 
@@ -66,9 +69,27 @@ typedef struct hgraph_node_type_info_s {
 	hgraph_output_buffer_info_t* output_buffers;
 } hgraph_node_type_info_t;
 
+typedef enum hgraph_name_kind_e {
+	HGRAPH_NAME_NONE,
+	HGRAPH_NAME_NODE_TYPE,
+	HGRAPH_NAME_ATTRIBUTE,
+	HGRAPH_NAME_INPUT_PIN,
+	HGRAPH_NAME_OUTPUT_PIN,
+} hgraph_name_kind_t;
+
+// A node type is keyed by its name alone and stored in index.
+// A var is keyed by its node type, kind and name.
+typedef struct hgraph_name_entry_s {
+	hgraph_index_t type;
+	hgraph_index_t index;
+	hgraph_name_kind_t kind;
+} hgraph_name_entry_t;
+
 struct hgraph_registry_s {
 	size_t max_node_size;
 	hgraph_index_t max_edges_per_node;
+	// Hash of everything which decides the memory layout of a graph
+	uint64_t fingerprint;
 
 	hgraph_index_t num_data_types;
 	hgraph_data_type_info_t* data_types;
@@ -78,6 +99,11 @@ struct hgraph_registry_s {
 
 	hgraph_ptr_table_t data_type_by_definition;
 	hgraph_ptr_table_t node_type_by_definition;
+
+	// Open addressing table of node type and var names for loading and
+	// migration
+	hgraph_index_t name_table_exp;
+	hgraph_name_entry_t* name_table;
 };
 
 typedef struct hgraph_edge_s hgraph_edge_t;
@@ -87,6 +113,11 @@ typedef struct hgraph_edge_link_s {
 	hgraph_index_t next;
 } hgraph_edge_link_t;
 
+typedef struct hgraph_node_link_s {
+	hgraph_index_t prev;
+	hgraph_index_t next;
+} hgraph_node_link_t;
+
 struct hgraph_edge_s {
 	hgraph_edge_link_t output_pin_link;
 
@@ -95,40 +126,146 @@ struct hgraph_edge_s {
 };
 
 typedef struct hgraph_node_s {
-	size_t name_len;
+	// Offset in the name storage, invalid when the node has no name
+	hgraph_index_t name;
 	hgraph_index_t type;
 } hgraph_node_t;
 
+// Followed by the characters and a null terminator
+typedef struct hgraph_name_s {
+	hgraph_index_t ref_count;
+	hgraph_index_t length;
+	// Only used while compacting
+	hgraph_index_t relocation;
+} hgraph_name_t;
+
 struct hgraph_s {
 	const hgraph_registry_t* registry;
 	hgraph_index_t max_name_length;
 	hgraph_index_t version;
 
+	// Everything in the graph memory is located by offset from the graph so
+	// the whole graph can be copied with memcpy
+	size_t size;
+
 	size_t node_size;
 	hgraph_slot_map_t node_slot_map;
-	char* nodes;
-	hgraph_index_t* node_versions;
+	ptrdiff_t nodes_offset;
+	ptrdiff_t node_versions_offset;
 
 	hgraph_slot_map_t edge_slot_map;
-	hgraph_edge_t* edges;
+	ptrdiff_t edges_offset;
+
+	// Topological order of the nodes.
+	// Destroyed nodes leave gaps which are closed when the end is reached.
+	hgraph_index_t order_end;
+	ptrdiff_t node_orders_offset;
+	ptrdiff_t ordered_nodes_offset;
+	// Scratch memory for reordering, not part of the body
+	ptrdiff_t order_marks_offset;
+	ptrdiff_t order_stack_offset;
+	ptrdiff_t order_affected_nodes_offset;
+	ptrdiff_t order_affected_positions_offset;
+
+	// Maps the pins of each node type in a file being read to the pins of
+	// the registered type, see io.c.
+	// Scratch memory, not part of the body.
+	ptrdiff_t pin_remaps_offset;
+
+	// Content hash of each node and their sum, see digest.c
+	uint64_t digest;
+	ptrdiff_t node_hashes_offset;
+
+	// Nodes of each type as a doubly linked list of node ids
+	ptrdiff_t type_heads_offset;
+	ptrdiff_t type_links_offset;
+
+	// Interned node names.
+	// Dead names stay in the storage until it is full and gets compacted.
+	// The table maps a name to its offset using open addressing, removed
+	// entries leave tombstones which are counted in the load.
+	hgraph_index_t name_storage_size;
+	hgraph_index_t name_storage_end;
+	hgraph_index_t name_table_exp;
+	hgraph_index_t name_table_load;
+	ptrdiff_t name_storage_offset;
+	ptrdiff_t name_table_offset;
+
+	// Write tracking for snapshots.
+	// Everything from body_offset to body_offset + body_size is divided into
+	// chunks of HGRAPH_CHUNK_SIZE bytes, each tagged with the revision of its
+	// last write.
+	uint64_t instance;
+	uint64_t revision;
+	ptrdiff_t body_offset;
+	size_t body_size;
+	ptrdiff_t chunk_revisions_offset;
+
+	// The graph and revision this graph was last synced from
+	uint64_t snapshot_instance;
+	uint64_t snapshot_revision;
+
+	// Sequence lock for concurrent readers, odd while a write is in progress.
+	// Nested writes only bump it at the outermost level.
+	atomic_uint_least32_t sequence;
+	hgraph_index_t write_depth;
+
+	hgraph_journal_t* journal;
+};
+
+struct hgraph_journal_s {
+	hgraph_t* graph;
+
+	size_t capacity;
+	size_t end;
+	// Records before the cursor can be undone, records after it can be redone
+	size_t cursor;
+	size_t step_start;
+	// Records before this position must not be merged into
+	size_t merge_floor;
+	// Position of the last save, the edits since can be appended to the saved
+	// file as long as the records in between are kept
+	size_t save_point;
+	char* records;
+
+	hgraph_index_t depth;
+	bool step_open;
+	bool overflowed;
+	bool replaying;
+	bool has_save_point;
 };
 
-typedef enum hgraph_node_pipeline_state_s {
-	HGRAPH_NODE_STATE_WAITING,
-	HGRAPH_NODE_STATE_SCHEDULED,
-	HGRAPH_NODE_STATE_EXECUTED,
-} hgraph_node_pipeline_state_t;
+typedef struct hgraph_pipeline_source_s {
+	// Slot of a node in the subgraph, invalid for boundary inputs
+	hgraph_index_t node;
+	// Output pin of that node or input pin of the subgraph node
+	hgraph_index_t pin;
+} hgraph_pipeline_source_t;
+
+// Compiled once per subgraph node type and shared by all its instances.
+// Nodes are identified by their slot in the subgraph.
+typedef struct hgraph_pipeline_plan_s {
+	const hgraph_subgraph_t* subgraph;
+	hgraph_index_t num_nodes;
+	hgraph_index_t* order;
+	hgraph_index_t* input_source_offsets;
+	hgraph_pipeline_source_t* input_sources;
+	hgraph_pipeline_source_t* output_sources;
+} hgraph_pipeline_plan_t;
 
 typedef struct hgraph_pipeline_node_meta_s {
 	hgraph_index_t id;
 	hgraph_index_t version;
 	hgraph_index_t type;
 
+	// Subgraph nodes point at their plan and the first meta of their instance.
+	// Nodes inside an instance point at the subgraph node.
+	const hgraph_pipeline_plan_t* plan;
+	hgraph_index_t first_inner;
+	hgraph_index_t owner;
+
 	char* data;
 	const void* status;
-	hgraph_bitset_t received_inputs;
-	hgraph_bitset_t sent_outputs;
-	hgraph_node_pipeline_state_t state;
 } hgraph_pipeline_node_meta_t;
 
 struct hgraph_pipeline_s {
@@ -137,10 +274,21 @@ struct hgraph_pipeline_s {
 	const hgraph_t* graph;
 
 	hgraph_index_t num_nodes;
-	hgraph_index_t num_ready_nodes;
-	hgraph_index_t* ready_nodes;
+	// Node slots in topological order
+	hgraph_index_t* order;
 
+	// Metas of the graph nodes come first, in slot order, followed by the
+	// nodes of each subgraph instance
+	hgraph_index_t num_metas;
 	hgraph_pipeline_node_meta_t* node_metas;
+	// Scheduler state, indexed like the metas and kept apart so it can be
+	// scanned and cleared without touching them
+	hgraph_bitset_t* received_inputs;
+	hgraph_bitset_t* sent_outputs;
+	// Indexed by node type
+	hgraph_pipeline_plan_t* plans;
+	// Subgraphs are only expanded one level deep
+	bool has_nested_subgraph;
 
 	char* scratch_zone_start;
 	char* scratch_zone_end;
@@ -172,6 +320,92 @@ hgraph_str_equal(hgraph_str_t lhs, hgraph_str_t rhs) {
 	return memcmp(lhs.data, rhs.data, lhs.length) == 0;
 }
 
+HGRAPH_PRIVATE char*
+hgraph_nodes(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->nodes_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_node_versions(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->node_versions_offset);
+}
+
+HGRAPH_PRIVATE hgraph_edge_t*
+hgraph_edges(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->edges_offset);
+}
+
+HGRAPH_PRIVATE uint64_t*
+hgraph_chunk_revisions(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->chunk_revisions_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_node_orders(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->node_orders_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_ordered_nodes(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->ordered_nodes_offset);
+}
+
+HGRAPH_PRIVATE uint8_t*
+hgraph_order_marks(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->order_marks_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_order_stack(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->order_stack_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_order_affected_nodes(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->order_affected_nodes_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_order_affected_positions(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->order_affected_positions_offset);
+}
+
+HGRAPH_PRIVATE int8_t*
+hgraph_pin_remaps(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->pin_remaps_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_type_heads(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->type_heads_offset);
+}
+
+HGRAPH_PRIVATE hgraph_node_link_t*
+hgraph_type_links(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->type_links_offset);
+}
+
+HGRAPH_PRIVATE uint64_t*
+hgraph_node_hashes(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->node_hashes_offset);
+}
+
+HGRAPH_PRIVATE char*
+hgraph_name_storage(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->name_storage_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t*
+hgraph_name_table(const hgraph_t* graph) {
+	return mem_layout_locate((void*)graph, graph->name_table_offset);
+}
+
+HGRAPH_PRIVATE hgraph_index_t
+hgraph_name_entry_size(hgraph_index_t length) {
+	size_t size = sizeof(hgraph_name_t) + length + 1;
+	return (hgraph_index_t)mem_layout_align_ptr((intptr_t)size, _Alignof(hgraph_name_t));
+}
+
 HGRAPH_PRIVATE void
 hgraph_bitset_init(hgraph_bitset_t* bitset) {
 	*bitset = 0;
@@ -183,6 +417,12 @@ hgraph_bitset_set(hgraph_bitset_t* bitset, hgraph_index_t index) {
 	*bitset |= mask;
 }
 
+HGRAPH_PRIVATE bool
+hgraph_bitset_is_set(hgraph_bitset_t bitset, hgraph_index_t index) {
+	hgraph_bitset_t mask = (hgraph_bitset_t)0x01 << index;
+	return (bitset & mask) != 0;
+}
+
 HGRAPH_PRIVATE bool
 hgraph_bitset_is_all_set(hgraph_bitset_t bitset, hgraph_bitset_t required_bits) {
 	return (bitset & required_bits) == required_bits;
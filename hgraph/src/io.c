@@ -3,84 +3,164 @@
 #include <hgraph/io.h>
 #include "graph.h"
 #include "slip.h"
+#include "crc.h"
 
 const char HEADER_MAGIC_V1[] = { 'H', 'E', 'D', 1 };
+const char HEADER_MAGIC_V2[] = { 'H', 'E', 'D', 2 };
+const char HEADER_MAGIC_V2_LZ[] = { 'H', 'E', 'Z', 2 };
+const char HEADER_MAGIC_V3[] = { 'H', 'E', 'D', 3 };
+const char HEADER_MAGIC_V3_LZ[] = { 'H', 'E', 'Z', 3 };
 const size_t HEADER_MAGIC_SIZE = sizeof(HEADER_MAGIC_V1);
+const char INDEX_MAGIC[INDEX_MAGIC_SIZE] = { 'H', 'I', 'X', 1 };
+
+// Exposes exactly one length prefixed value of the underlying stream
+typedef struct {
+	hgraph_in_t impl;
+	hgraph_in_t* in;
+	size_t remaining;
+} hgraph_value_in_t;
+
+HGRAPH_INTERNAL const hgraph_var_t*
+hgraph_find_attribute(
+	const hgraph_registry_t* registry,
+	const hgraph_node_type_info_t* type_info,
+	hgraph_str_t type,
+	hgraph_str_t name
+) {
+	hgraph_index_t index = hgraph_registry_find_var(
+		registry, type_info, HGRAPH_NAME_ATTRIBUTE, name
+	);
+	if (!HGRAPH_IS_VALID_INDEX(index)) { return NULL; }
+
+	// If the type does not match, ignore this attribute
+	const hgraph_var_t* var = &type_info->attributes[index];
+	return hgraph_str_equal(registry->data_types[var->type].name, type)
+		? var
+		: NULL;
+}
 
-HGRAPH_PRIVATE hgraph_io_status_t
-hgraph_write_graph_v1(const hgraph_t* graph, hgraph_out_t* out) {
-	hgraph_index_t num_nodes = graph->node_slot_map.num_items;
-	HGRAPH_CHECK_IO(hgraph_io_write_uint(num_nodes, out));
-
-	hgraph_index_t max_name_length = 0;
-	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
-		const hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
-		hgraph_str_t name = hgraph_get_node_name_internal(graph, node);
-		max_name_length = HGRAPH_MAX(max_name_length, name.length);
-	}
-	HGRAPH_CHECK_IO(hgraph_io_write_uint(max_name_length, out));
-
-	HGRAPH_CHECK_IO(hgraph_io_write_uint(num_nodes, out));
-	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
-		const hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
-
-		const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(
-			graph, node
-		);
-		HGRAPH_CHECK_IO(hgraph_io_write_str(type_info->name, out));
+HGRAPH_PRIVATE size_t
+hgraph_measure_out_write(hgraph_out_t* impl, const void* buffer, size_t size) {
+	(void)buffer;
+	hgraph_measure_out_t* measure = HGRAPH_CONTAINER_OF(impl, hgraph_measure_out_t, impl);
+	measure->size += (size_t)(impl->pos - measure->buffer) + size;
+	impl->pos = measure->buffer;
+	return size;
+}
 
-		hgraph_str_t name = hgraph_get_node_name_internal(graph, node);
-		HGRAPH_CHECK_IO(hgraph_io_write_str(name, out));
+HGRAPH_INTERNAL hgraph_out_t*
+hgraph_measure_out_init(hgraph_measure_out_t* measure) {
+	measure->size = 0;
+	measure->impl = (hgraph_out_t){
+		.write = hgraph_measure_out_write,
+		.pos = measure->buffer,
+		.end = measure->buffer + sizeof(measure->buffer),
+	};
+	return &measure->impl;
+}
 
-		HGRAPH_CHECK_IO(hgraph_io_write_uint(type_info->num_attributes, out));
-		for (hgraph_index_t j = 0; j < type_info->num_attributes; ++j) {
-			const hgraph_var_t* var = &type_info->attributes[j];
-			const hgraph_data_type_info_t* data_type = &graph->registry->data_types[var->type];
+HGRAPH_INTERNAL size_t
+hgraph_measure_out_size(const hgraph_out_t* impl) {
+	const hgraph_measure_out_t* measure = HGRAPH_CONTAINER_OF(impl, hgraph_measure_out_t, impl);
+	return measure->size + (size_t)(impl->pos - measure->buffer);
+}
 
-			HGRAPH_CHECK_IO(hgraph_io_write_str(data_type->name, out));
-			HGRAPH_CHECK_IO(hgraph_io_write_str(var->name, out));
+HGRAPH_PRIVATE size_t
+hgraph_value_out_overflow(hgraph_out_t* impl, const void* buffer, size_t size) {
+	(void)impl;
+	(void)buffer;
+	(void)size;
+	return 0;
+}
 
-			const void* value = (char*)node + var->offset;
-			hgraph_slip_out_t slip;
-			hgraph_out_t* wrapped_out = hgraph_slip_out_init(&slip, out);
-			HGRAPH_CHECK_IO(data_type->definition->serialize(value, wrapped_out));
-			HGRAPH_CHECK_IO(hgraph_slip_out_end(out));
-		}
+// The size of a value precedes it so most values are serialized once into a
+// buffer and copied.
+// Those which do not fit are measured first and serialized a second time.
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_write_value(
+	const hgraph_data_type_info_t* data_type,
+	const void* value,
+	hgraph_out_t* out
+) {
+	char buffer[256];
+	hgraph_out_t buffer_out = {
+		.write = hgraph_value_out_overflow,
+		.pos = buffer,
+		.end = buffer + sizeof(buffer),
+	};
+	if (data_type->definition->serialize(value, &buffer_out) == HGRAPH_IO_OK) {
+		size_t size = (size_t)(buffer_out.pos - buffer);
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(size, out));
+		return hgraph_io_write(out, buffer, size);
 	}
 
-	hgraph_index_t num_edges = graph->edge_slot_map.num_items;
-	HGRAPH_CHECK_IO(hgraph_io_write_uint(num_edges, out));
-	for (hgraph_index_t i = 0; i < num_edges; ++i) {
-		const hgraph_edge_t* edge = &graph->edges[i];
-
-		bool is_output;
-		hgraph_index_t from_node_id, from_pin_index;
-		hgraph_decode_pin_id(edge->from_pin, &from_node_id, &from_pin_index, &is_output);
+	hgraph_measure_out_t measure;
+	hgraph_out_t* measure_out = hgraph_measure_out_init(&measure);
+	HGRAPH_CHECK_IO(data_type->definition->serialize(value, measure_out));
 
-		hgraph_index_t to_node_id, to_pin_index;
-		hgraph_decode_pin_id(edge->to_pin, &to_node_id, &to_pin_index, &is_output);
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(hgraph_measure_out_size(measure_out), out));
+	return data_type->definition->serialize(value, out);
+}
 
-		hgraph_node_t* from_node = hgraph_find_node_by_id(graph, from_node_id);
-		hgraph_node_t* to_node = hgraph_find_node_by_id(graph, to_node_id);
+// Lend the part of the underlying window which belongs to the value
+HGRAPH_PRIVATE void
+hgraph_value_in_take_window(hgraph_value_in_t* value_in) {
+	hgraph_in_t* in = value_in->in;
+	size_t size = HGRAPH_MIN(hgraph_io_available(in), value_in->remaining);
+	if (size == 0) {
+		value_in->impl.pos = value_in->impl.end = NULL;
+		return;
+	}
 
-		const hgraph_node_type_info_t* from_type_info = hgraph_get_node_type_internal(
-			graph, from_node
-		);
-		const hgraph_node_type_info_t* to_type_info = hgraph_get_node_type_internal(
-			graph, to_node
-		);
+	value_in->impl.pos = in->pos;
+	value_in->impl.end = in->pos + size;
+	in->pos += size;
+	value_in->remaining -= size;
+}
 
-		hgraph_index_t from_node_slot = ((char*)from_node - graph->nodes) / graph->node_size;
-		hgraph_index_t to_node_slot = ((char*)to_node - graph->nodes) / graph->node_size;
+HGRAPH_PRIVATE size_t
+hgraph_value_in_read(hgraph_in_t* impl, void* buffer, size_t size) {
+	hgraph_value_in_t* value_in = HGRAPH_CONTAINER_OF(impl, hgraph_value_in_t, impl);
+	char* dst = buffer;
 
-		HGRAPH_CHECK_IO(hgraph_io_write_uint(from_node_slot, out));
-		HGRAPH_CHECK_IO(hgraph_io_write_str(from_type_info->output_pins[from_pin_index].name, out));
+	size_t total = HGRAPH_MIN(hgraph_io_available(impl), size);
+	if (total > 0) {
+		memcpy(dst, impl->pos, total);
+		impl->pos += total;
+	}
 
-		HGRAPH_CHECK_IO(hgraph_io_write_uint(to_node_slot, out));
-		HGRAPH_CHECK_IO(hgraph_io_write_str(to_type_info->input_pins[to_pin_index].name, out));
+	size_t read_size = HGRAPH_MIN(size - total, value_in->remaining);
+	if (read_size > 0) {
+		if (hgraph_io_read(value_in->in, dst + total, read_size) != HGRAPH_IO_OK) {
+			return total;
+		}
+		total += read_size;
+		value_in->remaining -= read_size;
 	}
 
-	return HGRAPH_IO_OK;
+	hgraph_value_in_take_window(value_in);
+	return total;
+}
+
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_value(
+	const hgraph_data_type_info_t* data_type,
+	void* value,
+	size_t size,
+	hgraph_in_t* in
+) {
+	hgraph_value_in_t value_in = {
+		.impl = { .read = hgraph_value_in_read },
+		.in = in,
+		.remaining = size,
+	};
+	hgraph_value_in_take_window(&value_in);
+	HGRAPH_CHECK_IO(data_type->definition->deserialize(value, &value_in.impl));
+
+	// Like the end of a SLIP frame in v1, the whole value must be consumed
+	return hgraph_io_available(&value_in.impl) == 0 && value_in.remaining == 0
+		? HGRAPH_IO_OK
+		: HGRAPH_IO_MALFORMED;
 }
 
 HGRAPH_PRIVATE hgraph_io_status_t
@@ -93,12 +173,15 @@ hgraph_read_graph_config_v1(hgraph_config_t* config, hgraph_in_t* in) {
 
 	config->max_nodes = num_nodes;
 	config->max_name_length = max_name_length;
+	// The file knows its longest name so every node can have one
+	config->name_storage_size = config->max_nodes
+		* hgraph_name_entry_size(config->max_name_length);
 	return HGRAPH_IO_OK;
 }
 
 HGRAPH_PRIVATE hgraph_io_status_t
 hgraph_read_graph_v1(hgraph_t* graph, hgraph_in_t* in) {
-	hgraph_index_t num_node_types = graph->registry->num_node_types;
+	const hgraph_registry_t* registry = graph->registry;
 	const hgraph_node_type_info_t* node_types = graph->registry->node_types;
 	const hgraph_data_type_info_t* data_types = graph->registry->data_types;
 
@@ -116,21 +199,29 @@ hgraph_read_graph_v1(hgraph_t* graph, hgraph_in_t* in) {
 		HGRAPH_CHECK_IO(hgraph_io_read_str(type_buf, &len, in));
 		type.length = len;
 
-		const hgraph_node_type_info_t* node_type_info = &node_types[0];
-		for (hgraph_index_t j = 1; j < num_node_types; ++j) {
-			if (hgraph_str_equal(node_types[j].name, type)) {
-				node_type_info = &node_types[j];
-				break;
-			}
-		}
+		// Nodes of an unknown type are read as dummies and removed at the end
+		const hgraph_node_type_info_t* node_type_info = hgraph_registry_find_node_type(
+			registry, type
+		);
+		if (node_type_info == NULL) { node_type_info = &node_types[0]; }
 
 		hgraph_index_t node_id = hgraph_create_node(graph, node_type_info->definition);
 		if (!HGRAPH_IS_VALID_INDEX(node_id)) { return HGRAPH_IO_MALFORMED; }
 
+		// Read the name straight into the free space of the name storage
+		char* name_storage = hgraph_name_reserve(graph, graph->max_name_length);
+		if (name_storage == NULL) { return HGRAPH_IO_MALFORMED; }
+		size_t name_length = graph->max_name_length;
+		HGRAPH_CHECK_IO(hgraph_io_read_str(name_storage, &name_length, in));
+		hgraph_str_t node_name = {
+			.data = name_storage,
+			.length = (hgraph_index_t)name_length,
+		};
+		if (!hgraph_set_node_name(graph, node_id, node_name)) {
+			return HGRAPH_IO_MALFORMED;
+		}
+
 		hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
-		char* name_storage = (char*)node + node_type_info->size;
-		node->name_len = graph->max_name_length;
-		HGRAPH_CHECK_IO(hgraph_io_read_str(name_storage, &node->name_len, in));
 
 		uint64_t num_attributes_varint;
 		HGRAPH_CHECK_IO(hgraph_io_read_uint(&num_attributes_varint, in));
@@ -144,34 +235,23 @@ hgraph_read_graph_v1(hgraph_t* graph, hgraph_in_t* in) {
 			HGRAPH_CHECK_IO(hgraph_io_read_str(name_buf, &len, in));
 			name.length = len;
 
-			hgraph_index_t num_attributes = node_type_info->num_attributes;
-			const hgraph_var_t* attribute = NULL;
-			const hgraph_data_type_info_t* attribute_type = NULL;
-			for (hgraph_index_t k = 0; k < num_attributes; ++k) {
-				const hgraph_var_t* var = &node_type_info->attributes[k];
-				if (hgraph_str_equal(var->name, name)) {
-					const hgraph_data_type_info_t* var_type = &data_types[var->type];
-
-					if (hgraph_str_equal(var_type->name, type)) {
-						attribute = var;
-						attribute_type = var_type;
-					}
-
-					// If the type does not match, ignore this attribute
-					break;
-				}
-			}
-
+			const hgraph_var_t* attribute = hgraph_find_attribute(
+				graph->registry, node_type_info, type, name
+			);
 			if (attribute != NULL) {
 				hgraph_slip_in_t slip;
 				hgraph_in_t* wrapped_in = hgraph_slip_in_init(&slip, in);
 				void* value = (char*)node + attribute->offset;
+				const hgraph_data_type_info_t* attribute_type = &data_types[attribute->type];
 				HGRAPH_CHECK_IO(attribute_type->definition->deserialize(value, wrapped_in));
 				HGRAPH_CHECK_IO(hgraph_slip_in_end(in));
 			} else {
 				HGRAPH_CHECK_IO(hgraph_slip_in_skip(in));
 			}
 		}
+
+		hgraph_mark_node_dirty(graph, node);
+		hgraph_digest_update_node(graph, node_id);
 	}
 
 	uint64_t num_edges_varint;
@@ -208,24 +288,14 @@ hgraph_read_graph_v1(hgraph_t* graph, hgraph_in_t* in) {
 		const hgraph_node_type_info_t* from_node_type = &node_types[from_node->type];
 		const hgraph_node_type_info_t* to_node_type = &node_types[to_node->type];
 
-		hgraph_index_t from_pin_index = HGRAPH_INVALID_INDEX;
-		for (hgraph_index_t j = 0; j < from_node_type->num_output_pins; ++j) {
-			const hgraph_var_t* pin = &from_node_type->output_pins[j];
-			if (hgraph_str_equal(pin->name, from_pin_name)) {
-				from_pin_index = j;
-				break;
-			}
-		}
+		hgraph_index_t from_pin_index = hgraph_registry_find_var(
+			registry, from_node_type, HGRAPH_NAME_OUTPUT_PIN, from_pin_name
+		);
 		if (!HGRAPH_IS_VALID_INDEX(from_pin_index)) { continue; }
 
-		hgraph_index_t to_pin_index = HGRAPH_INVALID_INDEX;
-		for (hgraph_index_t j = 0; j < to_node_type->num_input_pins; ++j) {
-			const hgraph_var_t* pin = &to_node_type->input_pins[j];
-			if (hgraph_str_equal(pin->name, to_pin_name)) {
-				to_pin_index = j;
-				break;
-			}
-		}
+		hgraph_index_t to_pin_index = hgraph_registry_find_var(
+			registry, to_node_type, HGRAPH_NAME_INPUT_PIN, to_pin_name
+		);
 		if (!HGRAPH_IS_VALID_INDEX(to_pin_index)) { continue; }
 
 		hgraph_index_t from_node_id = hgraph_slot_map_id_for_slot(
@@ -240,7 +310,7 @@ hgraph_read_graph_v1(hgraph_t* graph, hgraph_in_t* in) {
 		hgraph_index_t from_pin = hgraph_encode_pin_id(from_node_id, from_pin_index, true);
 		hgraph_index_t to_pin = hgraph_encode_pin_id(to_node_id, to_pin_index, false);
 
-		hgraph_connect(graph, from_pin, to_pin);
+		HGRAPH_CHECK_IO(hgraph_read_connect(graph, from_pin, to_pin));
 	}
 
 	// Remove dummy nodes
@@ -261,9 +331,430 @@ hgraph_read_graph_v1(hgraph_t* graph, hgraph_in_t* in) {
 	return HGRAPH_IO_OK;
 }
 
+// The index has fixed width entries so they can be located without decoding
+// the ones before
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_index_entry(uint64_t value, hgraph_out_t* index) {
+	return index != NULL ? hgraph_io_write_u64(value, index) : HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_index_offset(hgraph_crc_out_t* sections, hgraph_out_t* index) {
+	if (index == NULL) { return HGRAPH_IO_OK; }
+
+	hgraph_crc_out_sync(sections);
+	return hgraph_io_write_u64(hgraph_measure_out_size(sections->inner), index);
+}
+
+// Section checksums are only in v3
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_check_section(hgraph_crc_in_t* sections) {
+	return sections != NULL ? hgraph_crc_in_end_section(sections) : HGRAPH_IO_OK;
+}
+
+// v3 is v2 with the config, the group count, every group and the edges each
+// followed by the CRC32C of their bytes, see crc.c.
+//
+// Nodes are written in groups of the same type.
+// The group header names the type and its pins once, edges refer to pins by
+// their index in the header and to nodes by id.
+// Attributes are written column by column, each value prefixed with its size
+// so unknown attributes can be skipped without decoding them.
+//
+// There is no file wide string table: names are only deduplicated within a
+// group. The data type and name of an attribute are repeated in every group
+// of a type which has it, so strings grow with the number of types rather
+// than nodes. In exchange every group can be decoded on its own, which the
+// indexed and parallel readers in file.c rely on.
+//
+// When an index is requested, out must be a measure stream and the offset of
+// every group, node, column and value is written to the index in the order
+// they are reached:
+//
+//   num_groups
+//   per group: offset, num_nodes, num_attributes, node offsets,
+//              per attribute: column offset, value offsets
+//   edges offset, num_edges
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_write_graph_v3(const hgraph_t* graph, hgraph_out_t* out, hgraph_out_t* index) {
+	const hgraph_registry_t* registry = graph->registry;
+	hgraph_crc_out_t sections;
+	out = hgraph_crc_out_init(&sections, out);
+	const hgraph_index_t* type_heads = hgraph_type_heads(graph);
+	const hgraph_node_link_t* links = hgraph_type_links(graph);
+
+	hgraph_index_t node_id_limit = 0;
+	hgraph_index_t max_name_length = 0;
+	for (hgraph_index_t i = 0; i < graph->node_slot_map.num_items; ++i) {
+		const hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
+		hgraph_index_t node_id = hgraph_slot_map_id_for_slot(&graph->node_slot_map, i);
+		hgraph_str_t name = hgraph_get_node_name_internal(graph, node);
+		node_id_limit = HGRAPH_MAX(node_id_limit, node_id + 1);
+		max_name_length = HGRAPH_MAX(max_name_length, name.length);
+	}
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(node_id_limit, out));
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(max_name_length, out));
+	HGRAPH_CHECK_IO(hgraph_crc_out_end_section(&sections));
+
+	hgraph_index_t num_groups = 0;
+	for (hgraph_index_t i = 0; i < registry->num_node_types; ++i) {
+		num_groups += HGRAPH_IS_VALID_INDEX(type_heads[i]);
+	}
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(num_groups, out));
+	HGRAPH_CHECK_IO(hgraph_crc_out_end_section(&sections));
+	HGRAPH_CHECK_IO(hgraph_write_index_entry(num_groups, index));
+
+	for (hgraph_index_t i = 0; i < registry->num_node_types; ++i) {
+		hgraph_index_t head = type_heads[i];
+		if (!HGRAPH_IS_VALID_INDEX(head)) { continue; }
+
+		const hgraph_node_type_info_t* type_info = &registry->node_types[i];
+		HGRAPH_CHECK_IO(hgraph_write_index_offset(&sections, index));
+		HGRAPH_CHECK_IO(hgraph_io_write_str(type_info->name, out));
+
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(type_info->num_output_pins, out));
+		for (hgraph_index_t j = 0; j < type_info->num_output_pins; ++j) {
+			HGRAPH_CHECK_IO(hgraph_io_write_str(type_info->output_pins[j].name, out));
+		}
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(type_info->num_input_pins, out));
+		for (hgraph_index_t j = 0; j < type_info->num_input_pins; ++j) {
+			HGRAPH_CHECK_IO(hgraph_io_write_str(type_info->input_pins[j].name, out));
+		}
+
+		hgraph_index_t num_nodes = 0;
+		for (hgraph_index_t id = head; HGRAPH_IS_VALID_INDEX(id); id = links[id].next) {
+			++num_nodes;
+		}
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(num_nodes, out));
+		HGRAPH_CHECK_IO(hgraph_write_index_entry(num_nodes, index));
+		HGRAPH_CHECK_IO(hgraph_write_index_entry(type_info->num_attributes, index));
+		for (hgraph_index_t id = head; HGRAPH_IS_VALID_INDEX(id); id = links[id].next) {
+			const hgraph_node_t* node = hgraph_find_node_by_id(graph, id);
+			HGRAPH_CHECK_IO(hgraph_write_index_offset(&sections, index));
+			HGRAPH_CHECK_IO(hgraph_io_write_uint(id, out));
+			HGRAPH_CHECK_IO(hgraph_io_write_str(hgraph_get_node_name_internal(graph, node), out));
+		}
+
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(type_info->num_attributes, out));
+		for (hgraph_index_t j = 0; j < type_info->num_attributes; ++j) {
+			const hgraph_var_t* var = &type_info->attributes[j];
+			const hgraph_data_type_info_t* data_type = &registry->data_types[var->type];
+			HGRAPH_CHECK_IO(hgraph_write_index_offset(&sections, index));
+			HGRAPH_CHECK_IO(hgraph_io_write_str(data_type->name, out));
+			HGRAPH_CHECK_IO(hgraph_io_write_str(var->name, out));
+
+			for (hgraph_index_t id = head; HGRAPH_IS_VALID_INDEX(id); id = links[id].next) {
+				const void* value = (char*)hgraph_find_node_by_id(graph, id) + var->offset;
+				HGRAPH_CHECK_IO(hgraph_write_index_offset(&sections, index));
+				HGRAPH_CHECK_IO(hgraph_write_value(data_type, value, out));
+			}
+		}
+
+		HGRAPH_CHECK_IO(hgraph_crc_out_end_section(&sections));
+	}
+
+	hgraph_index_t num_edges = graph->edge_slot_map.num_items;
+	HGRAPH_CHECK_IO(hgraph_write_index_offset(&sections, index));
+	HGRAPH_CHECK_IO(hgraph_write_index_entry(num_edges, index));
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(num_edges, out));
+	for (hgraph_index_t i = 0; i < num_edges; ++i) {
+		const hgraph_edge_t* edge = &hgraph_edges(graph)[i];
+
+		bool is_output;
+		hgraph_index_t from_node_id, from_pin_index;
+		hgraph_decode_pin_id(edge->from_pin, &from_node_id, &from_pin_index, &is_output);
+
+		hgraph_index_t to_node_id, to_pin_index;
+		hgraph_decode_pin_id(edge->to_pin, &to_node_id, &to_pin_index, &is_output);
+
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(from_node_id, out));
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(from_pin_index, out));
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(to_node_id, out));
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(to_pin_index, out));
+	}
+
+	return hgraph_crc_out_end_section(&sections);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_graph_config_v2(hgraph_config_t* config, hgraph_in_t* in, bool checksums) {
+	hgraph_crc_in_t crc_in;
+	hgraph_crc_in_t* sections = checksums ? &crc_in : NULL;
+	if (checksums) { in = hgraph_crc_in_init(&crc_in, in); }
+
+	uint64_t node_id_limit;
+	uint64_t max_name_length;
+
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&node_id_limit, in));
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&max_name_length, in));
+	HGRAPH_CHECK_IO(hgraph_check_section(sections));
+
+	config->max_nodes = node_id_limit;
+	config->max_name_length = max_name_length;
+	config->name_storage_size = config->max_nodes
+		* hgraph_name_entry_size(config->max_name_length);
+	return HGRAPH_IO_OK;
+}
+
+// Map the pins listed in a group header to the pins of the registered type
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_pin_remap_v2(
+	const hgraph_registry_t* registry,
+	const hgraph_node_type_info_t* type_info,
+	hgraph_name_kind_t kind,
+	int8_t* remap,
+	hgraph_in_t* in
+) {
+	uint64_t num_file_pins;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&num_file_pins, in));
+	if (num_file_pins > (uint64_t)HGRAPH_MAX_PINS) { return HGRAPH_IO_MALFORMED; }
+
+	for (hgraph_index_t i = 0; i < HGRAPH_MAX_PINS; ++i) {
+		remap[i] = -1;
+	}
+
+	for (hgraph_index_t i = 0; i < (hgraph_index_t)num_file_pins; ++i) {
+		char name_buf[256];
+		size_t len = sizeof(name_buf) - 1;
+		HGRAPH_CHECK_IO(hgraph_io_read_str(name_buf, &len, in));
+		hgraph_str_t name = { .data = name_buf, .length = (hgraph_index_t)len };
+
+		if (type_info == NULL) { continue; }
+
+		hgraph_index_t pin_index = hgraph_registry_find_var(registry, type_info, kind, name);
+		if (HGRAPH_IS_VALID_INDEX(pin_index)) { remap[i] = (int8_t)pin_index; }
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_INTERNAL void
+hgraph_reset_pin_remaps_v2(hgraph_t* graph) {
+	memset(
+		hgraph_pin_remaps(graph),
+		-1,
+		sizeof(int8_t) * graph->registry->num_node_types * HGRAPH_MAX_PINS * 2
+	);
+}
+
+// Read the type and pin names of a group, the pins of a known type are
+// mapped in the pin remaps of the graph.
+// Nodes of an unknown type are skipped along with their edges.
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_group_header_v2(
+	hgraph_t* graph,
+	const hgraph_node_type_info_t** type_info_out,
+	hgraph_in_t* in
+) {
+	const hgraph_registry_t* registry = graph->registry;
+	const hgraph_node_type_info_t* node_types = registry->node_types;
+
+	char type_buf[256];
+	size_t len = sizeof(type_buf) - 1;
+	HGRAPH_CHECK_IO(hgraph_io_read_str(type_buf, &len, in));
+	hgraph_str_t type = { .data = type_buf, .length = (hgraph_index_t)len };
+
+	const hgraph_node_type_info_t* type_info = hgraph_registry_find_node_type(registry, type);
+
+	int8_t unknown_remap[HGRAPH_MAX_PINS * 2];
+	int8_t* remap = type_info != NULL
+		? &hgraph_pin_remaps(graph)[(type_info - node_types) * HGRAPH_MAX_PINS * 2]
+		: unknown_remap;
+	HGRAPH_CHECK_IO(hgraph_read_pin_remap_v2(
+		registry, type_info, HGRAPH_NAME_OUTPUT_PIN, remap, in
+	));
+	HGRAPH_CHECK_IO(hgraph_read_pin_remap_v2(
+		registry, type_info, HGRAPH_NAME_INPUT_PIN, remap + HGRAPH_MAX_PINS, in
+	));
+
+	*type_info_out = type_info;
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_nodes_v2(hgraph_t* graph, hgraph_in_t* in, hgraph_crc_in_t* sections) {
+	const hgraph_registry_t* registry = graph->registry;
+	const hgraph_data_type_info_t* data_types = registry->data_types;
+
+	hgraph_reset_pin_remaps_v2(graph);
+
+	uint64_t num_groups_varint;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&num_groups_varint, in));
+	HGRAPH_CHECK_IO(hgraph_check_section(sections));
+	for (uint64_t i = 0; i < num_groups_varint; ++i) {
+		char type_buf[256];
+		char name_buf[256];
+		size_t len;
+		hgraph_str_t type = { .data = type_buf };
+
+		const hgraph_node_type_info_t* type_info;
+		HGRAPH_CHECK_IO(hgraph_read_group_header_v2(graph, &type_info, in));
+
+		// Nodes of a group are created one after another so they occupy
+		// consecutive slots
+		uint64_t num_nodes_varint;
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&num_nodes_varint, in));
+		hgraph_index_t first_slot = graph->node_slot_map.num_items;
+		hgraph_index_t num_nodes = num_nodes_varint;
+		for (hgraph_index_t j = 0; j < num_nodes; ++j) {
+			uint64_t node_id;
+			HGRAPH_CHECK_IO(hgraph_io_read_uint(&node_id, in));
+
+			// Read the name straight into the free space of the name storage
+			char* name_storage = hgraph_name_reserve(graph, graph->max_name_length);
+			if (name_storage == NULL) { return HGRAPH_IO_MALFORMED; }
+			size_t name_length = graph->max_name_length;
+			HGRAPH_CHECK_IO(hgraph_io_read_str(name_storage, &name_length, in));
+			hgraph_str_t node_name = {
+				.data = name_storage,
+				.length = (hgraph_index_t)name_length,
+			};
+
+			if (type_info == NULL) { continue; }
+
+			if (node_id >= (uint64_t)graph->node_slot_map.max_items) {
+				return HGRAPH_IO_MALFORMED;
+			}
+			hgraph_index_t created_id = hgraph_create_node_with_id(
+				graph, type_info, (hgraph_index_t)node_id
+			);
+			if (!HGRAPH_IS_VALID_INDEX(created_id)) { return HGRAPH_IO_MALFORMED; }
+
+			if (!hgraph_set_node_name(graph, created_id, node_name)) {
+				return HGRAPH_IO_MALFORMED;
+			}
+		}
+
+		uint64_t num_attributes_varint;
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&num_attributes_varint, in));
+		for (uint64_t j = 0; j < num_attributes_varint; ++j) {
+			len = sizeof(type_buf) - 1;
+			HGRAPH_CHECK_IO(hgraph_io_read_str(type_buf, &len, in));
+			type.length = len;
+
+			len = sizeof(name_buf) - 1;
+			HGRAPH_CHECK_IO(hgraph_io_read_str(name_buf, &len, in));
+			hgraph_str_t name = { .data = name_buf, .length = (hgraph_index_t)len };
+
+			const hgraph_var_t* attribute = type_info != NULL
+				? hgraph_find_attribute(registry, type_info, type, name)
+				: NULL;
+			for (hgraph_index_t k = 0; k < num_nodes; ++k) {
+				uint64_t size;
+				HGRAPH_CHECK_IO(hgraph_io_read_uint(&size, in));
+
+				if (attribute != NULL) {
+					hgraph_node_t* node = hgraph_get_node_by_slot(graph, first_slot + k);
+					void* value = (char*)node + attribute->offset;
+					HGRAPH_CHECK_IO(hgraph_read_value(&data_types[attribute->type], value, size, in));
+				} else {
+					HGRAPH_CHECK_IO(hgraph_io_skip(in, size));
+				}
+			}
+		}
+		HGRAPH_CHECK_IO(hgraph_check_section(sections));
+
+		if (type_info == NULL) { continue; }
+
+		for (hgraph_index_t j = 0; j < num_nodes; ++j) {
+			hgraph_node_t* node = hgraph_get_node_by_slot(graph, first_slot + j);
+			hgraph_mark_node_dirty(graph, node);
+			hgraph_digest_update_node(
+				graph,
+				hgraph_slot_map_id_for_slot(&graph->node_slot_map, first_slot + j)
+			);
+		}
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_edges_v2(hgraph_t* graph, hgraph_in_t* in) {
+	const int8_t* pin_remaps = hgraph_pin_remaps(graph);
+
+	uint64_t num_edges_varint;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&num_edges_varint, in));
+	for (uint64_t i = 0; i < num_edges_varint; ++i) {
+		uint64_t from_node_id, from_pin, to_node_id, to_pin;
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&from_node_id, in));
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&from_pin, in));
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&to_node_id, in));
+		HGRAPH_CHECK_IO(hgraph_io_read_uint(&to_pin, in));
+
+		if (
+			from_pin >= (uint64_t)HGRAPH_MAX_PINS
+			|| to_pin >= (uint64_t)HGRAPH_MAX_PINS
+		) {
+			return HGRAPH_IO_MALFORMED;
+		}
+
+		// Either end may have been of an unknown type
+		uint64_t max_nodes = graph->node_slot_map.max_items;
+		if (from_node_id >= max_nodes || to_node_id >= max_nodes) { continue; }
+		const hgraph_node_t* from_node = hgraph_find_node_by_id(graph, from_node_id);
+		const hgraph_node_t* to_node = hgraph_find_node_by_id(graph, to_node_id);
+		if (from_node == NULL || to_node == NULL) { continue; }
+
+		int8_t from_pin_index = pin_remaps[from_node->type * HGRAPH_MAX_PINS * 2 + from_pin];
+		int8_t to_pin_index = pin_remaps[
+			to_node->type * HGRAPH_MAX_PINS * 2 + HGRAPH_MAX_PINS + to_pin
+		];
+		if (from_pin_index < 0 || to_pin_index < 0) { continue; }
+
+		HGRAPH_CHECK_IO(hgraph_read_connect(
+			graph,
+			hgraph_encode_pin_id(from_node_id, from_pin_index, true),
+			hgraph_encode_pin_id(to_node_id, to_pin_index, false)
+		));
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+// Pins whose types changed since the file was written are left unconnected
+// but a cycle can only come from a file written before they were rejected
+// and dropping its edges would lose them on the next save
+HGRAPH_INTERNAL hgraph_io_status_t
+hgraph_read_connect(hgraph_t* graph, hgraph_index_t from_pin, hgraph_index_t to_pin) {
+	if (HGRAPH_IS_VALID_INDEX(hgraph_connect(graph, from_pin, to_pin))) {
+		return HGRAPH_IO_OK;
+	}
+
+	bool is_output;
+	hgraph_index_t from_node_id, to_node_id, pin_index;
+	hgraph_decode_pin_id(from_pin, &from_node_id, &pin_index, &is_output);
+	hgraph_decode_pin_id(to_pin, &to_node_id, &pin_index, &is_output);
+	if (from_node_id == to_node_id) { return HGRAPH_IO_MALFORMED; }
+
+	return hgraph_order_can_add_edge(graph, from_node_id, to_node_id)
+		? HGRAPH_IO_OK
+		: HGRAPH_IO_MALFORMED;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_read_graph_v2(hgraph_t* graph, hgraph_in_t* in, bool checksums) {
+	hgraph_crc_in_t crc_in;
+	hgraph_crc_in_t* sections = checksums ? &crc_in : NULL;
+	if (checksums) { in = hgraph_crc_in_init(&crc_in, in); }
+
+	hgraph_write_begin(graph);
+	hgraph_io_status_t nodes_status = hgraph_read_nodes_v2(graph, in, sections);
+	hgraph_write_end(graph);
+	HGRAPH_CHECK_IO(nodes_status);
+
+	HGRAPH_CHECK_IO(hgraph_read_edges_v2(graph, in));
+	return hgraph_check_section(sections);
+}
+
 hgraph_io_status_t
 hgraph_write_header(hgraph_out_t* out) {
-	return hgraph_io_write(out, HEADER_MAGIC_V1, HEADER_MAGIC_SIZE);
+	return hgraph_io_write(out, HEADER_MAGIC_V3, HEADER_MAGIC_SIZE);
+}
+
+hgraph_io_status_t
+hgraph_write_compressed_header(hgraph_out_t* out) {
+	return hgraph_io_write(out, HEADER_MAGIC_V3_LZ, HEADER_MAGIC_SIZE);
 }
 
 hgraph_io_status_t
@@ -271,8 +762,19 @@ hgraph_read_header(hgraph_header_t* header, hgraph_in_t* in) {
 	char magic[HEADER_MAGIC_SIZE];
 	HGRAPH_CHECK_IO(hgraph_io_read(in, magic, HEADER_MAGIC_SIZE));
 
+	header->compressed = false;
 	if (memcmp(magic, HEADER_MAGIC_V1, HEADER_MAGIC_SIZE) == 0) {
 		header->version = 1;
+	} else if (memcmp(magic, HEADER_MAGIC_V2, HEADER_MAGIC_SIZE) == 0) {
+		header->version = 2;
+	} else if (memcmp(magic, HEADER_MAGIC_V2_LZ, HEADER_MAGIC_SIZE) == 0) {
+		header->version = 2;
+		header->compressed = true;
+	} else if (memcmp(magic, HEADER_MAGIC_V3, HEADER_MAGIC_SIZE) == 0) {
+		header->version = 3;
+	} else if (memcmp(magic, HEADER_MAGIC_V3_LZ, HEADER_MAGIC_SIZE) == 0) {
+		header->version = 3;
+		header->compressed = true;
 	} else {
 		return HGRAPH_IO_MALFORMED;
 	}
@@ -282,7 +784,19 @@ hgraph_read_header(hgraph_header_t* header, hgraph_in_t* in) {
 
 hgraph_io_status_t
 hgraph_write_graph(const hgraph_t* graph, hgraph_out_t* out) {
-	return hgraph_write_graph_v1(graph, out);
+	return hgraph_write_graph_v3(graph, out, NULL);
+}
+
+hgraph_io_status_t
+hgraph_write_graph_index(const hgraph_t* graph, hgraph_out_t* out) {
+	// Replay the writer without output to learn where everything lands
+	hgraph_measure_out_t measure;
+	hgraph_out_t* graph_out = hgraph_measure_out_init(&measure);
+	HGRAPH_CHECK_IO(hgraph_write_graph_v3(graph, graph_out, out));
+
+	// The trailer locates the index from the end of the file
+	HGRAPH_CHECK_IO(hgraph_io_write_u64(hgraph_measure_out_size(graph_out), out));
+	return hgraph_io_write(out, INDEX_MAGIC, sizeof(INDEX_MAGIC));
 }
 
 hgraph_io_status_t
@@ -294,6 +808,9 @@ hgraph_read_graph_config(
 	switch (header->version) {
 		case 1:
 			return hgraph_read_graph_config_v1(config, in);
+		case 2:
+		case 3:
+			return hgraph_read_graph_config_v2(config, in, header->version >= 3);
 		default:
 			return HGRAPH_IO_MALFORMED;
 	}
@@ -308,6 +825,9 @@ hgraph_read_graph(
 	switch (header->version) {
 		case 1:
 			return hgraph_read_graph_v1(graph, in);
+		case 2:
+		case 3:
+			return hgraph_read_graph_v2(graph, in, header->version >= 3);
 		default:
 			return HGRAPH_IO_MALFORMED;
 	}
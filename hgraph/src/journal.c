@@ -0,0 +1,483 @@
+#include "journal.h"
+#include "graph.h"
+
+HGRAPH_PRIVATE size_t
+hgraph_journal_record_size(size_t data_size) {
+	return (size_t)mem_layout_align_ptr(
+		(intptr_t)(hgraph_journal_data_offset() + data_size + sizeof(uint32_t)),
+		HGRAPH_JOURNAL_ALIGNMENT
+	);
+}
+
+HGRAPH_PRIVATE hgraph_journal_record_t*
+hgraph_journal_record_at(const hgraph_journal_t* journal, size_t position) {
+	return (hgraph_journal_record_t*)(journal->records + position);
+}
+
+HGRAPH_PRIVATE hgraph_journal_record_t*
+hgraph_journal_record_before(const hgraph_journal_t* journal, size_t position) {
+	uint32_t size;
+	memcpy(&size, journal->records + position - sizeof(uint32_t), sizeof(size));
+	return hgraph_journal_record_at(journal, position - size);
+}
+
+HGRAPH_PRIVATE void
+hgraph_journal_reset(hgraph_journal_t* journal) {
+	journal->end = 0;
+	journal->cursor = 0;
+	journal->step_start = 0;
+	journal->merge_floor = 0;
+	journal->has_save_point = false;
+}
+
+// Drop the oldest steps until at least size bytes are free.
+// The step being recorded is never dropped.
+HGRAPH_PRIVATE bool
+hgraph_journal_reserve(hgraph_journal_t* journal, size_t size) {
+	if (journal->capacity - journal->end >= size) { return true; }
+
+	// Free a quarter of the buffer at once to amortize the move
+	size_t target = HGRAPH_MAX(size, journal->capacity / 4);
+	size_t drop_end = 0;
+	while (
+		journal->capacity - journal->end + drop_end < target
+		&& drop_end < journal->step_start
+	) {
+		// Skip the step marker and find the next one
+		size_t position = drop_end + hgraph_journal_record_at(journal, drop_end)->size;
+		while (
+			position < journal->step_start
+			&& hgraph_journal_record_at(journal, position)->type != HGRAPH_JOURNAL_STEP
+		) {
+			position += hgraph_journal_record_at(journal, position)->size;
+		}
+
+		drop_end = position;
+	}
+
+	if (journal->capacity - journal->end + drop_end < size) { return false; }
+
+	memmove(journal->records, journal->records + drop_end, journal->end - drop_end);
+	journal->end -= drop_end;
+	journal->cursor -= drop_end;
+	journal->step_start -= drop_end;
+	journal->merge_floor = journal->merge_floor > drop_end
+		? journal->merge_floor - drop_end
+		: 0;
+	if (journal->save_point >= drop_end) {
+		journal->save_point -= drop_end;
+	} else {
+		// The records since the save are partially gone
+		journal->has_save_point = false;
+	}
+	return true;
+}
+
+HGRAPH_PRIVATE hgraph_journal_record_t*
+hgraph_journal_append(
+	hgraph_journal_t* journal,
+	hgraph_journal_record_t record,
+	const void* old_data,
+	const void* new_data
+) {
+	size_t record_size = hgraph_journal_record_size(record.old_size + record.new_size);
+	if (!hgraph_journal_reserve(journal, record_size)) { return NULL; }
+
+	record.size = (uint32_t)record_size;
+	char* ptr = journal->records + journal->end;
+	memcpy(ptr, &record, sizeof(record));
+	char* data = ptr + hgraph_journal_data_offset();
+	if (old_data != NULL) {
+		memcpy(data, old_data, record.old_size);
+	}
+	if (new_data != NULL) {
+		memcpy(data + record.old_size, new_data, record.new_size);
+	}
+	memcpy(ptr + record_size - sizeof(uint32_t), &record.size, sizeof(uint32_t));
+	journal->end += record_size;
+	journal->cursor = journal->end;
+
+	return (hgraph_journal_record_t*)ptr;
+}
+
+// Repeated writes to the same attribute are merged into a single step, which
+// is what is expected when dragging a value around.
+// This is decided once the step is complete since only a step made of that
+// single write can be merged.
+HGRAPH_PRIVATE void
+hgraph_journal_merge_step(hgraph_journal_t* journal) {
+	if (journal->step_start <= journal->merge_floor) { return; }
+
+	const hgraph_journal_record_t* step = hgraph_journal_record_at(journal, journal->step_start);
+	size_t record_position = journal->step_start + step->size;
+	if (record_position >= journal->end) { return; }
+
+	const hgraph_journal_record_t* record = hgraph_journal_record_at(journal, record_position);
+	if (
+		record->type != HGRAPH_JOURNAL_SET_ATTRIBUTE
+		|| record_position + record->size != journal->end
+	) {
+		return;
+	}
+
+	hgraph_journal_record_t* last = hgraph_journal_record_before(journal, journal->step_start);
+	size_t last_position = (char*)last - journal->records;
+	if (
+		last->type != HGRAPH_JOURNAL_SET_ATTRIBUTE
+		|| last->var.node != record->var.node
+		|| last->var.index != record->var.index
+		|| last->new_size != record->new_size
+	) {
+		return;
+	}
+
+	const hgraph_journal_record_t* last_step = hgraph_journal_record_before(journal, last_position);
+	size_t last_step_position = (char*)last_step - journal->records;
+	if (
+		last_step->type != HGRAPH_JOURNAL_STEP
+		|| last_step_position < journal->merge_floor
+	) {
+		return;
+	}
+
+	memcpy(
+		(char*)hgraph_journal_record_new_data(last),
+		hgraph_journal_record_new_data(record),
+		record->new_size
+	);
+	journal->end = journal->step_start;
+	journal->cursor = journal->end;
+	journal->step_start = last_step_position;
+}
+
+HGRAPH_INTERNAL void
+hgraph_journal_begin_step(hgraph_journal_t* journal) {
+	if (journal->depth++ == 0) {
+		journal->step_open = false;
+		journal->overflowed = false;
+	}
+}
+
+HGRAPH_INTERNAL void
+hgraph_journal_end_step(hgraph_journal_t* journal) {
+	HGRAPH_ASSERT(journal->depth > 0);
+	if (--journal->depth == 0) {
+		if (journal->step_open && !journal->overflowed) {
+			hgraph_journal_merge_step(journal);
+		}
+		journal->step_open = false;
+	}
+}
+
+HGRAPH_INTERNAL hgraph_journal_record_t*
+hgraph_journal_write(
+	hgraph_journal_t* journal,
+	hgraph_journal_record_t record,
+	const void* old_data,
+	const void* new_data
+) {
+	if (journal->replaying || journal->overflowed) { return NULL; }
+
+	if (!journal->step_open) {
+		// Discard the redo history
+		if (journal->save_point > journal->cursor) {
+			journal->has_save_point = false;
+		}
+		journal->end = journal->cursor;
+		journal->step_start = journal->end;
+		journal->step_open = true;
+
+		hgraph_journal_record_t step = { .type = HGRAPH_JOURNAL_STEP };
+		if (hgraph_journal_append(journal, step, NULL, NULL) == NULL) {
+			hgraph_journal_reset(journal);
+			journal->overflowed = true;
+			return NULL;
+		}
+	}
+
+	hgraph_journal_record_t* result = hgraph_journal_append(journal, record, old_data, new_data);
+	if (result == NULL) {
+		// The step does not fit.
+		// Since it can only be partially undone, the entire history is dropped.
+		hgraph_journal_reset(journal);
+		journal->overflowed = true;
+	}
+
+	return result;
+}
+
+HGRAPH_PRIVATE void
+hgraph_journal_restore_node(
+	hgraph_t* graph,
+	const hgraph_journal_record_t* record
+) {
+	const hgraph_node_type_info_t* type_info = &graph->registry->node_types[record->node.type];
+	hgraph_index_t node_id = hgraph_create_node_with_id(
+		graph, type_info, record->node.id
+	);
+	HGRAPH_ASSERT(node_id == record->node.id);
+
+	const char* data = hgraph_journal_record_old_data(record);
+	hgraph_set_node_name(
+		graph,
+		node_id,
+		(hgraph_str_t){ .data = data, .length = record->node.name_length }
+	);
+
+	hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+	size_t offset = record->node.name_length;
+	for (hgraph_index_t i = 0; i < type_info->num_attributes; ++i) {
+		const hgraph_var_t* var = &type_info->attributes[i];
+		const hgraph_data_type_info_t* data_type = &graph->registry->data_types[var->type];
+		offset = hgraph_journal_attribute_offset(offset, data_type);
+		memcpy((char*)node + var->offset, data + offset, data_type->size);
+		offset += data_type->size;
+	}
+	hgraph_mark_node_dirty(graph, node);
+	hgraph_digest_update_node(graph, node_id);
+}
+
+HGRAPH_PRIVATE void
+hgraph_journal_apply(
+	hgraph_t* graph,
+	const hgraph_journal_record_t* record,
+	bool forward
+) {
+	switch ((hgraph_journal_record_type_t)record->type) {
+		case HGRAPH_JOURNAL_STEP:
+			break;
+		case HGRAPH_JOURNAL_CREATE_NODE:
+		case HGRAPH_JOURNAL_DESTROY_NODE:
+			if (forward == (record->type == HGRAPH_JOURNAL_CREATE_NODE)) {
+				if (record->type == HGRAPH_JOURNAL_CREATE_NODE) {
+					hgraph_create_node_with_id(
+						graph,
+						&graph->registry->node_types[record->node.type],
+						record->node.id
+					);
+				} else {
+					hgraph_journal_restore_node(graph, record);
+				}
+			} else {
+				hgraph_destroy_node(graph, record->node.id);
+			}
+			break;
+		case HGRAPH_JOURNAL_CONNECT:
+		case HGRAPH_JOURNAL_DISCONNECT:
+			if (forward == (record->type == HGRAPH_JOURNAL_CONNECT)) {
+				hgraph_index_t edge_id = hgraph_connect_with_id(
+					graph,
+					record->edge.from_pin,
+					record->edge.to_pin,
+					record->edge.id
+				);
+				HGRAPH_ASSERT(edge_id == record->edge.id);
+				(void)edge_id;
+			} else {
+				hgraph_disconnect(graph, record->edge.id);
+			}
+			break;
+		case HGRAPH_JOURNAL_SET_NAME:
+			hgraph_set_node_name(
+				graph,
+				record->var.node,
+				forward
+					? (hgraph_str_t){
+						.data = hgraph_journal_record_new_data(record),
+						.length = record->new_size,
+					}
+					: (hgraph_str_t){
+						.data = hgraph_journal_record_old_data(record),
+						.length = record->old_size,
+					}
+			);
+			break;
+		case HGRAPH_JOURNAL_SET_ATTRIBUTE:
+			{
+				const hgraph_node_type_t* type = hgraph_get_node_type(
+					graph, record->var.node
+				);
+				HGRAPH_ASSERT(type != NULL);
+				hgraph_set_node_attribute(
+					graph,
+					record->var.node,
+					type->attributes[record->var.index],
+					forward
+						? hgraph_journal_record_new_data(record)
+						: hgraph_journal_record_old_data(record)
+				);
+			}
+			break;
+	}
+}
+
+size_t
+hgraph_journal_init(
+	hgraph_journal_t* journal,
+	size_t size,
+	const hgraph_journal_config_t* config
+) {
+	mem_layout_t layout = { 0 };
+	mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_journal_t),
+		_Alignof(hgraph_journal_t)
+	);
+	size_t capacity = (size_t)mem_layout_align_ptr(
+		(intptr_t)config->max_size, HGRAPH_JOURNAL_ALIGNMENT
+	);
+	ptrdiff_t records_offset = mem_layout_reserve(
+		&layout,
+		capacity,
+		_Alignof(max_align_t)
+	);
+
+	size_t required_size = mem_layout_size(&layout);
+	if (journal == NULL || size < required_size) { return required_size; }
+
+	*journal = (hgraph_journal_t){
+		.capacity = capacity,
+		.records = mem_layout_locate(journal, records_offset),
+	};
+
+	return required_size;
+}
+
+void
+hgraph_set_journal(hgraph_t* graph, hgraph_journal_t* journal) {
+	if (graph->journal != NULL) {
+		graph->journal->graph = NULL;
+	}
+
+	graph->journal = journal;
+	if (journal != NULL) {
+		if (journal->graph != NULL) {
+			journal->graph->journal = NULL;
+		}
+
+		journal->graph = graph;
+		journal->depth = 0;
+		journal->step_open = false;
+		journal->overflowed = false;
+		journal->replaying = false;
+		hgraph_journal_reset(journal);
+	}
+}
+
+HGRAPH_INTERNAL bool
+hgraph_journal_iterate_unsaved(
+	const hgraph_journal_t* journal,
+	bool (*visit)(const hgraph_journal_record_t* record, bool forward, void* userdata),
+	void* userdata
+) {
+	if (!journal->has_save_point || journal->depth > 0) { return false; }
+
+	if (journal->save_point <= journal->cursor) {
+		for (size_t position = journal->save_point; position < journal->cursor;) {
+			const hgraph_journal_record_t* record = hgraph_journal_record_at(
+				journal, position
+			);
+			if (!visit(record, true, userdata)) { return false; }
+			position += record->size;
+		}
+	} else {
+		// Steps undone since the save are reverted from the newest one
+		for (size_t position = journal->save_point; position > journal->cursor;) {
+			const hgraph_journal_record_t* record = hgraph_journal_record_before(
+				journal, position
+			);
+			if (!visit(record, false, userdata)) { return false; }
+			position -= record->size;
+		}
+	}
+
+	return true;
+}
+
+void
+hgraph_mark_saved(hgraph_t* graph) {
+	hgraph_journal_t* journal = graph->journal;
+	if (journal == NULL) { return; }
+
+	journal->save_point = journal->cursor;
+	journal->has_save_point = true;
+	// The last saved record must not change anymore
+	journal->merge_floor = HGRAPH_MAX(journal->merge_floor, journal->cursor);
+}
+
+bool
+hgraph_can_append_edits(const hgraph_t* graph) {
+	const hgraph_journal_t* journal = graph->journal;
+	return journal != NULL && journal->has_save_point && journal->depth == 0;
+}
+
+void
+hgraph_begin_edit(hgraph_t* graph) {
+	if (graph->journal != NULL) {
+		hgraph_journal_begin_step(graph->journal);
+	}
+}
+
+void
+hgraph_end_edit(hgraph_t* graph) {
+	if (graph->journal != NULL) {
+		hgraph_journal_end_step(graph->journal);
+	}
+}
+
+bool
+hgraph_undo(hgraph_t* graph) {
+	hgraph_journal_t* journal = graph->journal;
+	if (journal == NULL || journal->depth > 0 || journal->cursor == 0) {
+		return false;
+	}
+
+	// Readers see the whole step at once
+	hgraph_write_begin(graph);
+	journal->replaying = true;
+	size_t position = journal->cursor;
+	while (position > 0) {
+		const hgraph_journal_record_t* record = hgraph_journal_record_before(
+			journal, position
+		);
+		position -= record->size;
+
+		if (record->type == HGRAPH_JOURNAL_STEP) { break; }
+		hgraph_journal_apply(graph, record, false);
+	}
+	hgraph_write_end(graph);
+	journal->replaying = false;
+	journal->cursor = position;
+	journal->merge_floor = position;
+
+	return true;
+}
+
+bool
+hgraph_redo(hgraph_t* graph) {
+	hgraph_journal_t* journal = graph->journal;
+	if (journal == NULL || journal->depth > 0 || journal->cursor == journal->end) {
+		return false;
+	}
+
+	hgraph_write_begin(graph);
+	journal->replaying = true;
+	// Skip the step marker
+	size_t position = journal->cursor
+		+ hgraph_journal_record_at(journal, journal->cursor)->size;
+	while (position < journal->end) {
+		const hgraph_journal_record_t* record = hgraph_journal_record_at(
+			journal, position
+		);
+		if (record->type == HGRAPH_JOURNAL_STEP) { break; }
+
+		hgraph_journal_apply(graph, record, true);
+		position += record->size;
+	}
+	hgraph_write_end(graph);
+	journal->replaying = false;
+	journal->cursor = position;
+	journal->merge_floor = position;
+
+	return true;
+}
@@ -0,0 +1,110 @@
+#ifndef HGRAPH_JOURNAL_H
+#define HGRAPH_JOURNAL_H
+
+#include "internal.h"
+#include "mem_layout.h"
+
+typedef enum hgraph_journal_record_type_e {
+	HGRAPH_JOURNAL_STEP,
+	HGRAPH_JOURNAL_CREATE_NODE,
+	HGRAPH_JOURNAL_DESTROY_NODE,
+	HGRAPH_JOURNAL_CONNECT,
+	HGRAPH_JOURNAL_DISCONNECT,
+	HGRAPH_JOURNAL_SET_NAME,
+	HGRAPH_JOURNAL_SET_ATTRIBUTE,
+} hgraph_journal_record_type_t;
+
+// A record is followed by old_size bytes of the state before the operation,
+// new_size bytes of the state after it and finally a copy of its size so the
+// journal can be walked backward.
+// The data is aligned so attribute values can be used in place.
+typedef struct hgraph_journal_record_s {
+	uint32_t size;
+	uint32_t type;
+
+	union {
+		// Create and destroy.
+		// The old state of a destroyed node is its name followed by its
+		// attributes.
+		struct {
+			hgraph_index_t id;
+			hgraph_index_t type;
+			uint32_t name_length;
+		} node;
+
+		// Connect and disconnect.
+		// The node types are kept so the pins can be named even after the
+		// nodes are gone.
+		struct {
+			hgraph_index_t id;
+			hgraph_index_t from_pin;
+			hgraph_index_t to_pin;
+			hgraph_index_t from_type;
+			hgraph_index_t to_type;
+		} edge;
+
+		// Set attribute and set name
+		struct {
+			hgraph_index_t node;
+			hgraph_index_t index;
+			hgraph_index_t type;
+		} var;
+	};
+
+	uint32_t old_size;
+	uint32_t new_size;
+} hgraph_journal_record_t;
+
+HGRAPH_INTERNAL void
+hgraph_journal_begin_step(hgraph_journal_t* journal);
+
+HGRAPH_INTERNAL void
+hgraph_journal_end_step(hgraph_journal_t* journal);
+
+// Passing NULL for either data pointer leaves that section for the caller to
+// fill in through the returned record.
+// NULL is returned when nothing was recorded.
+HGRAPH_INTERNAL hgraph_journal_record_t*
+hgraph_journal_write(
+	hgraph_journal_t* journal,
+	hgraph_journal_record_t record,
+	const void* old_data,
+	const void* new_data
+);
+
+// Visit the records between the save point and the cursor in the order which
+// takes the saved graph to the current one.
+// Returns false when those records are no longer available.
+HGRAPH_INTERNAL bool
+hgraph_journal_iterate_unsaved(
+	const hgraph_journal_t* journal,
+	bool (*visit)(const hgraph_journal_record_t* record, bool forward, void* userdata),
+	void* userdata
+);
+
+#define HGRAPH_JOURNAL_ALIGNMENT _Alignof(max_align_t)
+
+HGRAPH_PRIVATE size_t
+hgraph_journal_data_offset(void) {
+	return (size_t)mem_layout_align_ptr(
+		(intptr_t)sizeof(hgraph_journal_record_t), HGRAPH_JOURNAL_ALIGNMENT
+	);
+}
+
+// The old state of a destroyed node packs its attributes after its name
+HGRAPH_PRIVATE size_t
+hgraph_journal_attribute_offset(size_t offset, const hgraph_data_type_info_t* data_type) {
+	return (size_t)mem_layout_align_ptr((intptr_t)offset, data_type->definition->alignment);
+}
+
+HGRAPH_PRIVATE const char*
+hgraph_journal_record_old_data(const hgraph_journal_record_t* record) {
+	return (const char*)record + hgraph_journal_data_offset();
+}
+
+HGRAPH_PRIVATE const char*
+hgraph_journal_record_new_data(const hgraph_journal_record_t* record) {
+	return hgraph_journal_record_old_data(record) + record->old_size;
+}
+
+#endif
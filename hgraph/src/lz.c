@@ -0,0 +1,258 @@
+#include <hgraph/lz.h>
+#include <hgraph/io.h>
+#include "internal.h"
+
+#define HGRAPH_LZ_MIN_MATCH 4
+#define HGRAPH_LZ_MAX_CODE 15
+
+HGRAPH_PRIVATE uint32_t
+hgraph_lz_read32(const unsigned char* bytes) {
+	uint32_t value;
+	memcpy(&value, bytes, sizeof(value));
+	return value;
+}
+
+HGRAPH_PRIVATE uint32_t
+hgraph_lz_hash(uint32_t value) {
+	return (value * 2654435761u) >> (32 - HGRAPH_LZ_HASH_BITS);
+}
+
+// A match_length of 0 writes the last sequence of a block
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_lz_write_sequence(
+	hgraph_out_t* out,
+	const unsigned char* literals,
+	size_t num_literals,
+	size_t offset,
+	size_t match_length
+) {
+	size_t literal_code = HGRAPH_MIN(num_literals, (size_t)HGRAPH_LZ_MAX_CODE);
+	size_t match_code = match_length > 0
+		? HGRAPH_MIN(match_length - HGRAPH_LZ_MIN_MATCH, (size_t)HGRAPH_LZ_MAX_CODE)
+		: 0;
+	unsigned char token = (unsigned char)((literal_code << 4) | match_code);
+	HGRAPH_CHECK_IO(hgraph_io_write(out, &token, 1));
+
+	if (literal_code == HGRAPH_LZ_MAX_CODE) {
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(num_literals - HGRAPH_LZ_MAX_CODE, out));
+	}
+	if (num_literals > 0) {
+		HGRAPH_CHECK_IO(hgraph_io_write(out, literals, num_literals));
+	}
+	if (match_length == 0) { return HGRAPH_IO_OK; }
+
+	unsigned char offset_bytes[2] = { (unsigned char)offset, (unsigned char)(offset >> 8) };
+	HGRAPH_CHECK_IO(hgraph_io_write(out, offset_bytes, sizeof(offset_bytes)));
+	if (match_code == HGRAPH_LZ_MAX_CODE) {
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(
+			match_length - HGRAPH_LZ_MIN_MATCH - HGRAPH_LZ_MAX_CODE,
+			out
+		));
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+// Greedy parse with a single candidate per hash like LZ4's fast mode
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_lz_compress_block(hgraph_lz_out_t* lz, size_t size) {
+	hgraph_out_t* out = lz->inner;
+	const unsigned char* block = (const unsigned char*)lz->buffer;
+	HGRAPH_CHECK_IO(hgraph_io_write_uint(size, out));
+
+	memset(lz->table, 0, sizeof(lz->table));
+	size_t anchor = 0;
+	size_t pos = 0;
+	while (pos + HGRAPH_LZ_MIN_MATCH <= size) {
+		uint32_t sequence = hgraph_lz_read32(block + pos);
+		uint32_t hash = hgraph_lz_hash(sequence);
+		size_t candidate = lz->table[hash];
+		lz->table[hash] = (uint16_t)pos;
+
+		if (candidate >= pos || hgraph_lz_read32(block + candidate) != sequence) {
+			++pos;
+			continue;
+		}
+
+		size_t length = HGRAPH_LZ_MIN_MATCH;
+		while (pos + length < size && block[candidate + length] == block[pos + length]) {
+			++length;
+		}
+
+		HGRAPH_CHECK_IO(hgraph_lz_write_sequence(
+			out, block + anchor, pos - anchor, pos - candidate, length
+		));
+		pos += length;
+		anchor = pos;
+	}
+
+	return hgraph_lz_write_sequence(out, block + anchor, size - anchor, 0, 0);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_lz_flush_block(hgraph_lz_out_t* lz) {
+	size_t size = (size_t)(lz->out.pos - lz->buffer);
+	if (size == 0) { return HGRAPH_IO_OK; }
+
+	lz->out.pos = lz->buffer;
+	return hgraph_lz_compress_block(lz, size);
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_lz_read_length(size_t code, size_t* length, hgraph_in_t* in) {
+	*length = code;
+	if (code < HGRAPH_LZ_MAX_CODE) { return HGRAPH_IO_OK; }
+
+	uint64_t extra;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&extra, in));
+	if (extra > HGRAPH_LZ_MAX_BLOCK_SIZE) { return HGRAPH_IO_MALFORMED; }
+
+	*length += (size_t)extra;
+	return HGRAPH_IO_OK;
+}
+
+HGRAPH_PRIVATE hgraph_io_status_t
+hgraph_lz_decompress_block(hgraph_lz_in_t* lz, size_t* size_out) {
+	hgraph_in_t* in = lz->inner;
+
+	uint64_t size;
+	HGRAPH_CHECK_IO(hgraph_io_read_uint(&size, in));
+	if (size > lz->buffer_size) { return HGRAPH_IO_MALFORMED; }
+
+	unsigned char* block = (unsigned char*)lz->buffer;
+	size_t produced = 0;
+	while (size > 0) {
+		unsigned char token;
+		HGRAPH_CHECK_IO(hgraph_io_read(in, &token, 1));
+
+		size_t num_literals;
+		HGRAPH_CHECK_IO(hgraph_lz_read_length(token >> 4, &num_literals, in));
+		if (num_literals > size - produced) { return HGRAPH_IO_MALFORMED; }
+		if (num_literals > 0) {
+			HGRAPH_CHECK_IO(hgraph_io_read(in, block + produced, num_literals));
+			produced += num_literals;
+		}
+		// Only the last sequence ends without a match
+		if (produced == size) { break; }
+
+		unsigned char offset_bytes[2];
+		HGRAPH_CHECK_IO(hgraph_io_read(in, offset_bytes, sizeof(offset_bytes)));
+		size_t offset = (size_t)offset_bytes[0] | ((size_t)offset_bytes[1] << 8);
+		if (offset == 0 || offset > produced) { return HGRAPH_IO_MALFORMED; }
+
+		size_t length;
+		HGRAPH_CHECK_IO(hgraph_lz_read_length(token & HGRAPH_LZ_MAX_CODE, &length, in));
+		length += HGRAPH_LZ_MIN_MATCH;
+		if (length > size - produced) { return HGRAPH_IO_MALFORMED; }
+
+		const unsigned char* src = block + produced - offset;
+		if (offset >= length) {
+			memcpy(block + produced, src, length);
+		} else {
+			// Overlapping matches repeat the last offset bytes
+			for (size_t i = 0; i < length; ++i) {
+				block[produced + i] = src[i];
+			}
+		}
+		produced += length;
+	}
+
+	*size_out = (size_t)size;
+	return HGRAPH_IO_OK;
+}
+
+// Only reached when the block buffer is full
+HGRAPH_PRIVATE size_t
+hgraph_lz_write(hgraph_out_t* out, const void* buffer, size_t size) {
+	hgraph_lz_out_t* lz = HGRAPH_CONTAINER_OF(out, hgraph_lz_out_t, out);
+	const char* src = buffer;
+
+	size_t total = 0;
+	while (total < size) {
+		size_t space = hgraph_io_space(out);
+		if (space == 0) {
+			if (hgraph_lz_flush_block(lz) != HGRAPH_IO_OK) { break; }
+			continue;
+		}
+
+		size_t copy_size = HGRAPH_MIN(space, size - total);
+		memcpy(out->pos, src + total, copy_size);
+		out->pos += copy_size;
+		total += copy_size;
+	}
+
+	return total;
+}
+
+// Only reached when the current block is used up
+HGRAPH_PRIVATE size_t
+hgraph_lz_read(hgraph_in_t* in, void* buffer, size_t size) {
+	hgraph_lz_in_t* lz = HGRAPH_CONTAINER_OF(in, hgraph_lz_in_t, in);
+	char* dst = buffer;
+
+	size_t total = HGRAPH_MIN(hgraph_io_available(in), size);
+	if (total > 0) {
+		memcpy(dst, in->pos, total);
+		in->pos += total;
+	}
+
+	while (total < size && !lz->finished) {
+		size_t block_size;
+		if (hgraph_lz_decompress_block(lz, &block_size) != HGRAPH_IO_OK || block_size == 0) {
+			lz->finished = true;
+			break;
+		}
+
+		size_t copy_size = HGRAPH_MIN(block_size, size - total);
+		memcpy(dst + total, lz->buffer, copy_size);
+		total += copy_size;
+		in->pos = lz->buffer + copy_size;
+		in->end = lz->buffer + block_size;
+	}
+
+	return total;
+}
+
+hgraph_out_t*
+hgraph_lz_out_init(
+	hgraph_lz_out_t* lz,
+	hgraph_out_t* inner,
+	void* buffer,
+	size_t buffer_size
+) {
+	buffer_size = HGRAPH_MIN(buffer_size, (size_t)HGRAPH_LZ_MAX_BLOCK_SIZE);
+	lz->out = (hgraph_out_t){
+		.write = hgraph_lz_write,
+		.pos = buffer,
+		.end = (char*)buffer + buffer_size,
+	};
+	lz->inner = inner;
+	lz->buffer = buffer;
+	lz->buffer_size = buffer_size;
+	return &lz->out;
+}
+
+hgraph_io_status_t
+hgraph_lz_finish(hgraph_lz_out_t* lz) {
+	HGRAPH_CHECK_IO(hgraph_lz_flush_block(lz));
+	return hgraph_io_write_uint(0, lz->inner);
+}
+
+hgraph_in_t*
+hgraph_lz_in_init(
+	hgraph_lz_in_t* lz,
+	hgraph_in_t* inner,
+	void* buffer,
+	size_t buffer_size
+) {
+	lz->in = (hgraph_in_t){
+		.read = hgraph_lz_read,
+		.pos = buffer,
+		.end = buffer,
+	};
+	lz->inner = inner;
+	lz->buffer = buffer;
+	lz->buffer_size = buffer_size;
+	lz->finished = false;
+	return &lz->in;
+}
@@ -14,11 +14,17 @@ hgraph_alloc_var_plans(
 HGRAPH_PRIVATE hgraph_var_migration_plan_t*
 hgraph_create_var_plans(
 	hgraph_var_migration_plan_t** pool,
-	const hgraph_data_type_info_t* from_data_types,
-	const hgraph_data_type_info_t* to_data_types,
-	const hgraph_var_t* from_vars, hgraph_index_t num_from_vars,
-	const hgraph_var_t* to_vars, hgraph_index_t num_to_vars
+	const hgraph_registry_t* from_registry,
+	const hgraph_registry_t* to_registry,
+	const hgraph_node_type_info_t* from_type_info,
+	const hgraph_node_type_info_t* to_type_info,
+	hgraph_name_kind_t kind
 ) {
+	hgraph_index_t num_from_vars;
+	const hgraph_var_t* from_vars = hgraph_registry_get_vars(from_type_info, kind, &num_from_vars);
+	hgraph_index_t num_to_vars;
+	const hgraph_var_t* to_vars = hgraph_registry_get_vars(to_type_info, kind, &num_to_vars);
+
 	hgraph_var_migration_plan_t* plans = hgraph_alloc_var_plans(
 		pool, num_from_vars
 	);
@@ -26,22 +32,19 @@ hgraph_create_var_plans(
 	for (hgraph_index_t i = 0; i < num_from_vars; ++i) {
 		const hgraph_var_t* from_var = &from_vars[i];
 
-		hgraph_index_t new_index = HGRAPH_INVALID_INDEX;
-		for (hgraph_index_t j = 0; j < num_to_vars; ++j) {
-			const hgraph_var_t* to_var = &to_vars[j];
-
-			if (hgraph_str_equal(from_var->name, to_var->name)) {
-				const hgraph_data_type_info_t* from_type = &from_data_types[from_var->type];
-				const hgraph_data_type_info_t* to_type = &to_data_types[to_var->type];
-
-				if (
-					hgraph_str_equal(from_type->name, to_type->name)
-					&& (from_type->size == to_type->size)
-				) {
-					new_index = j;
-				}
-
-				break;
+		hgraph_index_t new_index = hgraph_registry_find_var(
+			to_registry, to_type_info, kind, from_var->name
+		);
+		if (HGRAPH_IS_VALID_INDEX(new_index)) {
+			const hgraph_var_t* to_var = &to_vars[new_index];
+			const hgraph_data_type_info_t* from_type = &from_registry->data_types[from_var->type];
+			const hgraph_data_type_info_t* to_type = &to_registry->data_types[to_var->type];
+
+			if (
+				!hgraph_str_equal(from_type->name, to_type->name)
+				|| (from_type->size != to_type->size)
+			) {
+				new_index = HGRAPH_INVALID_INDEX;
 			}
 		}
 
@@ -98,35 +101,28 @@ hgraph_migration_init(
 		const hgraph_node_type_info_t* from_type_info = &from_registry->node_types[i];
 
 		// Find the new type, default to dummy
-		const hgraph_node_type_info_t* to_type_info = &to_registry->node_types[0];
-		for (hgraph_index_t j = 1; j < to_registry->num_node_types; ++j) {
-			const hgraph_node_type_info_t* itr = &to_registry->node_types[i];
-
-			if (hgraph_str_equal(from_type_info->name, itr->name)) {
-				to_type_info = itr;
-				break;
-			}
-		}
+		const hgraph_node_type_info_t* to_type_info = hgraph_registry_find_node_type(
+			to_registry, from_type_info->name
+		);
+		if (to_type_info == NULL) { to_type_info = &to_registry->node_types[0]; }
 
-		const hgraph_data_type_info_t* from_data_types = from_registry->data_types;
-		const hgraph_data_type_info_t* to_data_types = to_registry->data_types;
 		hgraph_var_migration_plan_t* attribute_plans = hgraph_create_var_plans(
 			&var_plans,
-			from_data_types, to_data_types,
-			from_type_info->attributes, from_type_info->num_attributes,
-			to_type_info->attributes, to_type_info->num_attributes
+			from_registry, to_registry,
+			from_type_info, to_type_info,
+			HGRAPH_NAME_ATTRIBUTE
 		);
 		hgraph_var_migration_plan_t* input_plans = hgraph_create_var_plans(
 			&var_plans,
-			from_data_types, to_data_types,
-			from_type_info->input_pins, from_type_info->num_input_pins,
-			to_type_info->input_pins, to_type_info->num_input_pins
+			from_registry, to_registry,
+			from_type_info, to_type_info,
+			HGRAPH_NAME_INPUT_PIN
 		);
 		hgraph_var_migration_plan_t* output_plans = hgraph_create_var_plans(
 			&var_plans,
-			from_data_types, to_data_types,
-			from_type_info->output_pins, from_type_info->num_output_pins,
-			to_type_info->output_pins, to_type_info->num_output_pins
+			from_registry, to_registry,
+			from_type_info, to_type_info,
+			HGRAPH_NAME_OUTPUT_PIN
 		);
 
 		migration->node_plans[i - 1] = (hgraph_node_migration_plan_t){
@@ -146,6 +142,8 @@ hgraph_migration_execute(
 	const hgraph_t* from_graph,
 	hgraph_t* to_graph
 ) {
+	hgraph_write_begin(to_graph);
+
 	// Migrate nodes
 	for (hgraph_index_t i = 0; i < from_graph->node_slot_map.num_items; ++i) {
 		const hgraph_node_t* from_node = hgraph_get_node_by_slot(from_graph, i);
@@ -162,7 +160,7 @@ hgraph_migration_execute(
 		// Remap the id so that the new graph nodes have the same id as their
 		// counterpart
 		if (to_node_id != from_node_id) {
-			hgraph_slot_map_swap_id(&to_graph->node_slot_map, to_node_id, from_node_id);
+			hgraph_swap_id(to_graph, &to_graph->node_slot_map, to_node_id, from_node_id);
 			to_node_id = from_node_id;
 		}
 
@@ -189,11 +187,13 @@ hgraph_migration_execute(
 			const hgraph_data_type_info_t* to_type = &to_graph->registry->data_types[to_var->type];
 			memcpy(to_storage, from_storage, to_type->size);
 		}
+		hgraph_mark_node_dirty(to_graph, to_node);
+		hgraph_digest_update_node(to_graph, to_node_id);
 	}
 
 	// Migrate edges
 	for (hgraph_index_t i = 0; i < from_graph->edge_slot_map.num_items; ++i) {
-		const hgraph_edge_t* from_edge = &from_graph->edges[i];
+		const hgraph_edge_t* from_edge = &hgraph_edges(from_graph)[i];
 		hgraph_index_t from_edge_id = hgraph_slot_map_id_for_slot(&from_graph->edge_slot_map, i);
 
 		bool is_output;
@@ -231,7 +231,7 @@ hgraph_migration_execute(
 		hgraph_index_t new_edge_id = hgraph_connect(to_graph, new_from_pin, new_to_pin);
 		HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(new_edge_id));
 		if (new_edge_id != from_edge_id) {
-			hgraph_slot_map_swap_id(&to_graph->edge_slot_map, new_edge_id, from_edge_id);
+			hgraph_swap_id(to_graph, &to_graph->edge_slot_map, new_edge_id, from_edge_id);
 		}
 	}
 
@@ -249,4 +249,6 @@ hgraph_migration_execute(
 			++i;
 		}
 	}
+
+	hgraph_write_end(to_graph);
 }
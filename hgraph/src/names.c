@@ -0,0 +1,245 @@
+#include "internal.h"
+#include "graph.h"
+#include "hash.h"
+#include "mem_layout.h"
+
+#define HGRAPH_NAME_TOMBSTONE (HGRAPH_INVALID_INDEX - 1)
+
+HGRAPH_PRIVATE hgraph_name_t*
+hgraph_name_entry(const hgraph_t* graph, hgraph_index_t name) {
+	return (hgraph_name_t*)(hgraph_name_storage(graph) + name);
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_name_hash(hgraph_str_t name) {
+	return hash_murmur64(hash_fnv1a(name.data, name.length));
+}
+
+HGRAPH_PRIVATE bool
+hgraph_name_equal(const hgraph_t* graph, hgraph_index_t name, hgraph_str_t str) {
+	hgraph_name_t* entry = hgraph_name_entry(graph, name);
+	return entry->length == str.length
+		&& memcmp(entry + 1, str.data, str.length) == 0;
+}
+
+// Return the table slot of the name or the first slot where it can be inserted
+HGRAPH_PRIVATE hgraph_index_t
+hgraph_name_probe(const hgraph_t* graph, hgraph_str_t str, bool* found) {
+	const hgraph_index_t* table = hgraph_name_table(graph);
+	uint64_t hash = hgraph_name_hash(str);
+	hgraph_index_t exp = graph->name_table_exp;
+	hgraph_index_t i = (hgraph_index_t)hash;
+	hgraph_index_t insert_slot = HGRAPH_INVALID_INDEX;
+	while (true) {
+		i = hash_msi(hash, exp, i);
+		hgraph_index_t name = table[i];
+		if (name == HGRAPH_INVALID_INDEX) {
+			*found = false;
+			return HGRAPH_IS_VALID_INDEX(insert_slot) ? insert_slot : i;
+		} else if (name == HGRAPH_NAME_TOMBSTONE) {
+			if (!HGRAPH_IS_VALID_INDEX(insert_slot)) { insert_slot = i; }
+		} else if (hgraph_name_equal(graph, name, str)) {
+			*found = true;
+			return i;
+		}
+	}
+}
+
+HGRAPH_PRIVATE void
+hgraph_name_rebuild_table(hgraph_t* graph) {
+	hgraph_index_t* table = hgraph_name_table(graph);
+	hgraph_index_t table_size = hash_size(graph->name_table_exp);
+	for (hgraph_index_t i = 0; i < table_size; ++i) {
+		table[i] = HGRAPH_INVALID_INDEX;
+	}
+	graph->name_table_load = 0;
+
+	for (
+		hgraph_index_t name = 0;
+		name < graph->name_storage_end;
+		name += hgraph_name_entry_size(hgraph_name_entry(graph, name)->length)
+	) {
+		hgraph_name_t* entry = hgraph_name_entry(graph, name);
+		if (entry->ref_count == 0) { continue; }
+
+		bool found;
+		hgraph_str_t str = { .data = (const char*)(entry + 1), .length = entry->length };
+		table[hgraph_name_probe(graph, str, &found)] = name;
+		++graph->name_table_load;
+	}
+
+	hgraph_mark_dirty(graph, table, sizeof(hgraph_index_t) * table_size);
+}
+
+// Slide live names down over dead ones
+HGRAPH_PRIVATE void
+hgraph_name_compact(hgraph_t* graph) {
+	hgraph_index_t end = 0;
+	for (
+		hgraph_index_t name = 0;
+		name < graph->name_storage_end;
+		name += hgraph_name_entry_size(hgraph_name_entry(graph, name)->length)
+	) {
+		hgraph_name_t* entry = hgraph_name_entry(graph, name);
+		if (entry->ref_count == 0) { continue; }
+
+		entry->relocation = end;
+		end += hgraph_name_entry_size(entry->length);
+	}
+
+	for (hgraph_index_t i = 0; i < graph->node_slot_map.num_items; ++i) {
+		hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
+		if (!HGRAPH_IS_VALID_INDEX(node->name)) { continue; }
+
+		node->name = hgraph_name_entry(graph, node->name)->relocation;
+		hgraph_mark_dirty(graph, &node->name, sizeof(node->name));
+	}
+
+	char* storage = hgraph_name_storage(graph);
+	hgraph_index_t name = 0;
+	while (name < graph->name_storage_end) {
+		hgraph_name_t* entry = hgraph_name_entry(graph, name);
+		hgraph_index_t entry_size = hgraph_name_entry_size(entry->length);
+		if (entry->ref_count > 0) {
+			memmove(storage + entry->relocation, entry, entry_size);
+		}
+		name += entry_size;
+	}
+	graph->name_storage_end = end;
+	hgraph_mark_dirty(graph, storage, end);
+
+	hgraph_name_rebuild_table(graph);
+}
+
+// Make room for a name at the end of the storage
+HGRAPH_PRIVATE bool
+hgraph_name_ensure_space(hgraph_t* graph, hgraph_index_t length) {
+	hgraph_index_t entry_size = hgraph_name_entry_size(length);
+	if (graph->name_storage_end + entry_size <= graph->name_storage_size) { return true; }
+
+	hgraph_name_compact(graph);
+	return graph->name_storage_end + entry_size <= graph->name_storage_size;
+}
+
+HGRAPH_INTERNAL ptrdiff_t
+hgraph_name_table_reserve(mem_layout_t* layout, hgraph_index_t max_nodes) {
+	// Leave room for the name being set while the old one is still alive
+	hgraph_index_t size = hash_size(hash_exp(max_nodes * 2));
+	return mem_layout_reserve(
+		layout,
+		sizeof(hgraph_index_t) * size,
+		_Alignof(hgraph_index_t)
+	);
+}
+
+HGRAPH_INTERNAL void
+hgraph_name_init(hgraph_t* graph, hgraph_index_t max_nodes) {
+	graph->name_storage_end = 0;
+	graph->name_table_exp = hash_exp(max_nodes * 2);
+	graph->name_table_load = 0;
+
+	hgraph_index_t* table = hgraph_name_table(graph);
+	hgraph_index_t table_size = hash_size(graph->name_table_exp);
+	for (hgraph_index_t i = 0; i < table_size; ++i) {
+		table[i] = HGRAPH_INVALID_INDEX;
+	}
+}
+
+HGRAPH_INTERNAL char*
+hgraph_name_reserve(hgraph_t* graph, hgraph_index_t length) {
+	if (!hgraph_name_ensure_space(graph, length)) { return NULL; }
+
+	hgraph_name_t* entry = hgraph_name_entry(graph, graph->name_storage_end);
+	return (char*)(entry + 1);
+}
+
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_name_find(const hgraph_t* graph, hgraph_str_t str) {
+	if (str.length == 0) { return HGRAPH_INVALID_INDEX; }
+
+	bool found;
+	hgraph_index_t slot = hgraph_name_probe(graph, str, &found);
+	return found ? hgraph_name_table(graph)[slot] : HGRAPH_INVALID_INDEX;
+}
+
+HGRAPH_INTERNAL hgraph_index_t
+hgraph_name_intern(hgraph_t* graph, hgraph_str_t str) {
+	HGRAPH_ASSERT(str.length > 0);
+
+	bool found;
+	hgraph_index_t slot = hgraph_name_probe(graph, str, &found);
+	if (found) {
+		hgraph_index_t name = hgraph_name_table(graph)[slot];
+		hgraph_name_t* entry = hgraph_name_entry(graph, name);
+		++entry->ref_count;
+		hgraph_mark_dirty(graph, &entry->ref_count, sizeof(entry->ref_count));
+		return name;
+	}
+
+	// Compacting would move a string which is already in the storage
+	char* storage = hgraph_name_storage(graph);
+	hgraph_index_t entry_size = hgraph_name_entry_size(str.length);
+	bool in_storage = storage <= str.data && str.data < storage + graph->name_storage_size;
+	if (graph->name_storage_end + entry_size > graph->name_storage_size) {
+		if (in_storage) { return HGRAPH_INVALID_INDEX; }
+		if (!hgraph_name_ensure_space(graph, str.length)) {
+			return HGRAPH_INVALID_INDEX;
+		}
+	}
+
+	// Leave room for an empty slot so probing always terminates
+	hgraph_index_t table_size = hash_size(graph->name_table_exp);
+	if ((graph->name_table_load + 1) * 4 > table_size * 3) {
+		hgraph_name_rebuild_table(graph);
+	}
+	slot = hgraph_name_probe(graph, str, &found);
+
+	hgraph_index_t name = graph->name_storage_end;
+	hgraph_name_t* entry = hgraph_name_entry(graph, name);
+	// The string may have been read directly into the reserved space
+	memmove(entry + 1, str.data, str.length);
+	((char*)(entry + 1))[str.length] = '\0';
+	entry->ref_count = 1;
+	entry->length = str.length;
+	entry->relocation = HGRAPH_INVALID_INDEX;
+	graph->name_storage_end += entry_size;
+	hgraph_mark_dirty(graph, entry, entry_size);
+
+	hgraph_index_t* table = hgraph_name_table(graph);
+	if (table[slot] == HGRAPH_INVALID_INDEX) { ++graph->name_table_load; }
+	table[slot] = name;
+	hgraph_mark_dirty(graph, &table[slot], sizeof(hgraph_index_t));
+
+	return name;
+}
+
+HGRAPH_INTERNAL void
+hgraph_name_release(hgraph_t* graph, hgraph_index_t name) {
+	if (!HGRAPH_IS_VALID_INDEX(name)) { return; }
+
+	hgraph_name_t* entry = hgraph_name_entry(graph, name);
+	HGRAPH_ASSERT(entry->ref_count > 0);
+	hgraph_mark_dirty(graph, &entry->ref_count, sizeof(entry->ref_count));
+	if (--entry->ref_count > 0) { return; }
+
+	bool found;
+	hgraph_str_t str = { .data = (const char*)(entry + 1), .length = entry->length };
+	hgraph_index_t slot = hgraph_name_probe(graph, str, &found);
+	HGRAPH_ASSERT(found);
+	hgraph_index_t* table = hgraph_name_table(graph);
+	table[slot] = HGRAPH_NAME_TOMBSTONE;
+	hgraph_mark_dirty(graph, &table[slot], sizeof(hgraph_index_t));
+}
+
+HGRAPH_INTERNAL hgraph_str_t
+hgraph_name_get(const hgraph_t* graph, hgraph_index_t name) {
+	if (!HGRAPH_IS_VALID_INDEX(name)) {
+		return (hgraph_str_t){ .data = "", .length = 0 };
+	}
+
+	hgraph_name_t* entry = hgraph_name_entry(graph, name);
+	return (hgraph_str_t){
+		.data = (const char*)(entry + 1),
+		.length = entry->length,
+	};
+}
@@ -0,0 +1,334 @@
+#include "internal.h"
+#include "graph.h"
+
+// The topological order is maintained with the algorithm from
+// "A Dynamic Topological Sort Algorithm for Directed Acyclic Graphs"
+// (Pearce & Kelly).
+// Adding an edge which goes against the current order only reorders the nodes
+// whose position is between its two ends.
+
+#define HGRAPH_ORDER_FORWARD 1
+#define HGRAPH_ORDER_BACKWARD 2
+
+typedef struct {
+	hgraph_t* graph;
+	const hgraph_index_t* node_orders;
+	uint8_t* marks;
+	hgraph_index_t* stack;
+	hgraph_index_t stack_size;
+	hgraph_index_t num_visited;
+	hgraph_index_t lower_bound;
+	hgraph_index_t upper_bound;
+	hgraph_index_t target;
+	uint8_t mark;
+} hgraph_order_search_t;
+
+HGRAPH_PRIVATE void
+hgraph_order_set(hgraph_t* graph, hgraph_index_t node_id, hgraph_index_t position) {
+	hgraph_index_t* node_orders = hgraph_node_orders(graph);
+	hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+
+	node_orders[node_id] = position;
+	ordered_nodes[position] = node_id;
+	hgraph_mark_dirty(graph, &node_orders[node_id], sizeof(hgraph_index_t));
+	hgraph_mark_dirty(graph, &ordered_nodes[position], sizeof(hgraph_index_t));
+}
+
+// Return false when the target is reached
+HGRAPH_PRIVATE bool
+hgraph_order_visit(hgraph_order_search_t* search, hgraph_index_t node_id) {
+	if (node_id == search->target) { return false; }
+	if (search->marks[node_id] != 0) { return true; }
+
+	hgraph_index_t order = search->node_orders[node_id];
+	if (order < search->lower_bound || order > search->upper_bound) { return true; }
+
+	search->marks[node_id] = search->mark;
+	search->stack[search->stack_size++] = node_id;
+	++search->num_visited;
+	return true;
+}
+
+HGRAPH_PRIVATE bool
+hgraph_order_search(hgraph_order_search_t* search, hgraph_index_t start) {
+	hgraph_t* graph = search->graph;
+
+	search->stack_size = 0;
+	search->num_visited = 0;
+	hgraph_order_visit(search, start);
+
+	while (search->stack_size > 0) {
+		hgraph_index_t node_id = search->stack[--search->stack_size];
+		hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+		const hgraph_node_type_info_t* type_info = hgraph_get_node_type_internal(
+			graph, node
+		);
+
+		if (search->mark == HGRAPH_ORDER_FORWARD) {
+			for (hgraph_index_t i = 0; i < type_info->num_output_pins; ++i) {
+				hgraph_edge_link_t* output_pin = (hgraph_edge_link_t*)((char*)node + type_info->output_pins[i].offset);
+
+				hgraph_index_t itr = output_pin->next;
+				while (true) {
+					hgraph_edge_link_t* link = hgraph_resolve_edge(graph, output_pin, itr);
+					if (link == output_pin) { break; }
+
+					hgraph_edge_t* edge = HGRAPH_CONTAINER_OF(link, hgraph_edge_t, output_pin_link);
+					hgraph_index_t to_node_id, to_pin_index;
+					bool is_output;
+					hgraph_decode_pin_id(edge->to_pin, &to_node_id, &to_pin_index, &is_output);
+					if (!hgraph_order_visit(search, to_node_id)) { return false; }
+
+					itr = link->next;
+				}
+			}
+		} else {
+			for (hgraph_index_t i = 0; i < type_info->num_input_pins; ++i) {
+				hgraph_index_t* input_pin = (hgraph_index_t*)((char*)node + type_info->input_pins[i].offset);
+				hgraph_index_t edge_slot = hgraph_slot_map_slot_for_id(
+					&graph->edge_slot_map, *input_pin
+				);
+				if (!HGRAPH_IS_VALID_INDEX(edge_slot)) { continue; }
+
+				hgraph_edge_t* edge = &hgraph_edges(graph)[edge_slot];
+				hgraph_index_t from_node_id, from_pin_index;
+				bool is_output;
+				hgraph_decode_pin_id(edge->from_pin, &from_node_id, &from_pin_index, &is_output);
+				if (!hgraph_order_visit(search, from_node_id)) { return false; }
+			}
+		}
+	}
+
+	return true;
+}
+
+HGRAPH_PRIVATE void
+hgraph_order_clear_marks(
+	hgraph_t* graph,
+	hgraph_index_t lower_bound,
+	hgraph_index_t upper_bound
+) {
+	const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	uint8_t* marks = hgraph_order_marks(graph);
+	for (hgraph_index_t i = lower_bound; i <= upper_bound; ++i) {
+		hgraph_index_t node_id = ordered_nodes[i];
+		if (HGRAPH_IS_VALID_INDEX(node_id)) { marks[node_id] = 0; }
+	}
+}
+
+// Returns true if to_node_id can reach from_node_id.
+// The nodes that can be reached are left marked.
+HGRAPH_PRIVATE bool
+hgraph_order_search_cycle(
+	hgraph_t* graph,
+	hgraph_index_t from_node_id,
+	hgraph_index_t to_node_id
+) {
+	const hgraph_index_t* node_orders = hgraph_node_orders(graph);
+	hgraph_order_search_t search = {
+		.graph = graph,
+		.node_orders = node_orders,
+		.marks = hgraph_order_marks(graph),
+		.stack = hgraph_order_stack(graph),
+		.lower_bound = node_orders[to_node_id],
+		.upper_bound = node_orders[from_node_id],
+		.target = from_node_id,
+		.mark = HGRAPH_ORDER_FORWARD,
+	};
+	return !hgraph_order_search(&search, to_node_id);
+}
+
+HGRAPH_INTERNAL void
+hgraph_order_add_node(hgraph_t* graph, hgraph_index_t node_id) {
+	hgraph_index_t max_nodes = graph->node_slot_map.max_items;
+	if (graph->order_end == max_nodes) {
+		// Close the gaps left by destroyed nodes
+		const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+		hgraph_index_t order_end = 0;
+		for (hgraph_index_t i = 0; i < graph->order_end; ++i) {
+			hgraph_index_t id = ordered_nodes[i];
+			if (HGRAPH_IS_VALID_INDEX(id)) {
+				hgraph_order_set(graph, id, order_end++);
+			}
+		}
+		graph->order_end = order_end;
+	}
+
+	hgraph_order_set(graph, node_id, graph->order_end++);
+}
+
+HGRAPH_INTERNAL void
+hgraph_order_remove_node(hgraph_t* graph, hgraph_index_t node_id) {
+	hgraph_index_t* node_orders = hgraph_node_orders(graph);
+	hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	hgraph_index_t position = node_orders[node_id];
+
+	ordered_nodes[position] = HGRAPH_INVALID_INDEX;
+	node_orders[node_id] = HGRAPH_INVALID_INDEX;
+	hgraph_mark_dirty(graph, &node_orders[node_id], sizeof(hgraph_index_t));
+	hgraph_mark_dirty(graph, &ordered_nodes[position], sizeof(hgraph_index_t));
+}
+
+HGRAPH_INTERNAL void
+hgraph_order_move_node(
+	hgraph_t* graph,
+	hgraph_index_t old_node_id,
+	hgraph_index_t new_node_id
+) {
+	hgraph_index_t* node_orders = hgraph_node_orders(graph);
+	hgraph_index_t position = node_orders[old_node_id];
+
+	node_orders[old_node_id] = HGRAPH_INVALID_INDEX;
+	hgraph_mark_dirty(graph, &node_orders[old_node_id], sizeof(hgraph_index_t));
+	hgraph_order_set(graph, new_node_id, position);
+}
+
+HGRAPH_INTERNAL bool
+hgraph_order_can_add_edge(
+	hgraph_t* graph,
+	hgraph_index_t from_node_id,
+	hgraph_index_t to_node_id
+) {
+	const hgraph_index_t* node_orders = hgraph_node_orders(graph);
+	hgraph_index_t lower_bound = node_orders[to_node_id];
+	hgraph_index_t upper_bound = node_orders[from_node_id];
+	if (lower_bound > upper_bound) { return true; }
+
+	bool has_cycle = hgraph_order_search_cycle(graph, from_node_id, to_node_id);
+	hgraph_order_clear_marks(graph, lower_bound, upper_bound);
+	return !has_cycle;
+}
+
+HGRAPH_INTERNAL bool
+hgraph_order_add_edge(
+	hgraph_t* graph,
+	hgraph_index_t from_node_id,
+	hgraph_index_t to_node_id
+) {
+	const hgraph_index_t* node_orders = hgraph_node_orders(graph);
+	hgraph_index_t lower_bound = node_orders[to_node_id];
+	hgraph_index_t upper_bound = node_orders[from_node_id];
+	if (lower_bound > upper_bound) { return true; }
+
+	// Find the nodes after to_node which must be moved after from_node
+	if (hgraph_order_search_cycle(graph, from_node_id, to_node_id)) {
+		hgraph_order_clear_marks(graph, lower_bound, upper_bound);
+		return false;
+	}
+
+	// Find the nodes before from_node which must be moved before to_node
+	hgraph_order_search_t search = {
+		.graph = graph,
+		.node_orders = node_orders,
+		.marks = hgraph_order_marks(graph),
+		.stack = hgraph_order_stack(graph),
+		.lower_bound = lower_bound,
+		.upper_bound = upper_bound,
+		.target = HGRAPH_INVALID_INDEX,
+		.mark = HGRAPH_ORDER_BACKWARD,
+	};
+	hgraph_order_search(&search, from_node_id);
+	hgraph_index_t num_backward = search.num_visited;
+
+	// Reuse the positions of all affected nodes, in the same relative order,
+	// but with the backward set placed first
+	const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	uint8_t* marks = hgraph_order_marks(graph);
+	hgraph_index_t* affected_nodes = hgraph_order_affected_nodes(graph);
+	hgraph_index_t* affected_positions = hgraph_order_affected_positions(graph);
+	hgraph_index_t num_affected = 0;
+	hgraph_index_t backward_index = 0;
+	hgraph_index_t forward_index = num_backward;
+	for (hgraph_index_t i = lower_bound; i <= upper_bound; ++i) {
+		hgraph_index_t node_id = ordered_nodes[i];
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { continue; }
+
+		switch (marks[node_id]) {
+			case HGRAPH_ORDER_FORWARD:
+				affected_nodes[forward_index++] = node_id;
+				break;
+			case HGRAPH_ORDER_BACKWARD:
+				affected_nodes[backward_index++] = node_id;
+				break;
+			default:
+				continue;
+		}
+
+		marks[node_id] = 0;
+		affected_positions[num_affected++] = i;
+	}
+
+	for (hgraph_index_t i = 0; i < num_affected; ++i) {
+		hgraph_order_set(graph, affected_nodes[i], affected_positions[i]);
+	}
+
+	return true;
+}
+
+HGRAPH_PRIVATE void
+hgraph_order_swap_memory(char* lhs, char* rhs, size_t size) {
+	char tmp[256];
+	while (size > 0) {
+		size_t chunk_size = HGRAPH_MIN(size, sizeof(tmp));
+		memcpy(tmp, lhs, chunk_size);
+		memcpy(lhs, rhs, chunk_size);
+		memcpy(rhs, tmp, chunk_size);
+		lhs += chunk_size;
+		rhs += chunk_size;
+		size -= chunk_size;
+	}
+}
+
+// Node ids do not change so this is not recorded in the journal.
+// Slots are only cached by pipelines which are invalidated by the version.
+hgraph_index_t
+hgraph_defragment(hgraph_t* graph) {
+	const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	hgraph_slot_map_t* slot_map = &graph->node_slot_map;
+	size_t node_size = graph->node_size;
+	hgraph_index_t num_moved = 0;
+	hgraph_index_t target_slot = 0;
+
+	hgraph_write_begin(graph);
+	for (hgraph_index_t i = 0; i < graph->order_end; ++i) {
+		hgraph_index_t node_id = ordered_nodes[i];
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { continue; }
+
+		hgraph_index_t slot = hgraph_slot_map_slot_for_id(slot_map, node_id);
+		if (slot != target_slot) {
+			hgraph_node_t* node = hgraph_get_node_by_slot(graph, slot);
+			hgraph_node_t* target_node = hgraph_get_node_by_slot(graph, target_slot);
+			hgraph_order_swap_memory((char*)node, (char*)target_node, node_size);
+			hgraph_slot_map_swap_slots(slot_map, slot, target_slot);
+
+			hgraph_mark_node_dirty(graph, node);
+			hgraph_mark_node_dirty(graph, target_node);
+			hgraph_mark_slot_dirty(graph, slot_map, slot);
+			hgraph_mark_slot_dirty(graph, slot_map, target_slot);
+			++num_moved;
+		}
+
+		++target_slot;
+	}
+	if (num_moved > 0) { ++graph->version; }
+	hgraph_write_end(graph);
+
+	return num_moved;
+}
+
+void
+hgraph_iterate_nodes_topological(
+	const hgraph_t* graph,
+	hgraph_node_iterator_t iterator,
+	void* userdata
+) {
+	const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	for (hgraph_index_t i = 0; i < graph->order_end; ++i) {
+		hgraph_index_t node_id = ordered_nodes[i];
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { continue; }
+
+		const hgraph_node_t* node = hgraph_find_node_by_id(graph, node_id);
+		const hgraph_node_type_t* type = graph->registry->node_types[node->type].definition;
+		if (!iterator(node_id, type, userdata)) { break; }
+	}
+}
@@ -95,6 +95,9 @@ hgraph_pipeline_node_report_status(const hgraph_node_api_t* api, const void* sta
 	hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[ctx->slot];
 	node_meta->status = status;
 
+	// Only the subgraph node is visible to the watcher
+	if (HGRAPH_IS_VALID_INDEX(node_meta->owner)) { return true; }
+
 	if (!ctx->watcher(
 		&(hgraph_pipeline_event_t){
 			.type = HGRAPH_PIPELINE_EV_UPDATE_STATUS,
@@ -109,6 +112,132 @@ hgraph_pipeline_node_report_status(const hgraph_node_api_t* api, const void* sta
 	return true;
 }
 
+// Nodes inside a subgraph instance are stored in the subgraph
+HGRAPH_PRIVATE const hgraph_node_t*
+hgraph_pipeline_get_node(const hgraph_pipeline_t* pipeline, hgraph_index_t slot) {
+	const hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
+	if (!HGRAPH_IS_VALID_INDEX(node_meta->owner)) {
+		return hgraph_get_node_by_slot(pipeline->graph, slot);
+	}
+
+	const hgraph_pipeline_node_meta_t* owner_meta = &pipeline->node_metas[node_meta->owner];
+	return hgraph_get_node_by_slot(
+		owner_meta->plan->subgraph->graph,
+		slot - owner_meta->first_inner
+	);
+}
+
+HGRAPH_PRIVATE const hgraph_pipeline_source_t*
+hgraph_pipeline_get_source(
+	const hgraph_pipeline_t* pipeline,
+	hgraph_index_t slot,
+	hgraph_index_t pin_index
+) {
+	const hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
+	const hgraph_pipeline_node_meta_t* owner_meta = &pipeline->node_metas[node_meta->owner];
+	const hgraph_pipeline_plan_t* plan = owner_meta->plan;
+	hgraph_index_t plan_node = slot - owner_meta->first_inner;
+	return &plan->input_sources[plan->input_source_offsets[plan_node] + pin_index];
+}
+
+HGRAPH_PRIVATE const void*
+hgraph_pipeline_resolve_input(
+	const hgraph_pipeline_t* pipeline,
+	hgraph_index_t slot,
+	hgraph_index_t pin_index
+) {
+	const hgraph_t* graph = pipeline->graph;
+	const hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
+	const hgraph_node_type_info_t* node_types = graph->registry->node_types;
+
+	if (HGRAPH_IS_VALID_INDEX(node_meta->owner)) {
+		const hgraph_pipeline_source_t* source = hgraph_pipeline_get_source(
+			pipeline, slot, pin_index
+		);
+		if (HGRAPH_IS_VALID_INDEX(source->node)) {
+			const hgraph_pipeline_node_meta_t* owner_meta = &pipeline->node_metas[node_meta->owner];
+			const hgraph_pipeline_node_meta_t* from_node_meta =
+				&pipeline->node_metas[owner_meta->first_inner + source->node];
+			const hgraph_node_type_info_t* from_node_type = &node_types[from_node_meta->type];
+			return from_node_meta->data + from_node_type->output_buffers[source->pin].offset;
+		} else if (HGRAPH_IS_VALID_INDEX(source->pin)) {
+			return hgraph_pipeline_resolve_input(pipeline, node_meta->owner, source->pin);
+		} else {
+			return NULL;
+		}
+	}
+
+	const hgraph_node_type_info_t* node_type = &node_types[node_meta->type];
+	const hgraph_node_t* node = hgraph_get_node_by_slot(graph, slot);
+	const hgraph_var_t* var = &node_type->input_pins[pin_index];
+
+	hgraph_index_t edge_id = *((hgraph_index_t*)((char*)node + var->offset));
+	hgraph_index_t edge_slot = hgraph_slot_map_slot_for_id(
+		&graph->edge_slot_map, edge_id
+	);
+	if (!HGRAPH_IS_VALID_INDEX(edge_slot)) {  // No connection
+		return NULL;
+	}
+	const hgraph_edge_t* edge = &hgraph_edges(graph)[edge_slot];
+
+	hgraph_index_t from_node_id, from_pin_index;
+	bool is_output;
+	hgraph_decode_pin_id(edge->from_pin, &from_node_id, &from_pin_index, &is_output);
+	HGRAPH_ASSERT(is_output);
+
+	hgraph_index_t from_node_slot = hgraph_slot_map_slot_for_id(
+		&graph->node_slot_map, from_node_id
+	);
+	HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(from_node_slot));
+
+	const hgraph_pipeline_node_meta_t* from_node_meta = &pipeline->node_metas[from_node_slot];
+	const hgraph_node_type_info_t* from_node_type = &node_types[from_node_meta->type];
+	return from_node_meta->data + from_node_type->output_buffers[from_pin_index].offset;
+}
+
+HGRAPH_PRIVATE void
+hgraph_pipeline_send_output(
+	hgraph_pipeline_t* pipeline,
+	hgraph_index_t slot,
+	hgraph_index_t pin_index,
+	const void* value
+) {
+	const hgraph_t* graph = pipeline->graph;
+	hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
+	const hgraph_node_type_info_t* node_type = &graph->registry->node_types[node_meta->type];
+	const hgraph_pin_description_t* pin_def = node_type->definition->output_pins[pin_index];
+
+	// Copy value to output buffer
+	char* output_addr = node_meta->data + node_type->output_buffers[pin_index].offset;
+	memcpy(output_addr, value, pin_def->data_type->size);
+	hgraph_bitset_set(&pipeline->sent_outputs[slot], pin_index);
+
+	// Nodes inside a subgraph instance check their sources instead
+	if (HGRAPH_IS_VALID_INDEX(node_meta->owner)) { return; }
+
+	// Notify all nodes that depends on this
+	const hgraph_node_t* node = hgraph_get_node_by_slot(graph, slot);
+	const hgraph_var_t* var = &node_type->output_pins[pin_index];
+	hgraph_edge_link_t* output_pin = (hgraph_edge_link_t*)((char*)node + var->offset);
+	hgraph_index_t itr = output_pin->next;
+	while (true) {
+		const hgraph_edge_link_t* link = hgraph_resolve_edge(graph, output_pin, itr);
+		if (link == output_pin) { break; }
+
+		const hgraph_edge_t* edge = HGRAPH_CONTAINER_OF(link, hgraph_edge_t, output_pin_link);
+		hgraph_index_t to_node_id, to_pin_index;
+		bool is_output;
+		hgraph_decode_pin_id(edge->to_pin, &to_node_id, &to_pin_index, &is_output);
+		hgraph_index_t to_node_slot = hgraph_slot_map_slot_for_id(
+			&graph->node_slot_map, to_node_id
+		);
+		HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(to_node_slot));
+		hgraph_bitset_set(&pipeline->received_inputs[to_node_slot], to_pin_index);
+
+		itr = link->next;
+	}
+}
+
 HGRAPH_PRIVATE const void*
 hgraph_pipeline_node_input(
 	const hgraph_node_api_t* api,
@@ -119,7 +248,7 @@ hgraph_pipeline_node_input(
 	const hgraph_t* graph = pipeline->graph;
 	hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[ctx->slot];
 	const hgraph_node_type_info_t* node_type = &graph->registry->node_types[node_meta->type];
-	const hgraph_node_t* node = hgraph_get_node_by_slot(graph, ctx->slot);
+	const hgraph_node_t* node = hgraph_pipeline_get_node(pipeline, ctx->slot);
 
 	for (hgraph_index_t i = 0; i < node_type->num_attributes; ++i) {
 		const hgraph_attribute_description_t* attribute = node_type->definition->attributes[i];
@@ -132,30 +261,7 @@ hgraph_pipeline_node_input(
 	for (hgraph_index_t i = 0; i < node_type->num_input_pins; ++i) {
 		const hgraph_pin_description_t* pin = node_type->definition->input_pins[i];
 		if (pin == pinOrAttribute) {
-			const hgraph_var_t* var = &node_type->input_pins[i];
-
-			hgraph_index_t edge_id = *((hgraph_index_t*)((char*)node + var->offset));
-			hgraph_index_t edge_slot = hgraph_slot_map_slot_for_id(
-				&graph->edge_slot_map, edge_id
-			);
-			if (!HGRAPH_IS_VALID_INDEX(edge_slot)) {  // No connection
-				return NULL;
-			}
-			const hgraph_edge_t* edge = &graph->edges[edge_slot];
-
-			hgraph_index_t from_node_id, from_pin_index;
-			bool is_output;
-			hgraph_decode_pin_id(edge->from_pin, &from_node_id, &from_pin_index, &is_output);
-			HGRAPH_ASSERT(is_output);
-
-			hgraph_index_t from_node_slot = hgraph_slot_map_slot_for_id(
-				&graph->node_slot_map, from_node_id
-			);
-			HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(from_node_slot));
-
-			const hgraph_pipeline_node_meta_t* from_node_meta = &pipeline->node_metas[from_node_slot];
-			const hgraph_node_type_info_t* from_node_type = &graph->registry->node_types[from_node_meta->type];
-			return from_node_meta->data + from_node_type->output_buffers[from_pin_index].offset;
+			return hgraph_pipeline_resolve_input(pipeline, ctx->slot, i);
 		}
 	}
 
@@ -173,38 +279,10 @@ hgraph_pipeline_node_output(
 	const hgraph_t* graph = pipeline->graph;
 	hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[ctx->slot];
 	const hgraph_node_type_info_t* node_type = &graph->registry->node_types[node_meta->type];
-	const hgraph_node_t* node = hgraph_get_node_by_slot(graph, ctx->slot);
 
 	for (hgraph_index_t i = 0; i < node_type->num_output_pins; ++i) {
-		const hgraph_pin_description_t* pin_def = node_type->definition->output_pins[i];
-		if (pin == pin_def) {
-			// Copy value to output buffer
-			char* output_addr = node_meta->data + node_type->output_buffers[i].offset;
-			memcpy(output_addr, value, pin_def->data_type->size);
-			hgraph_bitset_set(&node_meta->sent_outputs, i);
-
-			// Notify all nodes that depends on this
-			const hgraph_var_t* var = &node_type->output_pins[i];
-			hgraph_edge_link_t* output_pin = (hgraph_edge_link_t*)((char*)node + var->offset);
-			hgraph_index_t itr = output_pin->next;
-			while (true) {
-				const hgraph_edge_link_t* link = hgraph_resolve_edge(graph, output_pin, itr);
-				if (link == output_pin) { break; }
-
-				const hgraph_edge_t* edge = HGRAPH_CONTAINER_OF(link, hgraph_edge_t, output_pin_link);
-				hgraph_index_t to_node_id, to_pin_index;
-				bool is_output;
-				hgraph_decode_pin_id(edge->to_pin, &to_node_id, &to_pin_index, &is_output);
-				hgraph_index_t to_node_slot = hgraph_slot_map_slot_for_id(
-					&graph->node_slot_map, to_node_id
-				);
-				HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(to_node_slot));
-				hgraph_pipeline_node_meta_t* to_node_meta = &pipeline->node_metas[to_node_slot];
-				hgraph_bitset_set(&to_node_meta->received_inputs, to_pin_index);
-
-				itr = link->next;
-			}
-
+		if (pin == node_type->definition->output_pins[i]) {
+			hgraph_pipeline_send_output(pipeline, ctx->slot, i, value);
 			break;
 		}
 	}
@@ -237,25 +315,286 @@ static const hgraph_node_api_t hgraph_pipeline_node_api_no_io = {
 };
 
 HGRAPH_PRIVATE bool
-hgraph_pipeline_schedule_node(
-	hgraph_pipeline_t* pipeline, hgraph_index_t node_slot
+hgraph_pipeline_is_node_ready(
+	hgraph_pipeline_t* pipeline,
+	hgraph_index_t slot
 ) {
-	hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[node_slot];
-	if (node_meta->state != HGRAPH_NODE_STATE_WAITING) { return false; }
+	const hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
+	const hgraph_node_type_info_t* node_type = &pipeline->graph->registry->node_types[node_meta->type];
 
-	pipeline->ready_nodes[pipeline->num_ready_nodes++] = node_slot;
-	node_meta->state = HGRAPH_NODE_STATE_SCHEDULED;
-	return true;
+	// Nodes inside a subgraph instance pull from their sources
+	if (HGRAPH_IS_VALID_INDEX(node_meta->owner)) {
+		const hgraph_pipeline_node_meta_t* owner_meta = &pipeline->node_metas[node_meta->owner];
+		for (hgraph_index_t i = 0; i < node_type->num_input_pins; ++i) {
+			const hgraph_pipeline_source_t* source = hgraph_pipeline_get_source(
+				pipeline, slot, i
+			);
+
+			bool received;
+			if (HGRAPH_IS_VALID_INDEX(source->node)) {
+				hgraph_index_t from_slot = owner_meta->first_inner + source->node;
+				received = hgraph_bitset_is_set(pipeline->sent_outputs[from_slot], source->pin);
+			} else if (HGRAPH_IS_VALID_INDEX(source->pin)) {
+				received = hgraph_bitset_is_set(pipeline->received_inputs[node_meta->owner], source->pin);
+			} else {
+				received = false;
+			}
+
+			if (received) { hgraph_bitset_set(&pipeline->received_inputs[slot], i); }
+		}
+	}
+
+	return hgraph_bitset_is_all_set(pipeline->received_inputs[slot], node_type->required_inputs);
 }
 
-HGRAPH_PRIVATE bool
-hgraph_pipeline_is_node_ready(
+HGRAPH_PRIVATE hgraph_pipeline_execution_status_t
+hgraph_pipeline_execute_instance(
 	hgraph_pipeline_t* pipeline,
-	hgraph_index_t slot
+	hgraph_index_t slot,
+	hgraph_pipeline_watcher_t watcher,
+	void* userdata
+);
+
+HGRAPH_PRIVATE hgraph_pipeline_execution_status_t
+hgraph_pipeline_run_node(
+	hgraph_pipeline_t* pipeline,
+	hgraph_index_t slot,
+	hgraph_pipeline_watcher_t watcher,
+	void* userdata
+) {
+	hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
+	const hgraph_node_type_info_t* node_type = &pipeline->graph->registry->node_types[node_meta->type];
+
+	hgraph_pipeline_execution_status_t status;
+	if (node_meta->plan != NULL) {
+		status = hgraph_pipeline_execute_instance(pipeline, slot, watcher, userdata);
+	} else {
+		hgraph_pipeline_node_ctx_t ctx = {
+			.impl = hgraph_pipeline_node_api,
+			.pipeline = pipeline,
+			.watcher = watcher,
+			.watcher_data = userdata,
+			.slot = slot,
+		};
+		if (node_type->definition->execute != NULL) {
+			node_type->definition->execute(&ctx.impl);
+		}
+		pipeline->step_alloc_ptr = pipeline->scratch_zone_start;
+		status = ctx.termination_reason;
+	}
+
+	if (status != HGRAPH_PIPELINE_EXEC_FINISHED) {
+		return status;
+	}
+	if (!hgraph_bitset_is_all_set(pipeline->sent_outputs[slot], node_type->required_outputs)) {
+		return HGRAPH_PIPELINE_EXEC_INCOMPLETE_OUTPUT;
+	}
+
+	return HGRAPH_PIPELINE_EXEC_FINISHED;
+}
+
+HGRAPH_PRIVATE hgraph_pipeline_execution_status_t
+hgraph_pipeline_execute_instance(
+	hgraph_pipeline_t* pipeline,
+	hgraph_index_t slot,
+	hgraph_pipeline_watcher_t watcher,
+	void* userdata
 ) {
 	const hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
+	const hgraph_node_type_info_t* node_types = pipeline->graph->registry->node_types;
+	const hgraph_node_type_info_t* node_type = &node_types[node_meta->type];
+	const hgraph_pipeline_plan_t* plan = node_meta->plan;
+
+	for (hgraph_index_t i = 0; i < plan->num_nodes; ++i) {
+		hgraph_index_t inner_slot = node_meta->first_inner + plan->order[i];
+		if (!hgraph_pipeline_is_node_ready(pipeline, inner_slot)) { continue; }
+
+		hgraph_pipeline_execution_status_t status = hgraph_pipeline_run_node(
+			pipeline, inner_slot, watcher, userdata
+		);
+		if (status != HGRAPH_PIPELINE_EXEC_FINISHED) { return status; }
+	}
+
+	// Forward the bound outputs
+	for (hgraph_index_t i = 0; i < node_type->num_output_pins; ++i) {
+		const hgraph_pipeline_source_t* source = &plan->output_sources[i];
+		if (!HGRAPH_IS_VALID_INDEX(source->node)) { continue; }
+
+		hgraph_index_t from_slot = node_meta->first_inner + source->node;
+		if (!hgraph_bitset_is_set(pipeline->sent_outputs[from_slot], source->pin)) { continue; }
+
+		const hgraph_pipeline_node_meta_t* from_node_meta = &pipeline->node_metas[from_slot];
+
+		const hgraph_node_type_info_t* from_node_type = &node_types[from_node_meta->type];
+		hgraph_pipeline_send_output(
+			pipeline,
+			slot,
+			i,
+			from_node_meta->data + from_node_type->output_buffers[source->pin].offset
+		);
+	}
+
+	return HGRAPH_PIPELINE_EXEC_FINISHED;
+}
+
+HGRAPH_PRIVATE hgraph_index_t
+hgraph_pipeline_count_instances(const hgraph_t* graph, hgraph_index_t type) {
+	const hgraph_node_link_t* links = hgraph_type_links(graph);
+	hgraph_index_t num_instances = 0;
+	for (
+		hgraph_index_t node_id = hgraph_type_heads(graph)[type];
+		HGRAPH_IS_VALID_INDEX(node_id);
+		node_id = links[node_id].next
+	) {
+		++num_instances;
+	}
+	return num_instances;
+}
+
+HGRAPH_PRIVATE hgraph_index_t
+hgraph_pipeline_get_owner_id(
+	const hgraph_pipeline_t* pipeline,
+	const hgraph_pipeline_node_meta_t* node_meta
+) {
+	return HGRAPH_IS_VALID_INDEX(node_meta->owner)
+		? pipeline->node_metas[node_meta->owner].id
+		: HGRAPH_INVALID_INDEX;
+}
+
+HGRAPH_PRIVATE void
+hgraph_pipeline_compile_plan(
+	hgraph_pipeline_plan_t* plan,
+	const hgraph_node_type_info_t* node_type,
+	hgraph_index_t** index_pool,
+	hgraph_pipeline_source_t** source_pool
+) {
+	const hgraph_subgraph_t* subgraph = node_type->definition->subgraph;
+	const hgraph_t* graph = subgraph->graph;
+	hgraph_index_t num_nodes = graph->node_slot_map.num_items;
+
+	*plan = (hgraph_pipeline_plan_t){
+		.subgraph = subgraph,
+		.num_nodes = num_nodes,
+		.order = *index_pool,
+		.input_source_offsets = *index_pool + num_nodes,
+		.input_sources = *source_pool,
+	};
+	*index_pool += num_nodes * 2;
+
+	const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	hgraph_index_t num_ordered_nodes = 0;
+	for (hgraph_index_t i = 0; i < graph->order_end; ++i) {
+		hgraph_index_t node_id = ordered_nodes[i];
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { continue; }
+
+		plan->order[num_ordered_nodes++] = hgraph_slot_map_slot_for_id(
+			&graph->node_slot_map, node_id
+		);
+	}
+	HGRAPH_ASSERT(num_ordered_nodes == num_nodes);
+
+	// Resolve where every input of every node comes from
+	hgraph_index_t num_sources = 0;
+	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
+		const hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
+		const hgraph_node_type_info_t* inner_type = hgraph_get_node_type_internal(graph, node);
+
+		plan->input_source_offsets[i] = num_sources;
+		for (hgraph_index_t j = 0; j < inner_type->num_input_pins; ++j) {
+			hgraph_pipeline_source_t* source = &plan->input_sources[num_sources++];
+			*source = (hgraph_pipeline_source_t){
+				.node = HGRAPH_INVALID_INDEX,
+				.pin = HGRAPH_INVALID_INDEX,
+			};
+
+			hgraph_index_t edge_id = *(hgraph_index_t*)((char*)node + inner_type->input_pins[j].offset);
+			hgraph_index_t edge_slot = hgraph_slot_map_slot_for_id(&graph->edge_slot_map, edge_id);
+			if (HGRAPH_IS_VALID_INDEX(edge_slot)) {
+				const hgraph_edge_t* edge = &hgraph_edges(graph)[edge_slot];
+				hgraph_index_t from_node_id, from_pin_index;
+				bool is_output;
+				hgraph_decode_pin_id(edge->from_pin, &from_node_id, &from_pin_index, &is_output);
+				source->node = hgraph_slot_map_slot_for_id(&graph->node_slot_map, from_node_id);
+				source->pin = from_pin_index;
+				continue;
+			}
+
+			for (hgraph_index_t k = 0; k < node_type->num_input_pins; ++k) {
+				hgraph_index_t bound_node_id, bound_pin_index;
+				bool is_output;
+				hgraph_decode_pin_id(subgraph->input_pins[k], &bound_node_id, &bound_pin_index, &is_output);
+				if (
+					!is_output
+					&& bound_pin_index == j
+					&& hgraph_slot_map_slot_for_id(&graph->node_slot_map, bound_node_id) == i
+				) {
+					source->pin = k;
+					break;
+				}
+			}
+		}
+	}
+	*source_pool += num_sources;
+
+	plan->output_sources = *source_pool;
+	for (hgraph_index_t i = 0; i < node_type->num_output_pins; ++i) {
+		hgraph_index_t bound_node_id, bound_pin_index;
+		bool is_output;
+		hgraph_decode_pin_id(subgraph->output_pins[i], &bound_node_id, &bound_pin_index, &is_output);
+		HGRAPH_ASSERT(is_output);
+		plan->output_sources[i] = (hgraph_pipeline_source_t){
+			.node = hgraph_slot_map_slot_for_id(&graph->node_slot_map, bound_node_id),
+			.pin = bound_pin_index,
+		};
+	}
+	*source_pool += node_type->num_output_pins;
+}
+
+HGRAPH_PRIVATE void
+hgraph_pipeline_init_node(
+	hgraph_pipeline_t* pipeline,
+	hgraph_index_t slot,
+	char** node_data_pool,
+	const hgraph_pipeline_t* previous_pipeline
+) {
+	hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[slot];
 	const hgraph_node_type_info_t* node_type = &pipeline->graph->registry->node_types[node_meta->type];
-	return hgraph_bitset_is_all_set(node_meta->received_inputs, node_type->required_inputs);
+
+	node_meta->data = *node_data_pool;
+	*node_data_pool = (char*)mem_layout_align_ptr(
+		(intptr_t)(*node_data_pool + node_type->pipeline_data_size),
+		_Alignof(max_align_t)
+	);
+
+	if (node_type->definition->init != NULL) {
+		node_type->definition->init(node_meta->data);
+	} else {
+		memset(node_meta->data, 0, node_type->definition->size);
+	}
+
+	if (
+		node_type->definition->transfer != NULL
+		&& previous_pipeline != NULL
+	) {
+		HGRAPH_ASSERT(previous_pipeline != pipeline);
+		hgraph_index_t owner_id = hgraph_pipeline_get_owner_id(pipeline, node_meta);
+		for (hgraph_index_t j = 0; j < previous_pipeline->num_metas; ++j) {
+			hgraph_pipeline_node_meta_t* previous_node_meta =
+				&previous_pipeline->node_metas[j];
+
+			if (
+				previous_node_meta->id == node_meta->id
+				&& previous_node_meta->version == node_meta->version
+				&& hgraph_pipeline_get_owner_id(previous_pipeline, previous_node_meta) == owner_id
+			) {
+				node_type->definition->transfer(
+					node_meta->data,
+					previous_node_meta->data
+				);
+				break;
+			}
+		}
+	}
 }
 
 size_t
@@ -272,18 +611,72 @@ hgraph_pipeline_init(
 	);
 
 	const hgraph_t* graph = config->graph;
+	const hgraph_registry_t* registry = graph->registry;
 	hgraph_index_t num_nodes = graph->node_slot_map.num_items;
 
-	ptrdiff_t ready_nodes_offset = mem_layout_reserve(
+	// Every subgraph type in use needs a plan and every use needs its own
+	// copy of the nodes inside
+	hgraph_index_t num_metas = num_nodes;
+	hgraph_index_t num_plan_indices = 0;
+	hgraph_index_t num_plan_sources = 0;
+	bool has_nested_subgraph = false;
+	for (hgraph_index_t i = 0; i < registry->num_node_types; ++i) {
+		const hgraph_node_type_info_t* node_type = &registry->node_types[i];
+		const hgraph_subgraph_t* subgraph = node_type->definition->subgraph;
+		if (subgraph == NULL) { continue; }
+
+		hgraph_index_t num_instances = hgraph_pipeline_count_instances(graph, i);
+		if (num_instances == 0) { continue; }
+
+		const hgraph_t* inner_graph = subgraph->graph;
+		HGRAPH_ASSERT(inner_graph->registry == registry);
+		hgraph_index_t num_inner_nodes = inner_graph->node_slot_map.num_items;
+		num_metas += num_instances * num_inner_nodes;
+		num_plan_indices += num_inner_nodes * 2;
+		num_plan_sources += node_type->num_output_pins;
+		for (hgraph_index_t j = 0; j < num_inner_nodes; ++j) {
+			const hgraph_node_t* node = hgraph_get_node_by_slot(inner_graph, j);
+			const hgraph_node_type_info_t* inner_type = hgraph_get_node_type_internal(inner_graph, node);
+			num_plan_sources += inner_type->num_input_pins;
+			has_nested_subgraph |= inner_type->definition->subgraph != NULL;
+		}
+	}
+
+	ptrdiff_t order_offset = mem_layout_reserve(
 		&layout,
 		sizeof(hgraph_index_t) * num_nodes,
 		_Alignof(hgraph_index_t)
 	);
 	ptrdiff_t node_metas_offset = mem_layout_reserve(
 		&layout,
-		sizeof(hgraph_pipeline_node_meta_t) * num_nodes,
+		sizeof(hgraph_pipeline_node_meta_t) * num_metas,
 		_Alignof(hgraph_pipeline_node_meta_t)
 	);
+	ptrdiff_t received_inputs_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_bitset_t) * num_metas,
+		_Alignof(hgraph_bitset_t)
+	);
+	ptrdiff_t sent_outputs_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_bitset_t) * num_metas,
+		_Alignof(hgraph_bitset_t)
+	);
+	ptrdiff_t plans_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_pipeline_plan_t) * registry->num_node_types,
+		_Alignof(hgraph_pipeline_plan_t)
+	);
+	ptrdiff_t plan_indices_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_index_t) * num_plan_indices,
+		_Alignof(hgraph_index_t)
+	);
+	ptrdiff_t plan_sources_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_pipeline_source_t) * num_plan_sources,
+		_Alignof(hgraph_pipeline_source_t)
+	);
 	ptrdiff_t scratch_offset = mem_layout_reserve(
 		&layout,
 		config->max_scratch_memory,
@@ -305,6 +698,23 @@ hgraph_pipeline_init(
 			_Alignof(max_align_t)
 		);
 	}
+	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
+		const hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
+		const hgraph_subgraph_t* subgraph = hgraph_get_node_type_internal(
+			graph, node
+		)->definition->subgraph;
+		if (subgraph == NULL) { continue; }
+
+		const hgraph_t* inner_graph = subgraph->graph;
+		for (hgraph_index_t j = 0; j < inner_graph->node_slot_map.num_items; ++j) {
+			const hgraph_node_t* inner_node = hgraph_get_node_by_slot(inner_graph, j);
+			mem_layout_reserve(
+				&layout,
+				hgraph_get_node_type_internal(inner_graph, inner_node)->pipeline_data_size,
+				_Alignof(max_align_t)
+			);
+		}
+	}
 
 	size_t required_size = mem_layout_size(&layout);
 	if (pipeline == NULL || size < required_size) { return required_size; }
@@ -313,68 +723,91 @@ hgraph_pipeline_init(
 		.graph = graph,
 		.version = graph->version,
 		.num_nodes = num_nodes,
-		.ready_nodes = mem_layout_locate(pipeline, ready_nodes_offset),
+		.order = mem_layout_locate(pipeline, order_offset),
+		.num_metas = num_metas,
 		.node_metas = mem_layout_locate(pipeline, node_metas_offset),
+		.received_inputs = mem_layout_locate(pipeline, received_inputs_offset),
+		.sent_outputs = mem_layout_locate(pipeline, sent_outputs_offset),
+		.plans = mem_layout_locate(pipeline, plans_offset),
+		.has_nested_subgraph = has_nested_subgraph,
 		.scratch_zone_start = mem_layout_locate(pipeline, scratch_offset),
 	};
 	pipeline->scratch_zone_end = pipeline->scratch_zone_start + config->max_scratch_memory;
 
+	// The graph already maintains a topological order
+	const hgraph_index_t* ordered_nodes = hgraph_ordered_nodes(graph);
+	hgraph_index_t num_ordered_nodes = 0;
+	for (hgraph_index_t i = 0; i < graph->order_end; ++i) {
+		hgraph_index_t node_id = ordered_nodes[i];
+		if (!HGRAPH_IS_VALID_INDEX(node_id)) { continue; }
+
+		pipeline->order[num_ordered_nodes++] = hgraph_slot_map_slot_for_id(
+			&graph->node_slot_map, node_id
+		);
+	}
+	HGRAPH_ASSERT(num_ordered_nodes == num_nodes);
+
+	// Compile each subgraph once
+	hgraph_index_t* plan_indices = mem_layout_locate(pipeline, plan_indices_offset);
+	hgraph_pipeline_source_t* plan_sources = mem_layout_locate(pipeline, plan_sources_offset);
+	for (hgraph_index_t i = 0; i < registry->num_node_types; ++i) {
+		const hgraph_node_type_info_t* node_type = &registry->node_types[i];
+		pipeline->plans[i] = (hgraph_pipeline_plan_t){ 0 };
+		if (
+			node_type->definition->subgraph == NULL
+			|| hgraph_pipeline_count_instances(graph, i) == 0
+		) {
+			continue;
+		}
+
+		hgraph_pipeline_compile_plan(&pipeline->plans[i], node_type, &plan_indices, &plan_sources);
+	}
+
 	char* node_data_pool = mem_layout_locate(pipeline, node_data_offset);
 	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
-		hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[i];
 		const hgraph_node_t* node = hgraph_get_node_by_slot(graph, i);
-		const hgraph_node_type_info_t* node_type = hgraph_get_node_type_internal(
-			graph, node
-		);
-
 		hgraph_index_t node_id = hgraph_slot_map_id_for_slot(&graph->node_slot_map, i);
-		*node_meta = (hgraph_pipeline_node_meta_t){
+		pipeline->node_metas[i] = (hgraph_pipeline_node_meta_t){
 			.id = node_id,
 			.type = node->type,
-			.version = graph->node_versions[node_id],
+			.version = hgraph_node_versions(graph)[node_id],
+			.owner = HGRAPH_INVALID_INDEX,
 		};
+		hgraph_pipeline_init_node(pipeline, i, &node_data_pool, config->previous_pipeline);
+	}
 
-		node_meta->data = node_data_pool;
-		node_data_pool += node_type->pipeline_data_size;
-		node_data_pool = (char*)mem_layout_align_ptr(
-			(intptr_t)node_data_pool, _Alignof(max_align_t)
-		);
-
-		if (node_type->definition->init != NULL) {
-			node_type->definition->init(node_meta->data);
-		} else {
-			memset(node_meta->data, 0, node_type->definition->size);
-		}
-
-		if (
-			node_type->definition->transfer != NULL
-			&& config->previous_pipeline != NULL
-		) {
-			HGRAPH_ASSERT(config->previous_pipeline != pipeline);
-			for (hgraph_index_t j = 0; j < config->previous_pipeline->num_nodes; ++j) {
-				hgraph_pipeline_node_meta_t* previous_node_meta =
-					&config->previous_pipeline->node_metas[j];
-
-				if (
-					previous_node_meta->id == node_meta->id
-					&& previous_node_meta->version == node_meta->version
-				) {
-					node_type->definition->transfer(
-						node_meta->data,
-						previous_node_meta->data
-					);
-					break;
-				}
-			}
+	// Instance the subgraphs
+	hgraph_index_t num_inner_metas = num_nodes;
+	for (hgraph_index_t i = 0; i < num_nodes; ++i) {
+		hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[i];
+		const hgraph_pipeline_plan_t* plan = &pipeline->plans[node_meta->type];
+		if (plan->subgraph == NULL) { continue; }
+
+		node_meta->plan = plan;
+		node_meta->first_inner = num_inner_metas;
+
+		const hgraph_t* inner_graph = plan->subgraph->graph;
+		for (hgraph_index_t j = 0; j < plan->num_nodes; ++j) {
+			const hgraph_node_t* inner_node = hgraph_get_node_by_slot(inner_graph, j);
+			hgraph_index_t inner_node_id = hgraph_slot_map_id_for_slot(&inner_graph->node_slot_map, j);
+			hgraph_index_t inner_slot = num_inner_metas++;
+			pipeline->node_metas[inner_slot] = (hgraph_pipeline_node_meta_t){
+				.id = inner_node_id,
+				.type = inner_node->type,
+				.version = hgraph_node_versions(inner_graph)[inner_node_id],
+				.owner = i,
+			};
+			hgraph_pipeline_init_node(pipeline, inner_slot, &node_data_pool, config->previous_pipeline);
 		}
 	}
+	HGRAPH_ASSERT(num_inner_metas == num_metas);
 
 	return required_size;
 }
 
 void
 hgraph_pipeline_cleanup(hgraph_pipeline_t* pipeline) {
-	for (hgraph_index_t i = 0; i < pipeline->num_nodes; ++i) {
+	for (hgraph_index_t i = 0; i < pipeline->num_metas; ++i) {
 		hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[i];
 		const hgraph_node_type_info_t* node_type = &pipeline->graph->registry->node_types[node_meta->type];
 
@@ -398,6 +831,10 @@ hgraph_pipeline_execute(
 		return HGRAPH_PIPELINE_EXEC_OUT_OF_SYNC;
 	}
 
+	if (pipeline->has_nested_subgraph) {
+		return HGRAPH_PIPELINE_EXEC_NESTED_SUBGRAPH;
+	}
+
 	if (watcher == NULL) { watcher = hgraph_pipeline_default_watcher; }
 
 	if (!watcher(
@@ -411,16 +848,15 @@ hgraph_pipeline_execute(
 
 	pipeline->step_alloc_ptr = pipeline->scratch_zone_start;
 	pipeline->execution_alloc_ptr = pipeline->scratch_zone_end;
-	pipeline->num_ready_nodes = 0;
 
 	// Init nodes
+	memset(pipeline->received_inputs, 0, sizeof(hgraph_bitset_t) * pipeline->num_metas);
+	memset(pipeline->sent_outputs, 0, sizeof(hgraph_bitset_t) * pipeline->num_metas);
+
 	const hgraph_node_type_info_t* node_types = graph->registry->node_types;
-	for (hgraph_index_t i = 0; i < pipeline->num_nodes; ++i) {
+	for (hgraph_index_t i = 0; i < pipeline->num_metas; ++i) {
 		hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[i];
-		node_meta->state = HGRAPH_NODE_STATE_WAITING;
 		node_meta->status = NULL;
-		hgraph_bitset_init(&node_meta->received_inputs);
-		hgraph_bitset_init(&node_meta->sent_outputs);
 
 		// Init output buffers
 		const hgraph_node_type_info_t* node_type = &node_types[node_meta->type];
@@ -451,29 +887,23 @@ hgraph_pipeline_execute(
 		}
 	}
 
-	// Schedule the initial nodes
+	// All the inputs a node can receive have been sent by the time it is
+	// reached in topological order
 	for (hgraph_index_t i = 0; i < pipeline->num_nodes; ++i) {
-		hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[i];
+		hgraph_index_t node_slot = pipeline->order[i];
+		if (!hgraph_pipeline_is_node_ready(pipeline, node_slot)) { continue; }
 
-		if (
-			hgraph_pipeline_is_node_ready(pipeline, i)
-			&& hgraph_pipeline_schedule_node(pipeline, i)
-			&& !watcher(
-				&(hgraph_pipeline_event_t){
-					.type = HGRAPH_PIPELINE_EV_SCHEDULE_NODE,
-					.node = node_meta->id,
-				},
-				userdata
-			)
-		) {
+		const hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[node_slot];
+
+		if (!watcher(
+			&(hgraph_pipeline_event_t){
+				.type = HGRAPH_PIPELINE_EV_SCHEDULE_NODE,
+				.node = node_meta->id,
+			},
+			userdata
+		)) {
 			return HGRAPH_PIPELINE_EXEC_ABORTED;
 		}
-	}
-
-	while (pipeline->num_ready_nodes > 0) {
-		hgraph_index_t node_slot = pipeline->ready_nodes[--pipeline->num_ready_nodes];
-		hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[node_slot];
-		const hgraph_node_type_info_t* node_type = &node_types[node_meta->type];
 
 		if (!watcher(
 			&(hgraph_pipeline_event_t){
@@ -485,63 +915,10 @@ hgraph_pipeline_execute(
 			return HGRAPH_PIPELINE_EXEC_ABORTED;
 		}
 
-		hgraph_pipeline_node_ctx_t ctx = {
-			.impl = hgraph_pipeline_node_api,
-			.pipeline = pipeline,
-			.watcher = watcher,
-			.watcher_data = userdata,
-			.slot = node_slot,
-		};
-		if (node_type->definition->execute != NULL) {
-			node_type->definition->execute(&ctx.impl);
-		}
-		pipeline->step_alloc_ptr = pipeline->scratch_zone_start;
-		node_meta->state = HGRAPH_NODE_STATE_EXECUTED;
-		if (ctx.termination_reason != HGRAPH_PIPELINE_EXEC_FINISHED) {
-			return ctx.termination_reason;
-		}
-		if (!hgraph_bitset_is_all_set(node_meta->sent_outputs, node_type->required_outputs)) {
-			return HGRAPH_PIPELINE_EXEC_INCOMPLETE_OUTPUT;
-		}
-
-		// Schedule dependent nodes
-		const hgraph_node_t* node = hgraph_get_node_by_slot(graph, node_slot);
-		for (hgraph_index_t i = 0; i < node_type->num_output_pins; ++i) {
-			const hgraph_var_t* var = &node_type->output_pins[i];
-			hgraph_edge_link_t* output_pin = (hgraph_edge_link_t*)((char*)node + var->offset);
-			hgraph_index_t itr = output_pin->next;
-			while (true) {
-				const hgraph_edge_link_t* link = hgraph_resolve_edge(graph, output_pin, itr);
-				if (link == output_pin) { break; }
-
-				const hgraph_edge_t* edge = HGRAPH_CONTAINER_OF(link, hgraph_edge_t, output_pin_link);
-				hgraph_index_t to_node_id, to_pin_index;
-				bool is_output;
-				hgraph_decode_pin_id(edge->to_pin, &to_node_id, &to_pin_index, &is_output);
-				hgraph_index_t to_node_slot = hgraph_slot_map_slot_for_id(
-					&graph->node_slot_map, to_node_id
-				);
-				HGRAPH_ASSERT(HGRAPH_IS_VALID_INDEX(to_node_slot));
-				HGRAPH_ASSERT(to_node_slot < pipeline->num_nodes);
-				const hgraph_pipeline_node_meta_t* to_node_meta = &pipeline->node_metas[to_node_slot];
-
-				if (
-					hgraph_pipeline_is_node_ready(pipeline, to_node_slot)
-					&& hgraph_pipeline_schedule_node(pipeline, to_node_slot)
-					&& !watcher(
-						&(hgraph_pipeline_event_t){
-							.type = HGRAPH_PIPELINE_EV_SCHEDULE_NODE,
-							.node = to_node_meta->id,
-						},
-						userdata
-					)
-				) {
-					return HGRAPH_PIPELINE_EXEC_ABORTED;
-				}
-
-				itr = link->next;
-			}
-		}
+		hgraph_pipeline_execution_status_t status = hgraph_pipeline_run_node(
+			pipeline, node_slot, watcher, userdata
+		);
+		if (status != HGRAPH_PIPELINE_EXEC_FINISHED) { return status; }
 
 		if (!watcher(
 			&(hgraph_pipeline_event_t){
@@ -554,7 +931,7 @@ hgraph_pipeline_execute(
 		}
 	}
 
-	for (hgraph_index_t i = 0; i < pipeline->num_nodes; ++i) {
+	for (hgraph_index_t i = 0; i < pipeline->num_metas; ++i) {
 		hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[i];
 		const hgraph_node_type_info_t* node_type = &node_types[node_meta->type];
 		if (node_type->definition->end_pipeline != NULL) {
@@ -592,7 +969,7 @@ hgraph_pipeline_get_node_status(
 	if (node_slot >= pipeline->num_nodes) { return NULL; }
 
 	const hgraph_pipeline_node_meta_t* node_meta = &pipeline->node_metas[node_slot];
-	hgraph_index_t node_version = pipeline->graph->node_versions[node_id];
+	hgraph_index_t node_version = hgraph_node_versions(pipeline->graph)[node_id];
 	return node_meta->id == node_id && node_meta->version == node_version
 		? node_meta->status
 		: NULL;
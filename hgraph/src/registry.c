@@ -1,4 +1,5 @@
 #include "internal.h"
+#include "graph.h"
 #include "mem_layout.h"
 #include "hash.h"
 #include <string.h>
@@ -155,6 +156,170 @@ hgraph_registry_builder_as_plugin_api(hgraph_registry_builder_t* builder) {
 	return &builder->plugin_api;
 }
 
+const hgraph_var_t*
+hgraph_registry_get_vars(
+	const hgraph_node_type_info_t* type_info,
+	hgraph_name_kind_t kind,
+	hgraph_index_t* num_vars
+) {
+	switch (kind) {
+		case HGRAPH_NAME_ATTRIBUTE:
+			*num_vars = type_info->num_attributes;
+			return type_info->attributes;
+		case HGRAPH_NAME_INPUT_PIN:
+			*num_vars = type_info->num_input_pins;
+			return type_info->input_pins;
+		case HGRAPH_NAME_OUTPUT_PIN:
+			*num_vars = type_info->num_output_pins;
+			return type_info->output_pins;
+		default:
+			*num_vars = 0;
+			return NULL;
+	}
+}
+
+HGRAPH_PRIVATE hgraph_str_t
+hgraph_registry_entry_name(
+	const hgraph_registry_t* registry,
+	const hgraph_name_entry_t* entry
+) {
+	if (entry->kind == HGRAPH_NAME_NODE_TYPE) {
+		return registry->node_types[entry->index].name;
+	}
+
+	hgraph_index_t num_vars;
+	const hgraph_var_t* vars = hgraph_registry_get_vars(
+		&registry->node_types[entry->type], entry->kind, &num_vars
+	);
+	return vars[entry->index].name;
+}
+
+// Returns the entry of the name or the empty slot where it belongs
+HGRAPH_PRIVATE hgraph_name_entry_t*
+hgraph_registry_probe_name(
+	const hgraph_registry_t* registry,
+	hgraph_index_t type,
+	hgraph_name_kind_t kind,
+	hgraph_str_t name
+) {
+	uint64_t hash = hash_fnv1a(&type, sizeof(type));
+	hash = hash_fnv1a_continue(hash, &kind, sizeof(kind));
+	hash = hash_murmur64(hash_fnv1a_continue(hash, name.data, (size_t)name.length));
+
+	hgraph_index_t i = (hgraph_index_t)hash;
+	hgraph_index_t exp = registry->name_table_exp;
+	while (true) {
+		i = hash_msi(hash, exp, i);
+		hgraph_name_entry_t* entry = &registry->name_table[i];
+		if (entry->kind == HGRAPH_NAME_NONE) { return entry; }
+
+		if (
+			entry->kind == kind
+			&& entry->type == type
+			&& hgraph_str_equal(hgraph_registry_entry_name(registry, entry), name)
+		) {
+			return entry;
+		}
+	}
+}
+
+HGRAPH_PRIVATE void
+hgraph_registry_put_name(
+	hgraph_registry_t* registry,
+	hgraph_index_t type,
+	hgraph_name_kind_t kind,
+	hgraph_index_t index,
+	hgraph_str_t name
+) {
+	hgraph_name_entry_t* entry = hgraph_registry_probe_name(registry, type, kind, name);
+	// The first of duplicated names wins
+	if (entry->kind != HGRAPH_NAME_NONE) { return; }
+
+	*entry = (hgraph_name_entry_t){
+		.type = type,
+		.index = index,
+		.kind = kind,
+	};
+}
+
+HGRAPH_PRIVATE void
+hgraph_registry_put_vars(
+	hgraph_registry_t* registry,
+	hgraph_index_t type,
+	hgraph_name_kind_t kind
+) {
+	hgraph_index_t num_vars;
+	const hgraph_var_t* vars = hgraph_registry_get_vars(
+		&registry->node_types[type], kind, &num_vars
+	);
+	for (hgraph_index_t i = 0; i < num_vars; ++i) {
+		hgraph_registry_put_name(registry, type, kind, i, vars[i].name);
+	}
+}
+
+const hgraph_node_type_info_t*
+hgraph_registry_find_node_type(const hgraph_registry_t* registry, hgraph_str_t name) {
+	const hgraph_name_entry_t* entry = hgraph_registry_probe_name(
+		registry, 0, HGRAPH_NAME_NODE_TYPE, name
+	);
+	return entry->kind != HGRAPH_NAME_NONE ? &registry->node_types[entry->index] : NULL;
+}
+
+hgraph_index_t
+hgraph_registry_find_var(
+	const hgraph_registry_t* registry,
+	const hgraph_node_type_info_t* type_info,
+	hgraph_name_kind_t kind,
+	hgraph_str_t name
+) {
+	const hgraph_name_entry_t* entry = hgraph_registry_probe_name(
+		registry, (hgraph_index_t)(type_info - registry->node_types), kind, name
+	);
+	return entry->kind != HGRAPH_NAME_NONE ? entry->index : HGRAPH_INVALID_INDEX;
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_fingerprint_str(uint64_t h, hgraph_str_t str) {
+	h = hash_fnv1a_continue(h, &str.length, sizeof(str.length));
+	return hash_fnv1a_continue(h, str.data, (size_t)str.length);
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_fingerprint_vars(
+	uint64_t h,
+	const hgraph_registry_t* registry,
+	const hgraph_var_t* vars,
+	hgraph_index_t num_vars
+) {
+	h = hash_fnv1a_continue(h, &num_vars, sizeof(num_vars));
+	for (hgraph_index_t i = 0; i < num_vars; ++i) {
+		// Data types are identified by name since their indices depend on
+		// the order of a hash table
+		const hgraph_data_type_info_t* data_type = &registry->data_types[vars[i].type];
+		h = hgraph_fingerprint_str(h, vars[i].name);
+		h = hgraph_fingerprint_str(h, data_type->name);
+		h = hash_fnv1a_continue(h, &data_type->size, sizeof(data_type->size));
+		h = hash_fnv1a_continue(h, &vars[i].offset, sizeof(vars[i].offset));
+	}
+	return h;
+}
+
+HGRAPH_PRIVATE uint64_t
+hgraph_registry_fingerprint(const hgraph_registry_t* registry) {
+	uint64_t h = hash_fnv1a(&registry->max_node_size, sizeof(registry->max_node_size));
+	h = hash_fnv1a_continue(h, &registry->max_edges_per_node, sizeof(registry->max_edges_per_node));
+	h = hash_fnv1a_continue(h, &registry->num_node_types, sizeof(registry->num_node_types));
+	for (hgraph_index_t i = 0; i < registry->num_node_types; ++i) {
+		const hgraph_node_type_info_t* type = &registry->node_types[i];
+		h = hgraph_fingerprint_str(h, type->name);
+		h = hash_fnv1a_continue(h, &type->size, sizeof(type->size));
+		h = hgraph_fingerprint_vars(h, registry, type->attributes, type->num_attributes);
+		h = hgraph_fingerprint_vars(h, registry, type->input_pins, type->num_input_pins);
+		h = hgraph_fingerprint_vars(h, registry, type->output_pins, type->num_output_pins);
+	}
+	return hash_murmur64(h);
+}
+
 size_t
 hgraph_registry_init(
 	hgraph_registry_t* registry,
@@ -245,6 +410,13 @@ hgraph_registry_init(
 	ptrdiff_t node_type_by_definition_offset = hgraph_ptr_table_reserve(
 		&layout, builder->num_node_types
 	);
+	// Kept at most half full
+	hgraph_index_t name_table_exp = hash_exp((num_node_types + num_vars) * 2 + 1);
+	ptrdiff_t name_table_offset = mem_layout_reserve(
+		&layout,
+		sizeof(hgraph_name_entry_t) * hash_size(name_table_exp),
+		_Alignof(hgraph_name_entry_t)
+	);
 
 	size_t required_size = mem_layout_size(&layout);
 	if (registry == NULL || size < required_size) { return required_size; }
@@ -254,7 +426,14 @@ hgraph_registry_init(
 		.num_node_types = builder->num_node_types,
 		.data_types = mem_layout_locate(registry, data_types_offset),
 		.node_types = mem_layout_locate(registry, node_types_offset),
+		.name_table_exp = name_table_exp,
+		.name_table = mem_layout_locate(registry, name_table_offset),
 	};
+	memset(
+		registry->name_table,
+		0,
+		sizeof(hgraph_name_entry_t) * hash_size(name_table_exp)
+	);
 	hgraph_var_t* vars = mem_layout_locate(registry, vars_offset);
 	hgraph_output_buffer_info_t* output_buffers = mem_layout_locate(registry, output_buffers_offset);
 	char* str_table = mem_layout_locate(registry, string_table_offset);
@@ -443,6 +622,17 @@ hgraph_registry_init(
 
 	registry->max_node_size = max_node_size;
 	registry->max_edges_per_node = max_edges_per_node;
+	registry->fingerprint = hgraph_registry_fingerprint(registry);
+
+	// Skip the dummy type
+	for (hgraph_index_t i = 1; i < num_node_types; ++i) {
+		hgraph_registry_put_name(
+			registry, 0, HGRAPH_NAME_NODE_TYPE, i, registry->node_types[i].name
+		);
+		hgraph_registry_put_vars(registry, i, HGRAPH_NAME_ATTRIBUTE);
+		hgraph_registry_put_vars(registry, i, HGRAPH_NAME_INPUT_PIN);
+		hgraph_registry_put_vars(registry, i, HGRAPH_NAME_OUTPUT_PIN);
+	}
 
 	return required_size;
 }
@@ -466,5 +656,6 @@ hgraph_registry_info(const hgraph_registry_t* registry) {
 	return (hgraph_registry_info_t){
 		.num_data_types = registry->num_data_types,
 		.num_node_types = registry->num_node_types - 1,  // exclude dummy
+		.fingerprint = registry->fingerprint,
 	};
 }
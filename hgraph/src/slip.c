@@ -8,31 +8,55 @@ static const uint8_t HGRAPH_SLIP_ESC_ESC = 0xdd;
 static const uint8_t HGRAPH_SLIP_ESCAPED_END[] = { HGRAPH_SLIP_ESC, HGRAPH_SLIP_ESC_END };
 static const uint8_t HGRAPH_SLIP_ESCAPED_ESC[] = { HGRAPH_SLIP_ESC, HGRAPH_SLIP_ESC_ESC };
 
+// Return the index of the first END or ESC byte or size if there is none.
+// Bytes are tested 8 at a time with the "has zero byte" trick.
+HGRAPH_PRIVATE size_t
+hgraph_slip_find_special(const uint8_t* data, size_t size) {
+	const uint64_t ones = 0x0101010101010101ull;
+	const uint64_t highs = 0x8080808080808080ull;
+	const uint64_t ends = ones * HGRAPH_SLIP_END;
+	const uint64_t escs = ones * HGRAPH_SLIP_ESC;
+
+	size_t i = 0;
+	for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		uint64_t end_diff = word ^ ends;
+		uint64_t esc_diff = word ^ escs;
+		uint64_t found = ((end_diff - ones) & ~end_diff) | ((esc_diff - ones) & ~esc_diff);
+		if ((found & highs) != 0) { break; }
+	}
+
+	for (; i < size; ++i) {
+		if (data[i] == HGRAPH_SLIP_END || data[i] == HGRAPH_SLIP_ESC) { break; }
+	}
+
+	return i;
+}
+
 HGRAPH_PRIVATE size_t
 hgraph_slip_out_write(hgraph_out_t* impl, const void* buf, size_t size) {
 	hgraph_slip_out_t* slip = HGRAPH_CONTAINER_OF(impl, hgraph_slip_out_t, impl);
 	hgraph_out_t* out = slip->out;
 	const uint8_t* chars = buf;
 
-	for (size_t i = 0; i < size; ++i) {
-		uint8_t ch = chars[i];
-
-		const uint8_t* escaped_buf;
-		size_t escaped_size;
-		if (ch == HGRAPH_SLIP_END) {
-			escaped_buf = HGRAPH_SLIP_ESCAPED_END;
-			escaped_size = sizeof(HGRAPH_SLIP_ESCAPED_END);
-		} else if (ch == HGRAPH_SLIP_ESC) {
-			escaped_buf = HGRAPH_SLIP_ESCAPED_ESC;
-			escaped_size = sizeof(HGRAPH_SLIP_ESCAPED_ESC);
-		} else {
-			escaped_buf = &ch;
-			escaped_size = sizeof(ch);
+	size_t i = 0;
+	while (i < size) {
+		// Write runs of plain bytes in one go
+		size_t run_size = hgraph_slip_find_special(chars + i, size - i);
+		if (run_size > 0 && hgraph_io_write(out, chars + i, run_size) != HGRAPH_IO_OK) {
+			return i;
 		}
+		i += run_size;
+		if (i == size) { break; }
 
-		if (hgraph_io_write(out, escaped_buf, escaped_size) != HGRAPH_IO_OK) {
+		const uint8_t* escaped_buf = chars[i] == HGRAPH_SLIP_END
+			? HGRAPH_SLIP_ESCAPED_END
+			: HGRAPH_SLIP_ESCAPED_ESC;
+		if (hgraph_io_write(out, escaped_buf, sizeof(HGRAPH_SLIP_ESCAPED_END)) != HGRAPH_IO_OK) {
 			return i;
 		}
+		++i;
 	}
 
 	return size;
@@ -44,7 +68,19 @@ hgraph_slip_in_read(hgraph_in_t* impl, void* buf, size_t size) {
 	hgraph_in_t* in = slip->in;
 	uint8_t* chars = buf;
 
-	for (size_t i = 0; i < size; ++i) {
+	size_t i = 0;
+	while (i < size) {
+		// Copy runs of plain bytes straight out of the underlying window
+		size_t available = HGRAPH_MIN(hgraph_io_available(in), size - i);
+		if (available > 0) {
+			size_t run_size = hgraph_slip_find_special((const uint8_t*)in->pos, available);
+			memcpy(chars + i, in->pos, run_size);
+			in->pos += run_size;
+			i += run_size;
+			if (run_size == available) { continue; }
+		}
+
+		// The next byte is special or the window needs a refill
 		uint8_t ch;
 		if (hgraph_io_read(in, &ch, sizeof(ch)) != HGRAPH_IO_OK) { return i; }
 
@@ -63,6 +99,7 @@ hgraph_slip_in_read(hgraph_in_t* impl, void* buf, size_t size) {
 		} else {
 			chars[i] = ch;
 		}
+		++i;
 	}
 
 	return size;
@@ -70,7 +107,7 @@ hgraph_slip_in_read(hgraph_in_t* impl, void* buf, size_t size) {
 
 hgraph_out_t*
 hgraph_slip_out_init(hgraph_slip_out_t* slip, hgraph_out_t* out) {
-	slip->impl.write = hgraph_slip_out_write;
+	slip->impl = (hgraph_out_t){ .write = hgraph_slip_out_write };
 	slip->out = out;
 	return &slip->impl;
 }
@@ -82,7 +119,7 @@ hgraph_slip_out_end(hgraph_out_t* out) {
 
 hgraph_in_t*
 hgraph_slip_in_init(hgraph_slip_in_t* slip, hgraph_in_t* in) {
-	slip->impl.read = hgraph_slip_in_read;
+	slip->impl = (hgraph_in_t){ .read = hgraph_slip_in_read };
 	slip->in = in;
 	return &slip->impl;
 }
@@ -90,6 +127,19 @@ hgraph_slip_in_init(hgraph_slip_in_t* slip, hgraph_in_t* in) {
 hgraph_io_status_t
 hgraph_slip_in_skip(hgraph_in_t* in) {
 	while (true) {
+		// END never appears escaped so it can be searched for directly
+		size_t available = hgraph_io_available(in);
+		if (available > 0) {
+			const char* end = memchr(in->pos, HGRAPH_SLIP_END, available);
+			if (end != NULL) {
+				in->pos = end + 1;
+				return HGRAPH_IO_OK;
+			}
+
+			in->pos = in->end;
+			continue;
+		}
+
 		uint8_t ch;
 		HGRAPH_CHECK_IO(hgraph_io_read(in, &ch, sizeof(ch)));
 
@@ -17,13 +17,15 @@ hgraph_slot_map_init(
 	hgraph_index_t max_items,
 	void* memory
 ) {
+	hgraph_index_t* slots_for_id = memory;
+	hgraph_index_t* ids_for_slot = slots_for_id + max_items;
 	slot_map->max_items = max_items;
 	slot_map->num_items = 0;
-	slot_map->slots_for_id = memory;
-	slot_map->ids_for_slot = slot_map->slots_for_id + max_items;
+	slot_map->slots_for_id_offset = (char*)slots_for_id - (char*)slot_map;
+	slot_map->ids_for_slot_offset = (char*)ids_for_slot - (char*)slot_map;
 
 	for (hgraph_index_t i = 0; i < max_items; ++i) {
-		slot_map->slots_for_id[i] = slot_map->ids_for_slot[i] = i;
+		slots_for_id[i] = ids_for_slot[i] = i;
 	}
 }
 
@@ -40,7 +42,37 @@ hgraph_slot_map_allocate(
 	}
 
 	hgraph_index_t slot = slot_map->num_items++;
-	*id_out = slot_map->ids_for_slot[slot];
+	*id_out = hgraph_slot_map_ids_for_slot(slot_map)[slot];
+	*slot_index_out = slot;
+}
+
+void
+hgraph_slot_map_allocate_id(
+	hgraph_slot_map_t* slot_map,
+	hgraph_index_t id,
+	hgraph_index_t* slot_index_out
+) {
+	hgraph_index_t* slots_for_id = hgraph_slot_map_slots_for_id(slot_map);
+	hgraph_index_t* ids_for_slot = hgraph_slot_map_ids_for_slot(slot_map);
+	if (
+		slot_map->num_items == slot_map->max_items
+		|| !(0 <= id && id < slot_map->max_items)
+		|| slots_for_id[id] < slot_map->num_items
+	) {
+		*slot_index_out = HGRAPH_INVALID_INDEX;
+		return;
+	}
+
+	// Move the requested id into the next free slot
+	hgraph_index_t slot = slot_map->num_items++;
+	hgraph_index_t vacant_slot = slots_for_id[id];
+	hgraph_index_t other_id = ids_for_slot[slot];
+
+	ids_for_slot[vacant_slot] = other_id;
+	ids_for_slot[slot] = id;
+	slots_for_id[other_id] = vacant_slot;
+	slots_for_id[id] = slot;
+
 	*slot_index_out = slot;
 }
 
@@ -58,13 +90,15 @@ hgraph_slot_map_free(
 		return;
 	}
 
+	hgraph_index_t* slots_for_id = hgraph_slot_map_slots_for_id(slot_map);
+	hgraph_index_t* ids_for_slot = hgraph_slot_map_ids_for_slot(slot_map);
 	hgraph_index_t last_slot = --slot_map->num_items;
-	hgraph_index_t last_item_id = slot_map->ids_for_slot[last_slot];
+	hgraph_index_t last_item_id = ids_for_slot[last_slot];
 
-	slot_map->ids_for_slot[last_slot] = id;
-	slot_map->ids_for_slot[deleted_slot] = last_item_id;
-	slot_map->slots_for_id[last_item_id] = deleted_slot;
-	slot_map->slots_for_id[id] = last_slot;
+	ids_for_slot[last_slot] = id;
+	ids_for_slot[deleted_slot] = last_item_id;
+	slots_for_id[last_item_id] = deleted_slot;
+	slots_for_id[id] = last_slot;
 
 	*dst_slot_index_out = deleted_slot;
 	*src_slot_index_out = last_slot;
@@ -74,14 +108,14 @@ hgraph_index_t
 hgraph_slot_map_slot_for_id(const hgraph_slot_map_t* slot_map, hgraph_index_t id) {
 	if (!((0 <= id) && (id < slot_map->max_items))) { return HGRAPH_INVALID_INDEX; }
 
-	hgraph_index_t slot = slot_map->slots_for_id[id];
+	hgraph_index_t slot = hgraph_slot_map_slots_for_id(slot_map)[id];
 	return ((0 <= slot) && (slot < slot_map->num_items)) ? slot : HGRAPH_INVALID_INDEX;
 }
 
 hgraph_index_t
 hgraph_slot_map_id_for_slot(const hgraph_slot_map_t* slot_map, hgraph_index_t slot) {
 	return ((0 <= slot) && (slot < slot_map->num_items))
-		? slot_map->ids_for_slot[slot]
+		? hgraph_slot_map_ids_for_slot(slot_map)[slot]
 		: HGRAPH_INVALID_INDEX;
 }
 
@@ -91,12 +125,31 @@ hgraph_slot_map_swap_id(hgraph_slot_map_t* slot_map, hgraph_index_t occupied_id,
 		(0 <= occupied_id && occupied_id < slot_map->max_items)
 		&& (0 <= vacant_id && vacant_id < slot_map->max_items)
 	);
-	hgraph_index_t occupied_slot = slot_map->slots_for_id[occupied_id];
-	hgraph_index_t vacant_slot = slot_map->slots_for_id[vacant_id];
-	HGRAPH_ASSERT(occupied_id < slot_map->num_items && slot_map->num_items <= vacant_slot);
-
-	slot_map->slots_for_id[occupied_id] = vacant_slot;
-	slot_map->slots_for_id[vacant_id] = occupied_slot;
-	slot_map->ids_for_slot[occupied_slot] = vacant_id;
-	slot_map->ids_for_slot[vacant_slot] = occupied_id;
+	hgraph_index_t* slots_for_id = hgraph_slot_map_slots_for_id(slot_map);
+	hgraph_index_t* ids_for_slot = hgraph_slot_map_ids_for_slot(slot_map);
+	hgraph_index_t occupied_slot = slots_for_id[occupied_id];
+	hgraph_index_t vacant_slot = slots_for_id[vacant_id];
+	HGRAPH_ASSERT(occupied_slot < slot_map->num_items && slot_map->num_items <= vacant_slot);
+
+	slots_for_id[occupied_id] = vacant_slot;
+	slots_for_id[vacant_id] = occupied_slot;
+	ids_for_slot[occupied_slot] = vacant_id;
+	ids_for_slot[vacant_slot] = occupied_id;
+}
+
+void
+hgraph_slot_map_swap_slots(hgraph_slot_map_t* slot_map, hgraph_index_t slot_a, hgraph_index_t slot_b) {
+	HGRAPH_ASSERT(
+		(0 <= slot_a && slot_a < slot_map->num_items)
+		&& (0 <= slot_b && slot_b < slot_map->num_items)
+	);
+	hgraph_index_t* slots_for_id = hgraph_slot_map_slots_for_id(slot_map);
+	hgraph_index_t* ids_for_slot = hgraph_slot_map_ids_for_slot(slot_map);
+	hgraph_index_t id_a = ids_for_slot[slot_a];
+	hgraph_index_t id_b = ids_for_slot[slot_b];
+
+	ids_for_slot[slot_a] = id_b;
+	ids_for_slot[slot_b] = id_a;
+	slots_for_id[id_a] = slot_b;
+	slots_for_id[id_b] = slot_a;
 }
@@ -4,13 +4,25 @@
 #include <hgraph/common.h>
 #include "mem_layout.h"
 
+// Arrays are located relative to the slot map itself so it can be copied
+// along with its memory
 typedef struct hgraph_slot_map_s {
 	hgraph_index_t max_items;
 	hgraph_index_t num_items;
-	hgraph_index_t* ids_for_slot;
-	hgraph_index_t* slots_for_id;
+	ptrdiff_t ids_for_slot_offset;
+	ptrdiff_t slots_for_id_offset;
 } hgraph_slot_map_t;
 
+static inline hgraph_index_t*
+hgraph_slot_map_ids_for_slot(const hgraph_slot_map_t* slot_map) {
+	return mem_layout_locate((void*)slot_map, slot_map->ids_for_slot_offset);
+}
+
+static inline hgraph_index_t*
+hgraph_slot_map_slots_for_id(const hgraph_slot_map_t* slot_map) {
+	return mem_layout_locate((void*)slot_map, slot_map->slots_for_id_offset);
+}
+
 ptrdiff_t
 hgraph_slot_map_reserve(mem_layout_t* layout, hgraph_index_t max_items);
 
@@ -28,6 +40,13 @@ hgraph_slot_map_allocate(
 	hgraph_index_t* slot_index_out
 );
 
+void
+hgraph_slot_map_allocate_id(
+	hgraph_slot_map_t* slot_map,
+	hgraph_index_t id,
+	hgraph_index_t* slot_index_out
+);
+
 void
 hgraph_slot_map_free(
 	hgraph_slot_map_t* slot_map,
@@ -39,6 +58,9 @@ hgraph_slot_map_free(
 void
 hgraph_slot_map_swap_id(hgraph_slot_map_t* slot_map, hgraph_index_t occupied, hgraph_index_t vacant);
 
+void
+hgraph_slot_map_swap_slots(hgraph_slot_map_t* slot_map, hgraph_index_t slot_a, hgraph_index_t slot_b);
+
 hgraph_index_t
 hgraph_slot_map_slot_for_id(const hgraph_slot_map_t* slot_map, hgraph_index_t id);
 
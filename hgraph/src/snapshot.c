@@ -0,0 +1,63 @@
+#include "internal.h"
+#include "graph.h"
+
+HGRAPH_PRIVATE bool
+hgraph_snapshot_is_compatible(const hgraph_t* snapshot, const hgraph_t* graph) {
+	return snapshot->registry == graph->registry
+		&& snapshot->max_name_length == graph->max_name_length
+		&& snapshot->name_storage_size == graph->name_storage_size
+		&& snapshot->node_size == graph->node_size
+		&& snapshot->node_slot_map.max_items == graph->node_slot_map.max_items
+		&& snapshot->edge_slot_map.max_items == graph->edge_slot_map.max_items
+		&& snapshot->body_offset == graph->body_offset
+		&& snapshot->body_size == graph->body_size;
+}
+
+bool
+hgraph_snapshot(hgraph_t* snapshot, const hgraph_t* graph) {
+	if (!hgraph_snapshot_is_compatible(snapshot, graph)) { return false; }
+
+	char* dst = (char*)snapshot + snapshot->body_offset;
+	const char* src = (const char*)graph + graph->body_offset;
+	size_t body_size = graph->body_size;
+
+	size_t num_chunks = (body_size + HGRAPH_CHUNK_SIZE - 1) / HGRAPH_CHUNK_SIZE;
+	bool synced = snapshot->snapshot_instance == graph->instance
+		// Unless the snapshot itself was written to after the last sync
+		&& snapshot->revision == snapshot->snapshot_revision;
+	if (synced) {
+		// Only copy the chunks written to since the last sync
+		uint64_t last_revision = snapshot->snapshot_revision;
+		for (size_t i = 0; i < num_chunks; ++i) {
+			if (hgraph_chunk_revisions(graph)[i] <= last_revision) { continue; }
+
+			size_t offset = i * HGRAPH_CHUNK_SIZE;
+			size_t chunk_size = HGRAPH_MIN(HGRAPH_CHUNK_SIZE, body_size - offset);
+			memcpy(dst + offset, src + offset, chunk_size);
+			hgraph_chunk_revisions(snapshot)[i] = hgraph_chunk_revisions(graph)[i];
+		}
+	} else {
+		memcpy(dst, src, body_size);
+		memcpy(
+			hgraph_chunk_revisions(snapshot),
+			hgraph_chunk_revisions(graph),
+			sizeof(uint64_t) * num_chunks
+		);
+		// The revision history was replaced, anything synced from this
+		// snapshot must do a full copy
+		snapshot->instance = hgraph_new_instance();
+	}
+
+	snapshot->version = graph->version;
+	snapshot->node_slot_map.num_items = graph->node_slot_map.num_items;
+	snapshot->edge_slot_map.num_items = graph->edge_slot_map.num_items;
+	snapshot->order_end = graph->order_end;
+	snapshot->name_storage_end = graph->name_storage_end;
+	snapshot->name_table_load = graph->name_table_load;
+	snapshot->digest = graph->digest;
+	snapshot->revision = graph->revision;
+	snapshot->snapshot_instance = graph->instance;
+	snapshot->snapshot_revision = graph->revision;
+
+	return true;
+}
@@ -0,0 +1,239 @@
+#include <hgraph/stream.h>
+#include <hgraph/io.h>
+#include "internal.h"
+#include <errno.h>
+#if defined(_WIN32)
+#	include <io.h>
+#else
+#	include <unistd.h>
+#endif
+
+HGRAPH_PRIVATE size_t
+hgraph_stream_fill_file(hgraph_stream_in_t* stream, void* buffer, size_t size) {
+	return fread(buffer, 1, size, stream->source.file);
+}
+
+HGRAPH_PRIVATE size_t
+hgraph_stream_drain_file(hgraph_stream_out_t* stream, const void* buffer, size_t size) {
+	return fwrite(buffer, 1, size, stream->sink.file);
+}
+
+HGRAPH_PRIVATE size_t
+hgraph_stream_fill_fd(hgraph_stream_in_t* stream, void* buffer, size_t size) {
+	size_t total = 0;
+	while (total < size) {
+#if defined(_WIN32)
+		int result = _read(
+			stream->source.fd,
+			(char*)buffer + total,
+			(unsigned int)HGRAPH_MIN(size - total, (size_t)INT_MAX)
+		);
+#else
+		ssize_t result = read(stream->source.fd, (char*)buffer + total, size - total);
+#endif
+		if (result < 0 && errno == EINTR) { continue; }
+		if (result <= 0) { break; }
+
+		total += (size_t)result;
+	}
+
+	return total;
+}
+
+HGRAPH_PRIVATE size_t
+hgraph_stream_drain_fd(hgraph_stream_out_t* stream, const void* buffer, size_t size) {
+	size_t total = 0;
+	while (total < size) {
+#if defined(_WIN32)
+		int result = _write(
+			stream->sink.fd,
+			(const char*)buffer + total,
+			(unsigned int)HGRAPH_MIN(size - total, (size_t)INT_MAX)
+		);
+#else
+		ssize_t result = write(stream->sink.fd, (const char*)buffer + total, size - total);
+#endif
+		if (result < 0 && errno == EINTR) { continue; }
+		if (result <= 0) { break; }
+
+		total += (size_t)result;
+	}
+
+	return total;
+}
+
+// Only reached when the window cannot satisfy the read
+HGRAPH_PRIVATE size_t
+hgraph_stream_read(hgraph_in_t* in, void* buffer, size_t size) {
+	hgraph_stream_in_t* stream = HGRAPH_CONTAINER_OF(in, hgraph_stream_in_t, in);
+	char* dst = buffer;
+
+	size_t total = HGRAPH_MIN(hgraph_io_available(in), size);
+	if (total > 0) {
+		memcpy(dst, in->pos, total);
+		in->pos += total;
+	}
+
+	if (stream->fill == NULL) { return total; }
+
+	while (total < size) {
+		size_t remaining = size - total;
+		if (remaining >= stream->buffer_size) {
+			// Large reads bypass the buffer
+			size_t num_read = stream->fill(stream, dst + total, remaining);
+			if (num_read == 0) { break; }
+
+			total += num_read;
+		} else {
+			size_t num_read = stream->fill(stream, stream->buffer, stream->buffer_size);
+			if (num_read == 0) { break; }
+
+			size_t copy_size = HGRAPH_MIN(num_read, remaining);
+			memcpy(dst + total, stream->buffer, copy_size);
+			total += copy_size;
+			in->pos = stream->buffer + copy_size;
+			in->end = stream->buffer + num_read;
+		}
+	}
+
+	return total;
+}
+
+// Only reached when the window cannot hold the write
+HGRAPH_PRIVATE size_t
+hgraph_stream_write(hgraph_out_t* out, const void* buffer, size_t size) {
+	hgraph_stream_out_t* stream = HGRAPH_CONTAINER_OF(out, hgraph_stream_out_t, out);
+	if (stream->drain == NULL) { return 0; }
+
+	if (hgraph_stream_flush(stream) != HGRAPH_IO_OK) { return 0; }
+
+	if (size >= stream->buffer_size) {
+		// Large writes bypass the buffer
+		size_t num_written = stream->drain(stream, buffer, size);
+		stream->num_bytes_drained += num_written;
+		return num_written;
+	} else {
+		memcpy(out->pos, buffer, size);
+		out->pos += size;
+		return size;
+	}
+}
+
+HGRAPH_PRIVATE hgraph_in_t*
+hgraph_stream_in_init(
+	hgraph_stream_in_t* stream,
+	size_t (*fill)(hgraph_stream_in_t* stream, void* buffer, size_t size),
+	void* buffer,
+	size_t buffer_size
+) {
+	stream->in = (hgraph_in_t){
+		.read = hgraph_stream_read,
+		.pos = buffer,
+		.end = buffer,
+	};
+	stream->fill = fill;
+	stream->buffer = buffer;
+	stream->buffer_size = buffer_size;
+	return &stream->in;
+}
+
+HGRAPH_PRIVATE hgraph_out_t*
+hgraph_stream_out_init(
+	hgraph_stream_out_t* stream,
+	size_t (*drain)(hgraph_stream_out_t* stream, const void* buffer, size_t size),
+	void* buffer,
+	size_t buffer_size
+) {
+	stream->out = (hgraph_out_t){
+		.write = hgraph_stream_write,
+		.pos = buffer,
+		.end = (char*)buffer + buffer_size,
+	};
+	stream->drain = drain;
+	stream->buffer = buffer;
+	stream->buffer_size = buffer_size;
+	stream->num_bytes_drained = 0;
+	return &stream->out;
+}
+
+hgraph_in_t*
+hgraph_stream_in_init_mem(hgraph_stream_in_t* stream, const void* data, size_t size) {
+	hgraph_in_t* in = hgraph_stream_in_init(stream, NULL, NULL, 0);
+	in->pos = data;
+	in->end = (const char*)data + size;
+	return in;
+}
+
+hgraph_in_t*
+hgraph_stream_in_init_file(
+	hgraph_stream_in_t* stream,
+	FILE* file,
+	void* buffer,
+	size_t buffer_size
+) {
+	stream->source.file = file;
+	return hgraph_stream_in_init(stream, hgraph_stream_fill_file, buffer, buffer_size);
+}
+
+hgraph_in_t*
+hgraph_stream_in_init_fd(
+	hgraph_stream_in_t* stream,
+	int fd,
+	void* buffer,
+	size_t buffer_size
+) {
+	stream->source.fd = fd;
+	return hgraph_stream_in_init(stream, hgraph_stream_fill_fd, buffer, buffer_size);
+}
+
+hgraph_out_t*
+hgraph_stream_out_init_mem(hgraph_stream_out_t* stream, void* data, size_t size) {
+	return hgraph_stream_out_init(stream, NULL, data, size);
+}
+
+hgraph_out_t*
+hgraph_stream_out_init_file(
+	hgraph_stream_out_t* stream,
+	FILE* file,
+	void* buffer,
+	size_t buffer_size
+) {
+	stream->sink.file = file;
+	return hgraph_stream_out_init(stream, hgraph_stream_drain_file, buffer, buffer_size);
+}
+
+hgraph_out_t*
+hgraph_stream_out_init_fd(
+	hgraph_stream_out_t* stream,
+	int fd,
+	void* buffer,
+	size_t buffer_size
+) {
+	stream->sink.fd = fd;
+	return hgraph_stream_out_init(stream, hgraph_stream_drain_fd, buffer, buffer_size);
+}
+
+hgraph_io_status_t
+hgraph_stream_flush(hgraph_stream_out_t* stream) {
+	if (stream->drain == NULL) { return HGRAPH_IO_OK; }
+
+	size_t size = (size_t)(stream->out.pos - stream->buffer);
+	if (size == 0) { return HGRAPH_IO_OK; }
+
+	size_t num_written = stream->drain(stream, stream->buffer, size);
+	stream->num_bytes_drained += num_written;
+	if (num_written != size) {
+		// Keep what was not written so a later flush can retry
+		memmove(stream->buffer, stream->buffer + num_written, size - num_written);
+		stream->out.pos = stream->buffer + (size - num_written);
+		return HGRAPH_IO_ERROR;
+	}
+
+	stream->out.pos = stream->buffer;
+	return HGRAPH_IO_OK;
+}
+
+size_t
+hgraph_stream_out_size(const hgraph_stream_out_t* stream) {
+	return stream->num_bytes_drained + (size_t)(stream->out.pos - stream->buffer);
+}
@@ -0,0 +1,92 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+
+static struct {
+	fixture_t base;
+} fixture;
+
+static hgraph_adjacency_t*
+build_adjacency(const hgraph_t* graph) {
+	size_t mem_required = hgraph_build_adjacency(NULL, 0, graph);
+	hgraph_adjacency_t* adjacency = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_build_adjacency(adjacency, mem_required, graph);
+	return adjacency;
+}
+
+TEST_SETUP(adjacency) {
+	fixture_init(&fixture.base);
+	create_start_mid_end_graph(fixture.base.graph);
+}
+
+TEST_TEARDOWN(adjacency) {
+	fixture_cleanup(&fixture.base);
+}
+
+TEST(adjacency, chain) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_adjacency_t* adjacency = build_adjacency(graph);
+	ASSERT_EQ(adjacency->num_nodes, 3);
+	ASSERT_EQ(adjacency->num_edges, 2);
+
+	hgraph_index_t start = adjacency->node_slots[hgraph_get_node_by_name(graph, HGRAPH_STR("start"))];
+	hgraph_index_t mid = adjacency->node_slots[hgraph_get_node_by_name(graph, HGRAPH_STR("mid"))];
+	hgraph_index_t end = adjacency->node_slots[hgraph_get_node_by_name(graph, HGRAPH_STR("end"))];
+	ASSERT_EQ(adjacency->node_ids[mid], hgraph_get_node_by_name(graph, HGRAPH_STR("mid")));
+
+	ASSERT_EQ(hgraph_adjacency_num_predecessors(adjacency, start), 0);
+	ASSERT_EQ(hgraph_adjacency_num_successors(adjacency, start), 1);
+	ASSERT_EQ(hgraph_adjacency_successors(adjacency, start)[0], mid);
+
+	ASSERT_EQ(hgraph_adjacency_num_predecessors(adjacency, mid), 1);
+	ASSERT_EQ(hgraph_adjacency_predecessors(adjacency, mid)[0], start);
+	ASSERT_EQ(hgraph_adjacency_num_successors(adjacency, mid), 1);
+	ASSERT_EQ(hgraph_adjacency_successors(adjacency, mid)[0], end);
+
+	ASSERT_EQ(hgraph_adjacency_num_predecessors(adjacency, end), 1);
+	ASSERT_EQ(hgraph_adjacency_predecessors(adjacency, end)[0], mid);
+	ASSERT_EQ(hgraph_adjacency_num_successors(adjacency, end), 0);
+
+	// Edge ids on both sides match
+	ASSERT_EQ(
+		hgraph_adjacency_out_edges(adjacency, mid)[0],
+		hgraph_adjacency_in_edges(adjacency, end)[0]
+	);
+	ASSERT_TRUE(
+		hgraph_is_pin_connected(
+			graph,
+			hgraph_get_pin_id(graph, adjacency->node_ids[end], &plugin1_end_in_i32)
+		)
+	);
+}
+
+TEST(adjacency, fan_out) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_index_t mid_out = hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32);
+	for (int i = 0; i < 3; ++i) {
+		hgraph_index_t node = hgraph_create_node(graph, &plugin1_end);
+		hgraph_connect(graph, mid_out, hgraph_get_pin_id(graph, node, &plugin1_end_in_i32));
+	}
+	// Moves slots around
+	hgraph_destroy_node(graph, hgraph_get_node_by_name(graph, HGRAPH_STR("start")));
+
+	hgraph_adjacency_t* adjacency = build_adjacency(graph);
+	ASSERT_EQ(adjacency->num_nodes, 5);
+	ASSERT_EQ(adjacency->num_edges, 4);
+
+	hgraph_index_t mid_slot = adjacency->node_slots[mid];
+	ASSERT_EQ(hgraph_adjacency_num_predecessors(adjacency, mid_slot), 0);
+	ASSERT_EQ(hgraph_adjacency_num_successors(adjacency, mid_slot), 4);
+	for (hgraph_index_t i = 0; i < 4; ++i) {
+		hgraph_index_t successor = hgraph_adjacency_successors(adjacency, mid_slot)[i];
+		ASSERT_EQ(hgraph_adjacency_num_predecessors(adjacency, successor), 1);
+		ASSERT_EQ(hgraph_adjacency_predecessors(adjacency, successor)[0], mid_slot);
+		ASSERT_TRUE(hgraph_get_node_type(graph, adjacency->node_ids[successor]) == &plugin1_end);
+	}
+	ASSERT_EQ(adjacency->forward_offsets[adjacency->num_nodes], 4);
+	ASSERT_EQ(adjacency->reverse_offsets[adjacency->num_nodes], 4);
+}
@@ -0,0 +1,101 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+
+static struct {
+	fixture_t base;
+} fixture;
+
+static hgraph_analysis_t*
+analyze(const hgraph_t* graph, const float* costs) {
+	size_t mem_required = hgraph_analyze(NULL, 0, graph, costs);
+	hgraph_analysis_t* analysis = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_analyze(analysis, mem_required, graph, costs);
+	return analysis;
+}
+
+TEST_SETUP(analysis) {
+	fixture_init(&fixture.base);
+	create_start_mid_end_graph(fixture.base.graph);
+}
+
+TEST_TEARDOWN(analysis) {
+	fixture_cleanup(&fixture.base);
+}
+
+TEST(analysis, chain) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+
+	hgraph_analysis_t* analysis = analyze(graph, NULL);
+	ASSERT_EQ(analysis->num_nodes, 3);
+	ASSERT_EQ(analysis->num_levels, 3);
+	ASSERT_EQ(analysis->max_width, 1);
+	ASSERT_EQ(analysis->total_cost, 3.f);
+	ASSERT_EQ(analysis->critical_path_cost, 3.f);
+
+	ASSERT_EQ(analysis->levels[start], 0);
+	ASSERT_EQ(analysis->levels[mid], 1);
+	ASSERT_EQ(analysis->levels[end], 2);
+
+	ASSERT_EQ(analysis->critical_path_length, 3);
+	ASSERT_EQ(analysis->critical_path[0], start);
+	ASSERT_EQ(analysis->critical_path[1], mid);
+	ASSERT_EQ(analysis->critical_path[2], end);
+	for (hgraph_index_t i = 0; i < analysis->critical_path_length; ++i) {
+		ASSERT_EQ(analysis->slacks[analysis->critical_path[i]], 0.f);
+	}
+}
+
+TEST(analysis, costs) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+
+	// A cheap branch from mid and an unconnected node
+	hgraph_index_t mid_out = hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32);
+	hgraph_index_t branch = hgraph_create_node(graph, &plugin1_end);
+	hgraph_connect(graph, mid_out, hgraph_get_pin_id(graph, branch, &plugin1_end_in_i32));
+	hgraph_index_t lone = hgraph_create_node(graph, &plugin1_start);
+
+	hgraph_index_t max_nodes = hgraph_get_config(graph).max_nodes;
+	float* costs = arena_alloc(&fixture.base.arena, sizeof(float) * max_nodes);
+	costs[start] = 1.f;
+	costs[mid] = 2.f;
+	costs[end] = 3.f;
+	costs[branch] = 1.f;
+	costs[lone] = 1.f;
+
+	hgraph_analysis_t* analysis = analyze(graph, costs);
+	ASSERT_EQ(analysis->num_nodes, 5);
+	ASSERT_EQ(analysis->num_levels, 3);
+	ASSERT_EQ(analysis->max_width, 2);
+	ASSERT_EQ(analysis->total_cost, 8.f);
+	ASSERT_EQ(analysis->critical_path_cost, 6.f);
+
+	ASSERT_EQ(analysis->levels[branch], 2);
+	ASSERT_EQ(analysis->levels[lone], 0);
+	ASSERT_EQ(analysis->finish_times[mid], 3.f);
+	ASSERT_EQ(analysis->finish_times[branch], 4.f);
+
+	ASSERT_EQ(analysis->critical_path_length, 3);
+	ASSERT_EQ(analysis->critical_path[0], start);
+	ASSERT_EQ(analysis->critical_path[1], mid);
+	ASSERT_EQ(analysis->critical_path[2], end);
+
+	ASSERT_EQ(analysis->slacks[mid], 0.f);
+	ASSERT_EQ(analysis->slacks[branch], 2.f);
+	ASSERT_EQ(analysis->slacks[lone], 5.f);
+
+	// Making the branch expensive moves the critical path
+	costs[branch] = 10.f;
+	analysis = analyze(graph, costs);
+	ASSERT_EQ(analysis->critical_path_cost, 13.f);
+	ASSERT_EQ(analysis->critical_path[2], branch);
+	ASSERT_EQ(analysis->slacks[end], 7.f);
+}
@@ -0,0 +1,86 @@
+// Timings which are too noisy and slow for the unit tests, run by hand
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+#include <stdio.h>
+#include <time.h>
+
+static double
+elapsed_ns(const struct timespec* start) {
+	struct timespec end;
+	timespec_get(&end, TIME_UTC);
+	return (double)(end.tv_sec - start->tv_sec) * 1e9 + (double)(end.tv_nsec - start->tv_nsec);
+}
+
+static bool
+sum_edge(hgraph_index_t edge, hgraph_index_t from_pin, hgraph_index_t to_pin, void* userdata) {
+	*(int64_t*)userdata += edge + from_pin + to_pin;
+	return true;
+}
+
+static void
+bench_edge_cursor(hgraph_t* graph) {
+	const int num_iterations = 100000;
+	struct timespec start;
+
+	int64_t callback_sum = 0;
+	timespec_get(&start, TIME_UTC);
+	for (int i = 0; i < num_iterations; ++i) {
+		hgraph_iterate_edges(graph, sum_edge, &callback_sum);
+	}
+	double callback_ns = elapsed_ns(&start);
+
+	int64_t cursor_sum = 0;
+	timespec_get(&start, TIME_UTC);
+	for (int i = 0; i < num_iterations; ++i) {
+		hgraph_edge_cursor_t cursor = hgraph_edge_cursor(graph);
+		hgraph_index_t edge, from_pin, to_pin;
+		while (hgraph_edge_cursor_next(&cursor, &edge, &from_pin, &to_pin)) {
+			cursor_sum += edge + from_pin + to_pin;
+		}
+	}
+	double cursor_ns = elapsed_ns(&start);
+
+	// Keep both loops from being optimized away
+	double num_edges = (double)hgraph_get_info(graph).num_edges * num_iterations;
+	printf(
+		"edges: callback %.2f ns/edge, cursor %.2f ns/edge (%s)\n",
+		callback_ns / num_edges,
+		cursor_ns / num_edges,
+		cursor_sum == callback_sum ? "same sum" : "different sum"
+	);
+}
+
+int
+main(int argc, const char* argv[]) {
+	(void)argc;
+	(void)argv;
+
+	fixture_t fixture;
+	fixture_init(&fixture);
+	hgraph_t* graph = fixture.graph;
+	create_start_mid_end_graph(graph);
+
+	// Fan out from start so output pins have several edges
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	for (int i = 0; i < 8; ++i) {
+		hgraph_index_t mid = hgraph_create_node(graph, &plugin2_mid);
+		hgraph_index_t end = hgraph_create_node(graph, &plugin1_end);
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, start, &plugin1_start_out_f32),
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_in_f32)
+		);
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32),
+			hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+		);
+	}
+
+	bench_edge_cursor(graph);
+
+	fixture_cleanup(&fixture);
+	return 0;
+}
@@ -0,0 +1,155 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+
+static fixture_t fixture;
+
+typedef struct {
+	hgraph_index_t count;
+	hgraph_index_t ids[64];
+	hgraph_index_t from_pins[64];
+	hgraph_index_t to_pins[64];
+} collected_t;
+
+static bool
+collect_node(hgraph_index_t node, const hgraph_node_type_t* node_type, void* userdata) {
+	(void)node_type;
+	collected_t* collected = userdata;
+	collected->ids[collected->count++] = node;
+	return true;
+}
+
+static bool
+collect_edge(hgraph_index_t edge, hgraph_index_t from_pin, hgraph_index_t to_pin, void* userdata) {
+	collected_t* collected = userdata;
+	collected->ids[collected->count] = edge;
+	collected->from_pins[collected->count] = from_pin;
+	collected->to_pins[collected->count] = to_pin;
+	++collected->count;
+	return true;
+}
+
+static collected_t
+collect_cursor(hgraph_edge_cursor_t cursor) {
+	collected_t collected = { 0 };
+	hgraph_index_t edge, from_pin, to_pin;
+	while (hgraph_edge_cursor_next(&cursor, &edge, &from_pin, &to_pin)) {
+		collect_edge(edge, from_pin, to_pin, &collected);
+	}
+	return collected;
+}
+
+static void
+assert_same_edges(const collected_t* lhs, const collected_t* rhs) {
+	ASSERT_EQ(lhs->count, rhs->count);
+	for (hgraph_index_t i = 0; i < lhs->count; ++i) {
+		ASSERT_EQ(lhs->ids[i], rhs->ids[i]);
+		ASSERT_EQ(lhs->from_pins[i], rhs->from_pins[i]);
+		ASSERT_EQ(lhs->to_pins[i], rhs->to_pins[i]);
+	}
+}
+
+TEST_SETUP(cursor) {
+	fixture_init(&fixture);
+	hgraph_t* graph = fixture.graph;
+	create_start_mid_end_graph(graph);
+
+	// Fan out from start so output pins have several edges
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	for (int i = 0; i < 8; ++i) {
+		hgraph_index_t mid = hgraph_create_node(graph, &plugin2_mid);
+		hgraph_index_t end = hgraph_create_node(graph, &plugin1_end);
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, start, &plugin1_start_out_f32),
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_in_f32)
+		);
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32),
+			hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+		);
+	}
+	// Leave holes in the id space
+	hgraph_destroy_node(graph, hgraph_get_node_by_name(graph, HGRAPH_STR("end")));
+}
+
+TEST_TEARDOWN(cursor) {
+	fixture_cleanup(&fixture);
+}
+
+TEST(cursor, nodes) {
+	hgraph_t* graph = fixture.graph;
+
+	collected_t expected = { 0 };
+	hgraph_iterate_nodes(graph, collect_node, &expected);
+
+	collected_t actual = { 0 };
+	hgraph_node_cursor_t cursor = hgraph_node_cursor(graph);
+	hgraph_index_t node;
+	while (hgraph_node_cursor_next(&cursor, &node)) {
+		collect_node(node, NULL, &actual);
+	}
+
+	ASSERT_EQ(actual.count, 18);
+	ASSERT_EQ(actual.count, expected.count);
+	for (hgraph_index_t i = 0; i < actual.count; ++i) {
+		ASSERT_EQ(actual.ids[i], expected.ids[i]);
+	}
+}
+
+TEST(cursor, edges) {
+	hgraph_t* graph = fixture.graph;
+
+	collected_t expected = { 0 };
+	hgraph_iterate_edges(graph, collect_edge, &expected);
+	collected_t actual = collect_cursor(hgraph_edge_cursor(graph));
+	ASSERT_EQ(actual.count, 17);
+	assert_same_edges(&actual, &expected);
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	expected = (collected_t){ 0 };
+	hgraph_iterate_edges_from(graph, start, collect_edge, &expected);
+	actual = collect_cursor(hgraph_edge_cursor_from(graph, start));
+	ASSERT_EQ(actual.count, 9);
+	assert_same_edges(&actual, &expected);
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	expected = (collected_t){ 0 };
+	hgraph_iterate_edges_to(graph, mid, collect_edge, &expected);
+	actual = collect_cursor(hgraph_edge_cursor_to(graph, mid));
+	ASSERT_EQ(actual.count, 1);
+	assert_same_edges(&actual, &expected);
+
+	// mid lost its only outgoing edge with end
+	actual = collect_cursor(hgraph_edge_cursor_from(graph, mid));
+	ASSERT_EQ(actual.count, 0);
+
+	// Unknown nodes yield nothing
+	actual = collect_cursor(hgraph_edge_cursor_to(graph, 31));
+	ASSERT_EQ(actual.count, 0);
+}
+
+static bool
+sum_edge(hgraph_index_t edge, hgraph_index_t from_pin, hgraph_index_t to_pin, void* userdata) {
+	*(int64_t*)userdata += edge + from_pin + to_pin;
+	return true;
+}
+
+TEST(cursor, same_as_callback) {
+	hgraph_t* graph = fixture.graph;
+
+	int64_t callback_sum = 0;
+	hgraph_iterate_edges(graph, sum_edge, &callback_sum);
+
+	int64_t cursor_sum = 0;
+	hgraph_edge_cursor_t cursor = hgraph_edge_cursor(graph);
+	hgraph_index_t edge, from_pin, to_pin;
+	while (hgraph_edge_cursor_next(&cursor, &edge, &from_pin, &to_pin)) {
+		cursor_sum += edge + from_pin + to_pin;
+	}
+
+	ASSERT_EQ(cursor_sum, callback_sum);
+}
@@ -0,0 +1,178 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+#include <hgraph/stream.h>
+#include <hgraph/io.h>
+
+#define EDITS_FILE_CAPACITY (64 * 1024)
+
+static struct {
+	fixture_t base;
+	hgraph_journal_t* journal;
+	char* file;
+	size_t file_size;
+} fixture;
+
+TEST_SETUP(edits) {
+	fixture_init(&fixture.base);
+	create_start_mid_end_graph(fixture.base.graph);
+
+	hgraph_journal_config_t config = { .max_size = 4096 };
+	size_t mem_required = hgraph_journal_init(NULL, 0, &config);
+	fixture.journal = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_journal_init(fixture.journal, mem_required, &config);
+	hgraph_set_journal(fixture.base.graph, fixture.journal);
+
+	fixture.file = arena_alloc(&fixture.base.arena, EDITS_FILE_CAPACITY);
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(&out_stream, fixture.file, EDITS_FILE_CAPACITY);
+	ASSERT_EQ(hgraph_write_header(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph(fixture.base.graph, out), HGRAPH_IO_OK);
+	fixture.file_size = hgraph_stream_out_size(&out_stream);
+	hgraph_mark_saved(fixture.base.graph);
+}
+
+TEST_TEARDOWN(edits) {
+	fixture_cleanup(&fixture.base);
+}
+
+static void
+append_edits(void) {
+	ASSERT_TRUE(hgraph_can_append_edits(fixture.base.graph));
+
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(
+		&out_stream,
+		fixture.file + fixture.file_size,
+		EDITS_FILE_CAPACITY - fixture.file_size
+	);
+	ASSERT_EQ(hgraph_write_edits(fixture.base.graph, out), HGRAPH_IO_OK);
+	fixture.file_size += hgraph_stream_out_size(&out_stream);
+	hgraph_mark_saved(fixture.base.graph);
+}
+
+static hgraph_t*
+load_file(size_t size) {
+	hgraph_stream_in_t in_stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&in_stream, fixture.file, size);
+
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+	hgraph_config_t graph_config;
+	ASSERT_EQ(hgraph_read_graph_config(&header, &graph_config, in), HGRAPH_IO_OK);
+
+	// Leave room for the nodes created by the edits
+	graph_config = hgraph_get_config(fixture.base.graph);
+	size_t mem_size = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &graph_config);
+	ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+
+	while (hgraph_io_available(in) > 0) {
+		uint64_t segment_size;
+		ASSERT_EQ(hgraph_read_edits_header(&segment_size, in), HGRAPH_IO_OK);
+		// A segment cut short is left out
+		if (segment_size > hgraph_io_available(in)) { break; }
+
+		ASSERT_EQ(hgraph_read_edits(graph, in), HGRAPH_IO_OK);
+	}
+
+	return graph;
+}
+
+TEST(edits, append) {
+	hgraph_t* graph = fixture.base.graph;
+	size_t base_size = fixture.file_size;
+
+	// Nothing changed yet
+	append_edits();
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	bool round_up = !*(const bool*)hgraph_get_node_attribute(graph, mid, &plugin2_mid_attr_round_up);
+	hgraph_set_node_attribute(graph, mid, &plugin2_mid_attr_round_up, &round_up);
+	append_edits();
+	size_t first_save_size = fixture.file_size;
+
+	hgraph_destroy_node(graph, hgraph_get_node_by_name(graph, HGRAPH_STR("end")));
+	hgraph_index_t new_end = hgraph_create_node(graph, &plugin1_end);
+	hgraph_set_node_name(graph, new_end, HGRAPH_STR("new end"));
+	hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32),
+		hgraph_get_pin_id(graph, new_end, &plugin1_end_in_i32)
+	);
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("middle"));
+	append_edits();
+
+	// The edits are much smaller than the graph
+	ASSERT_TRUE(first_save_size - base_size < base_size);
+
+	hgraph_t* loaded = load_file(fixture.file_size);
+	ASSERT_EQ(hgraph_get_digest(loaded), hgraph_get_digest(graph));
+	ASSERT_EQ(hgraph_get_info(loaded).num_nodes, 3);
+	ASSERT_EQ(hgraph_get_info(loaded).num_edges, 2);
+	ASSERT_EQ(hgraph_get_node_by_name(loaded, HGRAPH_STR("new end")), new_end);
+	ASSERT_EQ(hgraph_get_node_by_name(loaded, HGRAPH_STR("middle")), mid);
+	const bool* loaded_round_up = hgraph_get_node_attribute(loaded, mid, &plugin2_mid_attr_round_up);
+	ASSERT_EQ(*loaded_round_up, round_up);
+
+	// A crash while appending loses the last save only
+	loaded = load_file(fixture.file_size - 1);
+	ASSERT_EQ(hgraph_get_info(loaded).num_nodes, 3);
+	ASSERT_EQ(hgraph_get_node_by_name(loaded, HGRAPH_STR("mid")), mid);
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(hgraph_get_node_by_name(loaded, HGRAPH_STR("end"))));
+}
+
+TEST(edits, undo_past_save) {
+	hgraph_t* graph = fixture.base.graph;
+	uint64_t saved_digest = hgraph_get_digest(graph);
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_destroy_node(graph, mid);
+	hgraph_create_node(graph, &plugin1_start);
+	append_edits();
+
+	// Going back before the save reverts the saved edits
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_digest(graph), saved_digest);
+	append_edits();
+
+	hgraph_t* loaded = load_file(fixture.file_size);
+	ASSERT_EQ(hgraph_get_digest(loaded), saved_digest);
+	ASSERT_EQ(hgraph_get_node_by_name(loaded, HGRAPH_STR("mid")), mid);
+	ASSERT_EQ(hgraph_get_info(loaded).num_edges, 2);
+
+	// And coming back reapplies them
+	ASSERT_TRUE(hgraph_redo(graph));
+	append_edits();
+	loaded = load_file(fixture.file_size);
+	ASSERT_EQ(hgraph_get_digest(loaded), hgraph_get_digest(graph));
+}
+
+TEST(edits, lost_history) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_create_node(graph, &plugin1_start);
+	append_edits();
+
+	// Undoing past the save and then editing drops the saved steps
+	ASSERT_TRUE(hgraph_undo(graph));
+	hgraph_create_node(graph, &plugin1_end);
+	ASSERT_FALSE(hgraph_can_append_edits(graph));
+
+	hgraph_out_t* out;
+	hgraph_stream_out_t out_stream;
+	char buffer[64];
+	out = hgraph_stream_out_init_mem(&out_stream, buffer, sizeof(buffer));
+	ASSERT_EQ(hgraph_write_edits(graph, out), HGRAPH_IO_ERROR);
+
+	// Until the graph is saved whole again
+	hgraph_mark_saved(graph);
+	ASSERT_TRUE(hgraph_can_append_edits(graph));
+
+	// There is nothing to append without a journal
+	hgraph_set_journal(graph, NULL);
+	ASSERT_FALSE(hgraph_can_append_edits(graph));
+}
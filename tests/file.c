@@ -0,0 +1,198 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include <hgraph/runtime.h>
+#include <hgraph/stream.h>
+#include <hgraph/file.h>
+#include <hgraph/io.h>
+#include <string.h>
+
+static struct {
+	fixture_t base;
+	char data[4096];
+	size_t size;
+	size_t unindexed_size;
+} fixture;
+
+TEST_SETUP(file) {
+	fixture_init(&fixture.base);
+	create_start_mid_end_graph(fixture.base.graph);
+
+	hgraph_t* graph = fixture.base.graph;
+	float value = 4.5f;
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &value);
+
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(&out_stream, fixture.data, sizeof(fixture.data));
+	ASSERT_EQ(hgraph_write_header(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph(graph, out), HGRAPH_IO_OK);
+	fixture.unindexed_size = hgraph_stream_out_size(&out_stream);
+	ASSERT_EQ(hgraph_write_graph_index(graph, out), HGRAPH_IO_OK);
+	fixture.size = hgraph_stream_out_size(&out_stream);
+}
+
+TEST_TEARDOWN(file) {
+	fixture_cleanup(&fixture.base);
+}
+
+static hgraph_t*
+create_graph_for_file(const hgraph_file_t* file) {
+	hgraph_config_t config;
+	ASSERT_EQ(hgraph_file_get_config(file, &config), HGRAPH_IO_OK);
+	config.registry = fixture.base.registry;
+
+	size_t mem_size = hgraph_init(NULL, 0, &config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &config);
+	return graph;
+}
+
+TEST(file, metadata) {
+	hgraph_file_t file;
+	ASSERT_EQ(hgraph_file_open(&file, fixture.data, fixture.size), HGRAPH_IO_OK);
+
+	hgraph_file_info_t info = hgraph_file_get_info(&file);
+	ASSERT_EQ(info.num_groups, 3);
+	ASSERT_EQ(info.num_nodes, 3);
+	ASSERT_EQ(info.num_edges, 2);
+
+	int num_names_found = 0;
+	for (hgraph_index_t i = 0; i < info.num_groups; ++i) {
+		hgraph_file_group_t group;
+		ASSERT_EQ(hgraph_file_get_group(&file, i, &group), HGRAPH_IO_OK);
+		ASSERT_EQ(group.num_nodes, 1);
+
+		hgraph_file_node_t node;
+		ASSERT_EQ(hgraph_file_get_node(&file, i, 0, &node), HGRAPH_IO_OK);
+		hgraph_str_t name = hgraph_get_node_name(fixture.base.graph, node.id);
+		ASSERT_EQ(name.length, node.name.length);
+		ASSERT_TRUE(memcmp(name.data, node.name.data, (size_t)name.length) == 0);
+		++num_names_found;
+
+		ASSERT_EQ(hgraph_file_get_node(&file, i, 1, &node), HGRAPH_IO_ERROR);
+	}
+	ASSERT_EQ(num_names_found, 3);
+
+	hgraph_file_group_t group;
+	ASSERT_EQ(hgraph_file_get_group(&file, info.num_groups, &group), HGRAPH_IO_ERROR);
+}
+
+TEST(file, load_subset) {
+	hgraph_file_t file;
+	ASSERT_EQ(hgraph_file_open(&file, fixture.data, fixture.size), HGRAPH_IO_OK);
+	hgraph_t* graph = create_graph_for_file(&file);
+
+	// Load everything but the end node
+	for (hgraph_index_t i = 0; i < hgraph_file_get_info(&file).num_groups; ++i) {
+		hgraph_file_node_t node;
+		ASSERT_EQ(hgraph_file_get_node(&file, i, 0, &node), HGRAPH_IO_OK);
+		if (node.name.length == 3 && memcmp(node.name.data, "end", 3) == 0) { continue; }
+
+		hgraph_index_t node_id;
+		ASSERT_EQ(hgraph_file_load_node(&file, graph, i, 0, &node_id), HGRAPH_IO_OK);
+		ASSERT_EQ(node_id, node.id);
+	}
+	ASSERT_EQ(hgraph_file_load_edges(&file, graph), HGRAPH_IO_OK);
+
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 2);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 1);
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(start));
+	const float* value = hgraph_get_node_attribute(graph, start, &plugin1_start_attr_f32);
+	ASSERT_TRUE(*value == 4.5f);
+	ASSERT_FALSE(HGRAPH_IS_VALID_INDEX(hgraph_get_node_by_name(graph, HGRAPH_STR("end"))));
+}
+
+TEST(file, load_all) {
+	hgraph_file_t file;
+	ASSERT_EQ(hgraph_file_open(&file, fixture.data, fixture.size), HGRAPH_IO_OK);
+	hgraph_t* graph = create_graph_for_file(&file);
+
+	for (hgraph_index_t i = 0; i < hgraph_file_get_info(&file).num_groups; ++i) {
+		hgraph_index_t node_id;
+		ASSERT_EQ(hgraph_file_load_node(&file, graph, i, 0, &node_id), HGRAPH_IO_OK);
+	}
+	ASSERT_EQ(hgraph_file_load_edges(&file, graph), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(fixture.base.graph));
+}
+
+TEST(file, sequential_read) {
+	// Readers which do not use the index stop before it
+	hgraph_stream_in_t in_stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&in_stream, fixture.data, fixture.size);
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+	hgraph_config_t config;
+	ASSERT_EQ(hgraph_read_graph_config(&header, &config, in), HGRAPH_IO_OK);
+	config.registry = fixture.base.registry;
+
+	size_t mem_size = hgraph_init(NULL, 0, &config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &config);
+	ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(fixture.base.graph));
+	ASSERT_EQ(hgraph_io_available(in), fixture.size - fixture.unindexed_size);
+}
+
+TEST(file, no_index) {
+	hgraph_file_t file;
+	ASSERT_EQ(hgraph_file_open(&file, fixture.data, fixture.unindexed_size), HGRAPH_IO_MALFORMED);
+	ASSERT_EQ(hgraph_file_open(&file, fixture.data, fixture.size - 1), HGRAPH_IO_MALFORMED);
+}
+
+static void
+parallel_for_reversed(
+	void (*task)(void* task_data, hgraph_index_t index),
+	void* task_data,
+	hgraph_index_t num_tasks,
+	void* userdata
+) {
+	hgraph_index_t* num_calls = userdata;
+	// Tasks must not depend on running in order
+	for (hgraph_index_t i = num_tasks - 1; i >= 0; --i) {
+		task(task_data, i);
+		++*num_calls;
+	}
+}
+
+TEST(file, read_parallel) {
+	hgraph_config_t config = {
+		.registry = fixture.base.registry,
+		.max_nodes = 256,
+		.max_name_length = 64,
+	};
+	size_t mem_size = hgraph_init(NULL, 0, &config);
+	hgraph_t* source = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(source, mem_size, &config);
+	create_start_mid_end_graph(source);
+
+	// Enough nodes of a type to be split into several tasks
+	for (int i = 0; i < 150; ++i) {
+		hgraph_index_t node = hgraph_create_node(source, &plugin1_start);
+		float value = (float)i;
+		hgraph_set_node_attribute(source, node, &plugin1_start_attr_f32, &value);
+	}
+
+	static char data[64 * 1024];
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(&out_stream, data, sizeof(data));
+	ASSERT_EQ(hgraph_write_header(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph(source, out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph_index(source, out), HGRAPH_IO_OK);
+
+	hgraph_file_t file;
+	ASSERT_EQ(hgraph_file_open(&file, data, hgraph_stream_out_size(&out_stream)), HGRAPH_IO_OK);
+	hgraph_t* graph = create_graph_for_file(&file);
+
+	hgraph_index_t num_calls = 0;
+	ASSERT_EQ(
+		hgraph_read_graph_parallel(&file, graph, parallel_for_reversed, &num_calls),
+		HGRAPH_IO_OK
+	);
+	ASSERT_EQ(num_calls, 5);
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, hgraph_get_info(source).num_nodes);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 2);
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(source));
+}
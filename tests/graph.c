@@ -2,7 +2,13 @@
 #include "common.h"
 #include "plugin1.h"
 #include "plugin2.h"
+#include "data.h"
 #include <hgraph/runtime.h>
+#include <hgraph/io.h>
+#include <threads.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
 
 typedef struct {
 	hgraph_index_t num_nodes;
@@ -365,6 +371,237 @@ TEST(graph, name) {
 	);
 }
 
+TEST(graph, name_interning) {
+	hgraph_config_t graph_config = {
+		.registry = fixture.registry,
+		.max_nodes = 8,
+		.max_name_length = 255,
+		.name_storage_size = 128,
+	};
+	size_t mem_required = hgraph_init(NULL, 0, &graph_config);
+	graph_config.name_storage_size = 0;
+	ASSERT_TRUE(mem_required < hgraph_init(NULL, 0, &graph_config));
+	graph_config.name_storage_size = 128;
+
+	hgraph_t* graph = arena_alloc(&fixture.arena, mem_required);
+	hgraph_init(graph, mem_required, &graph_config);
+	ASSERT_EQ(hgraph_get_config(graph).name_storage_size, 128);
+
+	hgraph_index_t a = hgraph_create_node(graph, &plugin1_start);
+	hgraph_index_t b = hgraph_create_node(graph, &plugin1_start);
+	hgraph_index_t c = hgraph_create_node(graph, &plugin1_start);
+
+	// Unnamed nodes still have a null terminated name
+	hgraph_str_t name_c = hgraph_get_node_name(graph, c);
+	ASSERT_EQ(name_c.length, 0);
+	ASSERT_EQ(name_c.data[0], '\0');
+
+	// Identical names are stored once
+	ASSERT_TRUE(hgraph_set_node_name(graph, a, HGRAPH_STR("shared")));
+	ASSERT_TRUE(hgraph_set_node_name(graph, b, hgraph_get_node_name(graph, a)));
+	ASSERT_TRUE(hgraph_get_node_name(graph, a).data == hgraph_get_node_name(graph, b).data);
+
+	// Too long for the storage
+	char long_name[200];
+	memset(long_name, 'x', sizeof(long_name));
+	ASSERT_FALSE(hgraph_set_node_name(
+		graph, c, (hgraph_str_t){ .data = long_name, .length = sizeof(long_name) }
+	));
+	ASSERT_EQ(hgraph_get_node_name(graph, c).length, 0);
+
+	// Dead names are reclaimed when the storage is full
+	for (int i = 0; i < 100; ++i) {
+		char name[16];
+		int length = snprintf(name, sizeof(name), "name%d", i);
+		ASSERT_TRUE(hgraph_set_node_name(
+			graph, c, (hgraph_str_t){ .data = name, .length = length }
+		));
+	}
+	hgraph_str_t name_a = hgraph_get_node_name(graph, a);
+	name_c = hgraph_get_node_name(graph, c);
+	ASSERT_EQ(name_a.length, 6);
+	ASSERT_EQ(memcmp(name_a.data, "shared", 6), 0);
+	ASSERT_EQ(name_c.length, 6);
+	ASSERT_EQ(memcmp(name_c.data, "name99", 7), 0);
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("name99")), c);
+	ASSERT_FALSE(HGRAPH_IS_VALID_INDEX(
+		hgraph_get_node_by_name(graph, HGRAPH_STR("name98"))
+	));
+
+	// Destroying a node releases its name
+	hgraph_destroy_node(graph, a);
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("shared")), b);
+	hgraph_destroy_node(graph, b);
+	ASSERT_FALSE(HGRAPH_IS_VALID_INDEX(
+		hgraph_get_node_by_name(graph, HGRAPH_STR("shared"))
+	));
+	ASSERT_TRUE(hgraph_set_node_name(
+		graph, c, (hgraph_str_t){ .data = long_name, .length = 80 }
+	));
+}
+
+TEST(graph, name_storage_default) {
+	hgraph_config_t graph_config = {
+		.registry = fixture.registry,
+		.max_nodes = 1024,
+		.max_name_length = 31,
+	};
+	size_t short_names_size = hgraph_init(NULL, 0, &graph_config);
+
+	// Raising the limit only makes room for one more long name
+	graph_config.max_name_length = 4096;
+	size_t long_names_size = hgraph_init(NULL, 0, &graph_config);
+	ASSERT_TRUE(long_names_size - short_names_size <= 4096 + 64);
+
+	size_t mem_required = long_names_size;
+	hgraph_t* graph = arena_alloc(&fixture.arena, mem_required);
+	hgraph_init(graph, mem_required, &graph_config);
+
+	// Which is enough to rename a node with it over and over
+	char long_name[4096];
+	hgraph_index_t node = hgraph_create_node(graph, &plugin1_start);
+	for (int i = 0; i < 4; ++i) {
+		memset(long_name, 'a' + i, sizeof(long_name));
+		ASSERT_TRUE(hgraph_set_node_name(
+			graph, node, (hgraph_str_t){ .data = long_name, .length = sizeof(long_name) }
+		));
+	}
+	ASSERT_EQ(hgraph_get_node_name(graph, node).data[0], 'd');
+}
+
+TEST(graph, digest) {
+	hgraph_t* graph = fixture.graph;
+	ASSERT_EQ(hgraph_get_digest(graph), 0);
+
+	create_start_mid_end_graph(graph);
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+	uint64_t digest = hgraph_get_digest(graph);
+	uint64_t end_hash = hgraph_get_node_hash(graph, end);
+	ASSERT_NE(digest, 0);
+	ASSERT_EQ(
+		hgraph_get_node_hash(graph, start)
+		+ hgraph_get_node_hash(graph, mid)
+		+ end_hash,
+		digest
+	);
+
+	// Reverting a change restores the digest
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("other"));
+	ASSERT_NE(hgraph_get_digest(graph), digest);
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("mid"));
+	ASSERT_EQ(hgraph_get_digest(graph), digest);
+
+	float value = 2.f;
+	const float* old_value = hgraph_get_node_attribute(graph, start, &plugin1_start_attr_f32);
+	float saved_value = *old_value;
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &value);
+	ASSERT_NE(hgraph_get_digest(graph), digest);
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &saved_value);
+	ASSERT_EQ(hgraph_get_digest(graph), digest);
+
+	// Edges are covered by the node they lead to
+	hgraph_index_t mid_out = hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32);
+	hgraph_index_t other_end = hgraph_create_node(graph, &plugin1_end);
+	hgraph_index_t edge = hgraph_connect(
+		graph, mid_out, hgraph_get_pin_id(graph, other_end, &plugin1_end_in_i32)
+	);
+	ASSERT_EQ(hgraph_get_node_hash(graph, end), end_hash);
+	hgraph_disconnect(graph, edge);
+	hgraph_destroy_node(graph, other_end);
+	ASSERT_EQ(hgraph_get_digest(graph), digest);
+	ASSERT_EQ(hgraph_get_node_hash(graph, other_end), 0);
+
+	// Copies and graphs built the same way match
+	size_t mem_required = hgraph_copy(NULL, 0, graph);
+	hgraph_t* copy = arena_alloc(&fixture.arena, mem_required);
+	hgraph_copy(copy, mem_required, graph);
+	ASSERT_EQ(hgraph_get_digest(copy), digest);
+
+	hgraph_config_t config = hgraph_get_config(graph);
+	mem_required = hgraph_init(NULL, 0, &config);
+	hgraph_t* rebuilt = arena_alloc(&fixture.arena, mem_required);
+	hgraph_init(rebuilt, mem_required, &config);
+	create_start_mid_end_graph(rebuilt);
+	ASSERT_EQ(hgraph_get_digest(rebuilt), digest);
+}
+
+typedef struct {
+	char str[8];
+} label_t;
+
+static hgraph_io_status_t
+write_label(const void* value, hgraph_out_t* out) {
+	const label_t* label = value;
+	return hgraph_io_write_str(
+		(hgraph_str_t){ .data = label->str, .length = strlen(label->str) }, out
+	);
+}
+
+static hgraph_io_status_t
+read_label(void* value, hgraph_in_t* in) {
+	label_t* label = value;
+	size_t len = sizeof(label->str) - 1;
+	return hgraph_io_read_str(label->str, &len, in);
+}
+
+static const hgraph_data_type_t label_type = {
+	.name = HGRAPH_STR("label"),
+	.size = sizeof(label_t),
+	.alignment = _Alignof(label_t),
+	.serialize = write_label,
+	.deserialize = read_label,
+};
+
+static const hgraph_attribute_description_t labelled_attr = {
+	.name = HGRAPH_STR("label"),
+	.data_type = &label_type,
+};
+
+static const hgraph_node_type_t labelled = {
+	.name = HGRAPH_STR("labelled"),
+	.attributes = HGRAPH_NODE_ATTRIBUTES(&labelled_attr),
+};
+
+TEST(graph, digest_serialized) {
+	hgraph_registry_config_t reg_config = {
+		.max_data_types = 1,
+		.max_node_types = 1,
+	};
+	size_t mem_required = hgraph_registry_builder_init(NULL, 0, &reg_config);
+	hgraph_registry_builder_t* builder = arena_alloc(&fixture.arena, mem_required);
+	hgraph_registry_builder_init(builder, mem_required, &reg_config);
+	hgraph_registry_builder_add(builder, &labelled);
+
+	mem_required = hgraph_registry_init(NULL, 0, builder);
+	hgraph_registry_t* registry = arena_alloc(&fixture.arena, mem_required);
+	hgraph_registry_init(registry, mem_required, builder);
+
+	hgraph_config_t graph_config = {
+		.registry = registry,
+		.max_nodes = 1,
+		.max_name_length = 8,
+	};
+	mem_required = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.arena, mem_required);
+	hgraph_init(graph, mem_required, &graph_config);
+	hgraph_index_t node = hgraph_create_node(graph, &labelled);
+
+	label_t label = { .str = "ab" };
+	hgraph_set_node_attribute(graph, node, &labelled_attr, &label);
+	uint64_t digest = hgraph_get_digest(graph);
+
+	// Bytes after the terminator are not saved so they are not hashed either
+	memcpy(label.str, "ab\0stale", sizeof(label.str));
+	hgraph_set_node_attribute(graph, node, &labelled_attr, &label);
+	ASSERT_EQ(hgraph_get_digest(graph), digest);
+
+	memcpy(label.str, "ac", 3);
+	hgraph_set_node_attribute(graph, node, &labelled_attr, &label);
+	ASSERT_NE(hgraph_get_digest(graph), digest);
+}
+
 TEST(graph, attribute) {
 	hgraph_t* graph = fixture.graph;
 	hgraph_index_t node = hgraph_create_node(graph, &plugin2_mid);
@@ -381,3 +618,499 @@ TEST(graph, attribute) {
 	);
 	ASSERT_FALSE(*round_up);
 }
+
+TEST(graph, attribute_bulk) {
+	hgraph_t* graph = fixture.graph;
+
+	// Mixed types, one of which does not have the attribute
+	hgraph_index_t nodes[6];
+	for (int i = 0; i < 6; ++i) {
+		nodes[i] = hgraph_create_node(graph, i == 3 ? &plugin1_start : &plugin2_mid);
+	}
+
+	ASSERT_EQ(
+		hgraph_set_attribute_bulk(
+			graph, &plugin2_mid_attr_round_up, nodes, &(bool){ false }, 0, 6
+		),
+		5
+	);
+
+	bool values[6] = { true, true, true, true, true, true };
+	ASSERT_EQ(
+		hgraph_get_attribute_bulk(
+			graph, &plugin2_mid_attr_round_up, nodes, values, sizeof(bool), 6
+		),
+		5
+	);
+	for (int i = 0; i < 6; ++i) {
+		ASSERT_EQ(values[i], i == 3);
+	}
+
+	// Per node values
+	struct { float pad; bool round_up; } per_node[6];
+	for (int i = 0; i < 6; ++i) {
+		per_node[i].round_up = i % 2 == 0;
+	}
+	hgraph_set_attribute_bulk(
+		graph,
+		&plugin2_mid_attr_round_up,
+		nodes,
+		&per_node[0].round_up,
+		sizeof(per_node[0]),
+		6
+	);
+	for (int i = 0; i < 6; ++i) {
+		if (i == 3) { continue; }
+
+		const bool* round_up = hgraph_get_node_attribute(
+			graph, nodes[i], &plugin2_mid_attr_round_up
+		);
+		ASSERT_EQ(*round_up, i % 2 == 0);
+	}
+
+	// A bulk write is undone at once, even right after a write to one of its
+	// nodes
+	hgraph_journal_config_t journal_config = { .max_size = 4096 };
+	size_t mem_required = hgraph_journal_init(NULL, 0, &journal_config);
+	hgraph_journal_t* journal = arena_alloc(&fixture.arena, mem_required);
+	hgraph_journal_init(journal, mem_required, &journal_config);
+	hgraph_set_journal(graph, journal);
+
+	hgraph_set_node_attribute(graph, nodes[0], &plugin2_mid_attr_round_up, &(bool){ false });
+	hgraph_set_attribute_bulk(
+		graph, &plugin2_mid_attr_round_up, nodes, &(bool){ true }, 0, 6
+	);
+	ASSERT_TRUE(hgraph_undo(graph));
+	for (int i = 0; i < 6; ++i) {
+		if (i == 3) { continue; }
+
+		const bool* round_up = hgraph_get_node_attribute(
+			graph, nodes[i], &plugin2_mid_attr_round_up
+		);
+		ASSERT_EQ(*round_up, i != 0 && i % 2 == 0);
+	}
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_TRUE(*(const bool*)hgraph_get_node_attribute(
+		graph, nodes[0], &plugin2_mid_attr_round_up
+	));
+	ASSERT_FALSE(hgraph_undo(graph));
+	hgraph_set_journal(graph, NULL);
+}
+
+TEST(graph, copy) {
+	hgraph_t* graph = fixture.graph;
+	create_start_mid_end_graph(graph);
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+
+	size_t mem_required = hgraph_copy(NULL, 0, graph);
+	hgraph_t* copy = arena_alloc(&fixture.arena, mem_required);
+	ASSERT_EQ(hgraph_copy(copy, mem_required, graph), mem_required);
+
+	// The copy does not share any memory with the original
+	memset(graph, 0xcd, mem_required);
+
+	hgraph_info_t info = hgraph_get_info(copy);
+	ASSERT_EQ(info.num_nodes, 3);
+	ASSERT_EQ(info.num_edges, 2);
+	ASSERT_EQ(hgraph_get_node_by_name(copy, HGRAPH_STR("mid")), mid);
+	ASSERT_TRUE(
+		hgraph_is_pin_connected(
+			copy,
+			hgraph_get_pin_id(copy, mid, &plugin2_mid_in_f32)
+		)
+	);
+
+	hgraph_destroy_node(copy, start);
+	ASSERT_EQ(hgraph_get_info(copy).num_edges, 1);
+	hgraph_index_t node = hgraph_create_node(copy, &plugin1_start);
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(node));
+	ASSERT_TRUE(
+		HGRAPH_IS_VALID_INDEX(
+			hgraph_connect(
+				copy,
+				hgraph_get_pin_id(copy, node, &plugin1_start_out_f32),
+				hgraph_get_pin_id(copy, mid, &plugin2_mid_in_f32)
+			)
+		)
+	);
+}
+
+static bool
+collect_topological_order(
+	hgraph_index_t node,
+	const hgraph_node_type_t* node_type,
+	void* userdata
+) {
+	(void)node_type;
+	hgraph_index_t* positions = userdata;
+	hgraph_index_t position = positions[0]++;
+	positions[1 + node] = position;
+	return true;
+}
+
+TEST(graph, topological_order) {
+	hgraph_t* graph = fixture.graph;
+
+	// Create in reverse so that connecting has to reorder
+	hgraph_index_t end = hgraph_create_node(graph, &plugin1_end);
+	hgraph_index_t mid = hgraph_create_node(graph, &plugin2_mid);
+	hgraph_index_t start = hgraph_create_node(graph, &plugin1_start);
+
+	hgraph_index_t positions[1 + 32] = { 0 };
+	hgraph_iterate_nodes_topological(graph, collect_topological_order, positions);
+	ASSERT_EQ(positions[0], 3);
+	ASSERT_TRUE(positions[1 + end] < positions[1 + start]);
+
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32),
+			hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+		)
+	));
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, start, &plugin1_start_out_f32),
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_in_f32)
+		)
+	));
+
+	positions[0] = 0;
+	hgraph_iterate_nodes_topological(graph, collect_topological_order, positions);
+	ASSERT_EQ(positions[0], 3);
+	ASSERT_TRUE(positions[1 + start] < positions[1 + mid]);
+	ASSERT_TRUE(positions[1 + mid] < positions[1 + end]);
+
+	// Gaps left by destroyed nodes are skipped
+	hgraph_destroy_node(graph, mid);
+	positions[0] = 0;
+	hgraph_iterate_nodes_topological(graph, collect_topological_order, positions);
+	ASSERT_EQ(positions[0], 2);
+}
+
+TEST(graph, defragment) {
+	hgraph_t* graph = fixture.graph;
+
+	// Slots end up in reverse topological order
+	hgraph_index_t lone = hgraph_create_node(graph, &plugin1_end);
+	hgraph_index_t end = hgraph_create_node(graph, &plugin1_end);
+	hgraph_index_t mid = hgraph_create_node(graph, &plugin2_mid);
+	hgraph_index_t start = hgraph_create_node(graph, &plugin1_start);
+	hgraph_set_node_name(graph, end, HGRAPH_STR("end"));
+	hgraph_set_node_name(graph, start, HGRAPH_STR("start"));
+	hgraph_index_t mid_end = hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32),
+		hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+	);
+	hgraph_index_t start_mid = hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, start, &plugin1_start_out_f32),
+		hgraph_get_pin_id(graph, mid, &plugin2_mid_in_f32)
+	);
+	// Leave a gap in the order
+	hgraph_destroy_node(graph, lone);
+
+	ASSERT_TRUE(hgraph_defragment(graph) > 0);
+
+	// Slot order now matches topological order
+	hgraph_index_t positions[1 + 32] = { 0 };
+	hgraph_iterate_nodes_topological(graph, collect_topological_order, positions);
+	hgraph_node_cursor_t cursor = hgraph_node_cursor(graph);
+	hgraph_index_t node_id;
+	hgraph_index_t num_nodes = 0;
+	while (hgraph_node_cursor_next(&cursor, &node_id)) {
+		ASSERT_EQ(positions[1 + node_id], num_nodes);
+		++num_nodes;
+	}
+	ASSERT_EQ(num_nodes, 3);
+
+	// Ids, names and edges are unchanged
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("start")), start);
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("end")), end);
+	ASSERT_TRUE(hgraph_get_node_type(graph, mid) == &plugin2_mid);
+	ASSERT_TRUE(hgraph_get_node_type(graph, lone) == NULL);
+	iterator_state state = {
+		.start_mid_id = start_mid,
+		.mid_end_id = mid_end,
+	};
+	hgraph_iterate_edges(graph, iterate_edges, &state);
+	ASSERT_EQ(state.num_edges, 2);
+	ASSERT_TRUE(state.seen_start_mid);
+	ASSERT_TRUE(state.seen_mid_end);
+	ASSERT_TRUE(hgraph_is_pin_connected(
+		graph, hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+	));
+
+	// Already in order
+	ASSERT_EQ(hgraph_defragment(graph), 0);
+}
+
+static const hgraph_pin_description_t relay_in = {
+	.name = HGRAPH_STR("in"),
+	.data_type = &test_f32,
+};
+
+static const hgraph_pin_description_t relay_out = {
+	.name = HGRAPH_STR("out"),
+	.data_type = &test_f32,
+};
+
+static const hgraph_node_type_t relay = {
+	.name = HGRAPH_STR("relay"),
+	.input_pins = HGRAPH_NODE_PINS(&relay_in),
+	.output_pins = HGRAPH_NODE_PINS(&relay_out),
+};
+
+TEST(graph, reject_cycle) {
+	// None of the test plugins can form a cycle so build a separate registry
+	hgraph_registry_config_t reg_config = {
+		.max_data_types = 32,
+		.max_node_types = 32,
+	};
+	size_t mem_required = hgraph_registry_builder_init(NULL, 0, &reg_config);
+	hgraph_registry_builder_t* builder = arena_alloc(&fixture.arena, mem_required);
+	hgraph_registry_builder_init(builder, mem_required, &reg_config);
+	hgraph_registry_builder_add(builder, &relay);
+
+	mem_required = hgraph_registry_init(NULL, 0, builder);
+	hgraph_registry_t* registry = arena_alloc(&fixture.arena, mem_required);
+	hgraph_registry_init(registry, mem_required, builder);
+
+	hgraph_config_t graph_config = {
+		.registry = registry,
+		.max_nodes = 8,
+		.max_name_length = 8,
+	};
+	mem_required = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.arena, mem_required);
+	hgraph_init(graph, mem_required, &graph_config);
+
+	// |a| -> |b| -> |c| -> |d|, created in reverse
+	hgraph_index_t nodes[4];
+	for (int i = 3; i >= 0; --i) {
+		nodes[i] = hgraph_create_node(graph, &relay);
+	}
+	hgraph_index_t edges[3];
+	for (int i = 0; i < 3; ++i) {
+		edges[i] = hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, nodes[i], &relay_out),
+			hgraph_get_pin_id(graph, nodes[i + 1], &relay_in)
+		);
+		ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(edges[i]));
+	}
+
+	hgraph_index_t positions[1 + 8] = { 0 };
+	hgraph_iterate_nodes_topological(graph, collect_topological_order, positions);
+	ASSERT_EQ(positions[0], 4);
+	for (int i = 0; i < 3; ++i) {
+		ASSERT_TRUE(positions[1 + nodes[i]] < positions[1 + nodes[i + 1]]);
+	}
+
+	// |d| -> |a| closes the loop
+	hgraph_index_t d_out = hgraph_get_pin_id(graph, nodes[3], &relay_out);
+	hgraph_index_t a_in = hgraph_get_pin_id(graph, nodes[0], &relay_in);
+	ASSERT_FALSE(hgraph_can_connect(graph, d_out, a_in));
+	ASSERT_FALSE(HGRAPH_IS_VALID_INDEX(hgraph_connect(graph, d_out, a_in)));
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 3);
+
+	// Breaking |b| -> |c| allows it: |c| -> |d| -> |a| -> |b|
+	hgraph_disconnect(graph, edges[1]);
+	ASSERT_TRUE(hgraph_can_connect(graph, d_out, a_in));
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(hgraph_connect(graph, d_out, a_in)));
+
+	positions[0] = 0;
+	hgraph_iterate_nodes_topological(graph, collect_topological_order, positions);
+	ASSERT_TRUE(positions[1 + nodes[2]] < positions[1 + nodes[3]]);
+	ASSERT_TRUE(positions[1 + nodes[3]] < positions[1 + nodes[0]]);
+	ASSERT_TRUE(positions[1 + nodes[0]] < positions[1 + nodes[1]]);
+}
+
+typedef struct {
+	hgraph_index_t num_nodes;
+	hgraph_index_t node_ids[32];
+	const hgraph_node_type_t* expected_type;
+} type_query_state;
+
+static bool
+collect_nodes_of_type(
+	hgraph_index_t node,
+	const hgraph_node_type_t* node_type,
+	void* userdata
+) {
+	type_query_state* state = userdata;
+	ASSERT_TRUE(node_type == state->expected_type);
+	state->node_ids[state->num_nodes++] = node;
+	return true;
+}
+
+static bool
+contains_node(const type_query_state* state, hgraph_index_t node) {
+	for (hgraph_index_t i = 0; i < state->num_nodes; ++i) {
+		if (state->node_ids[i] == node) { return true; }
+	}
+	return false;
+}
+
+TEST(graph, iterate_nodes_of_type) {
+	hgraph_t* graph = fixture.graph;
+
+	hgraph_index_t starts[4];
+	hgraph_index_t ends[3];
+	for (int i = 0; i < 4; ++i) {
+		starts[i] = hgraph_create_node(graph, &plugin1_start);
+		if (i < 3) { ends[i] = hgraph_create_node(graph, &plugin1_end); }
+	}
+
+	type_query_state state = { .expected_type = &plugin1_start };
+	hgraph_iterate_nodes_of_type(graph, &plugin1_start, collect_nodes_of_type, &state);
+	ASSERT_EQ(state.num_nodes, 4);
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(contains_node(&state, starts[i]));
+	}
+
+	state = (type_query_state){ .expected_type = &plugin2_mid };
+	hgraph_iterate_nodes_of_type(graph, &plugin2_mid, collect_nodes_of_type, &state);
+	ASSERT_EQ(state.num_nodes, 0);
+
+	// Remove from the head, the middle and the tail
+	hgraph_destroy_node(graph, starts[3]);
+	hgraph_destroy_node(graph, starts[1]);
+	hgraph_destroy_node(graph, starts[0]);
+	hgraph_destroy_node(graph, ends[1]);
+
+	state = (type_query_state){ .expected_type = &plugin1_start };
+	hgraph_iterate_nodes_of_type(graph, &plugin1_start, collect_nodes_of_type, &state);
+	ASSERT_EQ(state.num_nodes, 1);
+	ASSERT_EQ(state.node_ids[0], starts[2]);
+
+	state = (type_query_state){ .expected_type = &plugin1_end };
+	hgraph_iterate_nodes_of_type(graph, &plugin1_end, collect_nodes_of_type, &state);
+	ASSERT_EQ(state.num_nodes, 2);
+	ASSERT_TRUE(contains_node(&state, ends[0]));
+	ASSERT_TRUE(contains_node(&state, ends[2]));
+
+	// Reused ids join the list again
+	hgraph_index_t start = hgraph_create_node(graph, &plugin1_start);
+	state = (type_query_state){ .expected_type = &plugin1_start };
+	hgraph_iterate_nodes_of_type(graph, &plugin1_start, collect_nodes_of_type, &state);
+	ASSERT_EQ(state.num_nodes, 2);
+	ASSERT_TRUE(contains_node(&state, start));
+}
+
+TEST(graph, read_validate) {
+	hgraph_t* graph = fixture.graph;
+
+	uint32_t sequence = hgraph_read_begin(graph);
+	ASSERT_TRUE(hgraph_read_validate(graph, sequence));
+	hgraph_get_info(graph);
+	ASSERT_TRUE(hgraph_read_validate(graph, sequence));
+
+	hgraph_create_node(graph, &plugin1_start);
+	ASSERT_FALSE(hgraph_read_validate(graph, sequence));
+
+	sequence = hgraph_read_begin(graph);
+	ASSERT_TRUE(hgraph_read_validate(graph, sequence));
+}
+
+typedef struct {
+	hgraph_t* graph;
+	atomic_bool stop;
+} writer_state;
+
+static int
+replace_mid_node(void* userdata) {
+	writer_state* state = userdata;
+	hgraph_t* graph = state->graph;
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+
+	while (!atomic_load(&state->stop)) {
+		hgraph_destroy_node(graph, hgraph_get_node_by_name(graph, HGRAPH_STR("mid")));
+
+		hgraph_index_t mid = hgraph_create_node(graph, &plugin2_mid);
+		hgraph_set_node_name(graph, mid, HGRAPH_STR("mid"));
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, start, &plugin1_start_out_f32),
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_in_f32)
+		);
+		hgraph_connect(
+			graph,
+			hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32),
+			hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+		);
+		thrd_yield();
+	}
+
+	return 0;
+}
+
+typedef struct {
+	hgraph_index_t num_nodes;
+	hgraph_index_t num_edges;
+	hgraph_index_t node_ids[32];
+	hgraph_index_t edge_pins[64];
+} read_state;
+
+static bool
+read_node(hgraph_index_t node, const hgraph_node_type_t* node_type, void* userdata) {
+	(void)node_type;
+	read_state* state = userdata;
+	state->node_ids[state->num_nodes++] = node;
+	return true;
+}
+
+static bool
+read_edge(hgraph_index_t edge, hgraph_index_t from_pin, hgraph_index_t to_pin, void* userdata) {
+	(void)edge;
+	read_state* state = userdata;
+	state->edge_pins[state->num_edges * 2 + 0] = from_pin;
+	state->edge_pins[state->num_edges * 2 + 1] = to_pin;
+	++state->num_edges;
+	return true;
+}
+
+static bool
+has_node(const read_state* state, hgraph_index_t pin) {
+	for (hgraph_index_t i = 0; i < state->num_nodes; ++i) {
+		if (state->node_ids[i] == pin >> 8) { return true; }
+	}
+	return false;
+}
+
+TEST(graph, concurrent_read) {
+	hgraph_t* graph = fixture.graph;
+	create_start_mid_end_graph(graph);
+	void* scratch = arena_alloc(&fixture.arena, hgraph_read_scratch_size(graph));
+
+	writer_state writer = { .graph = graph };
+	thrd_t thread;
+	ASSERT_EQ(thrd_create(&thread, replace_mid_node, &writer), thrd_success);
+
+	for (int i = 0; i < 500; ++i) {
+		read_state state;
+		uint32_t sequence;
+		do {
+			sequence = hgraph_read_begin(graph);
+			state.num_nodes = 0;
+			state.num_edges = 0;
+			hgraph_iterate_nodes_consistent(graph, scratch, read_node, &state);
+			hgraph_iterate_edges_consistent(graph, scratch, read_edge, &state);
+		} while (!hgraph_read_validate(graph, sequence));
+
+		// Every edge is between nodes from the same version
+		ASSERT_TRUE(state.num_nodes == 2 || state.num_nodes == 3);
+		ASSERT_TRUE(state.num_edges <= 2);
+		for (hgraph_index_t j = 0; j < state.num_edges; ++j) {
+			ASSERT_TRUE(has_node(&state, state.edge_pins[j * 2 + 0]));
+			ASSERT_TRUE(has_node(&state, state.edge_pins[j * 2 + 1]));
+		}
+	}
+
+	atomic_store(&writer.stop, true);
+	thrd_join(thread, NULL);
+}
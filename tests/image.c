@@ -0,0 +1,115 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+#include <hgraph/stream.h>
+#include <hgraph/io.h>
+
+static struct {
+	fixture_t base;
+	char* image;
+	size_t image_size;
+} fixture;
+
+TEST_SETUP(image) {
+	fixture_init(&fixture.base);
+	create_start_mid_end_graph(fixture.base.graph);
+
+	size_t capacity = 64 * 1024;
+	fixture.image = arena_alloc(&fixture.base.arena, capacity);
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(&out_stream, fixture.image, capacity);
+	ASSERT_EQ(hgraph_write_image(fixture.base.graph, out), HGRAPH_IO_OK);
+	fixture.image_size = hgraph_stream_out_size(&out_stream);
+}
+
+TEST_TEARDOWN(image) {
+	fixture_cleanup(&fixture.base);
+}
+
+TEST(image, map) {
+	hgraph_t* graph = hgraph_map_graph(fixture.image, fixture.image_size, fixture.base.registry);
+	ASSERT_TRUE(graph != NULL);
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(fixture.base.graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 3);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 2);
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(mid));
+	ASSERT_TRUE(hgraph_get_node_type(graph, mid) == &plugin2_mid);
+
+	// The mapped graph is a regular graph
+	hgraph_destroy_node(graph, mid);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 0);
+	ASSERT_EQ(hgraph_get_info(fixture.base.graph).num_edges, 2);
+
+	// Truncated images are rejected
+	ASSERT_TRUE(hgraph_map_graph(fixture.image, 32, fixture.base.registry) == NULL);
+}
+
+TEST(image, fallback) {
+	// Same types registered in another order
+	hgraph_registry_config_t registry_config = {
+		.max_data_types = 32,
+		.max_node_types = 32,
+	};
+	size_t mem_size = hgraph_registry_builder_init(NULL, 0, &registry_config);
+	hgraph_registry_builder_t* builder = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_registry_builder_init(builder, mem_size, &registry_config);
+	hgraph_plugin_api_t* plugin_api = hgraph_registry_builder_as_plugin_api(builder);
+	plugin2_entry(plugin_api);
+	plugin1_entry(plugin_api);
+	mem_size = hgraph_registry_init(NULL, 0, builder);
+	hgraph_registry_t* registry = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_registry_init(registry, mem_size, builder);
+
+	ASSERT_TRUE(
+		hgraph_registry_info(registry).fingerprint
+		!= hgraph_registry_info(fixture.base.registry).fingerprint
+	);
+	ASSERT_TRUE(hgraph_map_graph(fixture.image, fixture.image_size, registry) == NULL);
+
+	const void* file;
+	size_t file_size;
+	ASSERT_TRUE(hgraph_get_image_fallback(fixture.image, fixture.image_size, &file, &file_size));
+
+	hgraph_stream_in_t in_stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&in_stream, file, file_size);
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+	hgraph_config_t graph_config;
+	ASSERT_EQ(hgraph_read_graph_config(&header, &graph_config, in), HGRAPH_IO_OK);
+	graph_config.registry = registry;
+
+	mem_size = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &graph_config);
+	ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 3);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 2);
+	ASSERT_EQ(hgraph_io_available(in), 0);
+}
+
+TEST(image, bad_header) {
+	// Only the header, with sizes which do not leave room for a graph
+	size_t size = 64 + 16;
+	char* image = arena_alloc(&fixture.base.arena, size);
+	memcpy(image, fixture.image, size);
+
+	uint64_t graph_size = 0;
+	uint64_t fallback_offset = 32;
+	memcpy(image + 16, &graph_size, sizeof(graph_size));
+	memcpy(image + 24, &fallback_offset, sizeof(fallback_offset));
+	ASSERT_TRUE(hgraph_map_graph(image, size, fixture.base.registry) == NULL);
+
+	const void* file;
+	size_t file_size;
+	ASSERT_FALSE(hgraph_get_image_fallback(image, size, &file, &file_size));
+
+	graph_size = 16;
+	fallback_offset = size;
+	memcpy(image + 16, &graph_size, sizeof(graph_size));
+	memcpy(image + 24, &fallback_offset, sizeof(fallback_offset));
+	ASSERT_TRUE(hgraph_map_graph(image, size, fixture.base.registry) == NULL);
+}
@@ -1,8 +1,11 @@
 #include "hgraph/runtime.h"
 #include "rktest.h"
 #include "common.h"
+#include "plugin1.h"
+#include "data.h"
 #include "../hgraph/src/internal.h"
 #include <hgraph/io.h>
+#include <hgraph/stream.h>
 #include <stdint.h>
 
 typedef struct {
@@ -54,6 +57,38 @@ read_slip(void* value, hgraph_in_t* in) {
 	return HGRAPH_IO_OK;
 }
 
+// Long runs of plain bytes broken up by bytes which must be escaped
+static void
+fill_blob(uint8_t* blob, size_t size) {
+	for (size_t i = 0; i < size; ++i) {
+		blob[i] = (uint8_t)(i % 97 == 0 ? 0xc0 : i % 89 == 0 ? 0xdb : i);
+	}
+}
+
+static hgraph_io_status_t
+write_blob(const void* value, hgraph_out_t* out) {
+	(void)value;
+	uint8_t blob[600];
+	fill_blob(blob, sizeof(blob));
+
+	return hgraph_io_write(out, blob, sizeof(blob));
+}
+
+static hgraph_io_status_t
+read_blob(void* value, hgraph_in_t* in) {
+	(void)value;
+	uint8_t expected[600];
+	fill_blob(expected, sizeof(expected));
+
+	// Read in uneven pieces
+	uint8_t blob[sizeof(expected)];
+	HGRAPH_CHECK_IO(hgraph_io_read(in, blob, 13));
+	HGRAPH_CHECK_IO(hgraph_io_read(in, blob + 13, sizeof(blob) - 13));
+	ASSERT_EQ(memcmp(blob, expected, sizeof(blob)), 0);
+
+	return HGRAPH_IO_OK;
+}
+
 static struct {
 	fixture_t base;
 	memory_io mem_io;
@@ -102,6 +137,7 @@ TEST(io, read_write_same) {
 	hgraph_info_t graph_info = hgraph_get_info(graph);
 	ASSERT_EQ(graph_info.num_nodes, 3);
 	ASSERT_EQ(graph_info.num_edges, 2);
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(fixture.base.graph));
 }
 
 TEST(io, slip) {
@@ -163,3 +199,283 @@ TEST(io, slip) {
 	hgraph_info_t graph_info = hgraph_get_info(graph);
 	ASSERT_EQ(graph_info.num_nodes, 1);
 }
+
+TEST(io, unknown_attribute) {
+	hgraph_data_type_t blob_data = {
+		.serialize = write_blob,
+		.deserialize = read_blob,
+	};
+
+	hgraph_attribute_description_t blob_attr = {
+		.name = HGRAPH_STR("blob"),
+		.data_type = &blob_data,
+	};
+
+	hgraph_attribute_description_t skipped_attr = {
+		.name = HGRAPH_STR("skipped"),
+		.data_type = &blob_data,
+	};
+
+	hgraph_node_type_t write_node_type = {
+		.name = HGRAPH_STR("blob_test"),
+		.attributes = HGRAPH_NODE_ATTRIBUTES(&skipped_attr, &blob_attr),
+	};
+
+	// The skipped attribute no longer exists when reading
+	hgraph_node_type_t read_node_type = {
+		.name = HGRAPH_STR("blob_test"),
+		.attributes = HGRAPH_NODE_ATTRIBUTES(&blob_attr),
+	};
+
+	hgraph_registry_config_t registry_config = {
+		.max_data_types = 1,
+		.max_node_types = 1,
+	};
+	hgraph_registry_t* registries[2];
+	hgraph_node_type_t* node_types[2] = { &write_node_type, &read_node_type };
+	for (int i = 0; i < 2; ++i) {
+		size_t mem_size = hgraph_registry_builder_init(NULL, 0, &registry_config);
+		hgraph_registry_builder_t* builder = arena_alloc(&fixture.base.arena, mem_size);
+		hgraph_registry_builder_init(builder, mem_size, &registry_config);
+
+		hgraph_registry_builder_add(builder, node_types[i]);
+		mem_size = hgraph_registry_init(NULL, 0, builder);
+		registries[i] = arena_alloc(&fixture.base.arena, mem_size);
+		hgraph_registry_init(registries[i], mem_size, builder);
+	}
+
+	hgraph_config_t graph_config = {
+		.max_name_length = 1,
+		.max_nodes = 1,
+		.registry = registries[0],
+	};
+	size_t mem_size = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &graph_config);
+	hgraph_create_node(graph, &write_node_type);
+
+	char* data = fixture.mem_io.start;
+	size_t data_size = (size_t)(fixture.mem_io.end - fixture.mem_io.start);
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(&out_stream, data, data_size);
+	ASSERT_EQ(hgraph_write_header(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph(graph, out), HGRAPH_IO_OK);
+
+	hgraph_stream_in_t in_stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&in_stream, data, hgraph_stream_out_size(&out_stream));
+
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_read_graph_config(&header, &graph_config, in), HGRAPH_IO_OK);
+	graph_config.registry = registries[1];
+
+	mem_size = hgraph_init(NULL, 0, &graph_config);
+	graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &graph_config);
+	ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_io_available(in), 0);
+
+	hgraph_info_t graph_info = hgraph_get_info(graph);
+	ASSERT_EQ(graph_info.num_nodes, 1);
+}
+
+TEST(io, read_v1) {
+	// The start -> mid -> end graph written in version 1
+	static const uint8_t v1_file[] = {
+		0x48, 0x45, 0x44, 0x01, 0x03, 0x05, 0x03, 0x05, 0x73, 0x74, 0x61, 0x72,
+		0x74, 0x05, 0x73, 0x74, 0x61, 0x72, 0x74, 0x01, 0x03, 0x66, 0x33, 0x32,
+		0x07, 0x6e, 0x75, 0x6d, 0x5f, 0x66, 0x33, 0x32, 0x00, 0x00, 0x00, 0x00,
+		0xc0, 0x03, 0x6d, 0x69, 0x64, 0x03, 0x6d, 0x69, 0x64, 0x01, 0x04, 0x62,
+		0x6f, 0x6f, 0x6c, 0x08, 0x72, 0x6f, 0x75, 0x6e, 0x64, 0x5f, 0x75, 0x70,
+		0x31, 0xc0, 0x03, 0x65, 0x6e, 0x64, 0x03, 0x65, 0x6e, 0x64, 0x00, 0x02,
+		0x00, 0x0b, 0x6e, 0x75, 0x6d, 0x5f, 0x6f, 0x75, 0x74, 0x5f, 0x66, 0x33,
+		0x32, 0x01, 0x0a, 0x6e, 0x75, 0x6d, 0x5f, 0x69, 0x6e, 0x5f, 0x66, 0x33,
+		0x32, 0x01, 0x0b, 0x6e, 0x75, 0x6d, 0x5f, 0x6f, 0x75, 0x74, 0x5f, 0x69,
+		0x33, 0x32, 0x02, 0x0a, 0x6e, 0x75, 0x6d, 0x5f, 0x69, 0x6e, 0x5f, 0x69,
+		0x33, 0x32,
+	};
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&stream, v1_file, sizeof(v1_file));
+
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+	ASSERT_EQ(header.version, 1);
+
+	hgraph_config_t graph_config;
+	ASSERT_EQ(hgraph_read_graph_config(&header, &graph_config, in), HGRAPH_IO_OK);
+	graph_config.registry = fixture.base.registry;
+
+	size_t mem_size = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &graph_config);
+	ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_io_available(in), 0);
+
+	hgraph_info_t graph_info = hgraph_get_info(graph);
+	ASSERT_EQ(graph_info.num_nodes, 3);
+	ASSERT_EQ(graph_info.num_edges, 2);
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(hgraph_get_node_by_name(graph, HGRAPH_STR("mid"))));
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(fixture.base.graph));
+}
+
+TEST(io, read_v1_cycle) {
+	hgraph_pin_description_t relay_in = {
+		.name = HGRAPH_STR("in"),
+		.data_type = &test_f32,
+	};
+	hgraph_pin_description_t relay_out = {
+		.name = HGRAPH_STR("out"),
+		.data_type = &test_f32,
+	};
+	hgraph_node_type_t relay = {
+		.name = HGRAPH_STR("relay"),
+		.input_pins = HGRAPH_NODE_PINS(&relay_in),
+		.output_pins = HGRAPH_NODE_PINS(&relay_out),
+	};
+
+	hgraph_registry_config_t registry_config = {
+		.max_data_types = 1,
+		.max_node_types = 1,
+	};
+	size_t mem_size = hgraph_registry_builder_init(NULL, 0, &registry_config);
+	hgraph_registry_builder_t* builder = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_registry_builder_init(builder, mem_size, &registry_config);
+
+	hgraph_registry_builder_add(builder, &relay);
+	mem_size = hgraph_registry_init(NULL, 0, builder);
+	hgraph_registry_t* registry = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_registry_init(registry, mem_size, builder);
+
+	// |a| -> |b| -> |a| written in version 1, before cycles were rejected
+	uint8_t v1_file[] = {
+		0x48, 0x45, 0x44, 0x01, 0x02, 0x01, 0x02, 0x05, 0x72, 0x65, 0x6c, 0x61,
+		0x79, 0x01, 0x61, 0x00, 0x05, 0x72, 0x65, 0x6c, 0x61, 0x79, 0x01, 0x62,
+		0x00, 0x02, 0x00, 0x03, 0x6f, 0x75, 0x74, 0x01, 0x02, 0x69, 0x6e, 0x01,
+		0x03, 0x6f, 0x75, 0x74, 0x00, 0x02, 0x69, 0x6e,
+	};
+	const size_t num_edges_offset = 25;
+	const size_t edge_size = 9;
+
+	for (uint8_t num_edges = 1; num_edges <= 2; ++num_edges) {
+		v1_file[num_edges_offset] = num_edges;
+		size_t file_size = sizeof(v1_file) - (2 - num_edges) * edge_size;
+
+		hgraph_stream_in_t stream;
+		hgraph_in_t* in = hgraph_stream_in_init_mem(&stream, v1_file, file_size);
+
+		hgraph_header_t header;
+		ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+		hgraph_config_t graph_config;
+		ASSERT_EQ(hgraph_read_graph_config(&header, &graph_config, in), HGRAPH_IO_OK);
+		graph_config.registry = registry;
+
+		mem_size = hgraph_init(NULL, 0, &graph_config);
+		hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+		hgraph_init(graph, mem_size, &graph_config);
+
+		if (num_edges == 1) {
+			ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+			ASSERT_EQ(hgraph_get_info(graph).num_edges, 1);
+		} else {
+			// Dropping the edge would lose it on the next save
+			ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_MALFORMED);
+		}
+	}
+}
+
+TEST(io, sparse_ids) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_destroy_node(graph, start);
+	hgraph_index_t new_start = hgraph_create_node(graph, &plugin1_start);
+	hgraph_set_node_name(graph, new_start, HGRAPH_STR("new_start"));
+
+	memory_io* mem_io = &fixture.mem_io;
+	ASSERT_EQ(hgraph_write_header(&mem_io->out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph(graph, &mem_io->out), HGRAPH_IO_OK);
+	mem_io->end = mem_io->pos;
+	mem_io->pos = mem_io->start;
+
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, &mem_io->in), HGRAPH_IO_OK);
+	hgraph_config_t graph_config;
+	ASSERT_EQ(hgraph_read_graph_config(&header, &graph_config, &mem_io->in), HGRAPH_IO_OK);
+	graph_config.registry = fixture.base.registry;
+
+	size_t mem_size = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* read_graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(read_graph, mem_size, &graph_config);
+	ASSERT_EQ(hgraph_read_graph(&header, read_graph, &mem_io->in), HGRAPH_IO_OK);
+
+	// Ids survive the round trip
+	ASSERT_EQ(hgraph_get_node_by_name(read_graph, HGRAPH_STR("new_start")), new_start);
+	ASSERT_EQ(
+		hgraph_get_node_by_name(read_graph, HGRAPH_STR("end")),
+		hgraph_get_node_by_name(graph, HGRAPH_STR("end"))
+	);
+	ASSERT_EQ(hgraph_get_info(read_graph).num_edges, 1);
+	ASSERT_EQ(hgraph_get_digest(read_graph), hgraph_get_digest(graph));
+}
+
+TEST(io, crc32c) {
+	// The check value of CRC32C
+	ASSERT_TRUE(hgraph_crc32c(0, "123456789", 9) == 0xe3069283);
+	ASSERT_TRUE(hgraph_crc32c(0, NULL, 0) == 0);
+
+	// Chained and unaligned updates give the same result
+	uint8_t data[67];
+	for (size_t i = 0; i < sizeof(data); ++i) {
+		data[i] = (uint8_t)(i * 31 + 7);
+	}
+	uint32_t expected = hgraph_crc32c(0, data, sizeof(data));
+	for (size_t split = 0; split <= sizeof(data); ++split) {
+		uint32_t crc = hgraph_crc32c(0, data, split);
+		crc = hgraph_crc32c(crc, data + split, sizeof(data) - split);
+		ASSERT_TRUE(crc == expected);
+	}
+}
+
+static hgraph_io_status_t
+read_graph_from(const char* data, size_t size) {
+	hgraph_stream_in_t in_stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&in_stream, data, size);
+
+	hgraph_header_t header;
+	HGRAPH_CHECK_IO(hgraph_read_header(&header, in));
+	hgraph_config_t graph_config;
+	HGRAPH_CHECK_IO(hgraph_read_graph_config(&header, &graph_config, in));
+	graph_config.registry = fixture.base.registry;
+	// A corrupted config can ask for anything
+	if (graph_config.max_nodes > 64 || graph_config.max_name_length > 64) {
+		return HGRAPH_IO_MALFORMED;
+	}
+
+	size_t mem_size = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &graph_config);
+	return hgraph_read_graph(&header, graph, in);
+}
+
+TEST(io, checksums) {
+	char data[1024];
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(&out_stream, data, sizeof(data));
+	ASSERT_EQ(hgraph_write_header(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph(fixture.base.graph, out), HGRAPH_IO_OK);
+	size_t size = hgraph_stream_out_size(&out_stream);
+	ASSERT_EQ(read_graph_from(data, size), HGRAPH_IO_OK);
+
+	// Every flipped bit is caught, even where parsing would go on
+	for (size_t i = 4; i < size; ++i) {
+		for (int bit = 0; bit < 8; ++bit) {
+			data[i] ^= (char)(1 << bit);
+			ASSERT_NE(read_graph_from(data, size), HGRAPH_IO_OK);
+			data[i] ^= (char)(1 << bit);
+		}
+	}
+
+	// And so is a truncated file
+	for (size_t i = 4; i < size; ++i) {
+		ASSERT_NE(read_graph_from(data, i), HGRAPH_IO_OK);
+	}
+}
@@ -0,0 +1,286 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+
+static struct {
+	fixture_t base;
+	hgraph_journal_t* journal;
+} fixture;
+
+static hgraph_journal_t*
+create_journal(size_t max_size) {
+	hgraph_journal_config_t config = { .max_size = max_size };
+	size_t mem_required = hgraph_journal_init(NULL, 0, &config);
+	hgraph_journal_t* journal = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_journal_init(journal, mem_required, &config);
+	return journal;
+}
+
+TEST_SETUP(journal) {
+	fixture_init(&fixture.base);
+	create_start_mid_end_graph(fixture.base.graph);
+	fixture.journal = create_journal(4096);
+	hgraph_set_journal(fixture.base.graph, fixture.journal);
+}
+
+TEST_TEARDOWN(journal) {
+	fixture_cleanup(&fixture.base);
+}
+
+TEST(journal, create_node) {
+	hgraph_t* graph = fixture.base.graph;
+
+	ASSERT_FALSE(hgraph_undo(graph));
+
+	hgraph_index_t node = hgraph_create_node(graph, &plugin1_end);
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(node));
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 4);
+
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 3);
+	ASSERT_TRUE(hgraph_get_node_type(graph, node) == NULL);
+	ASSERT_FALSE(hgraph_undo(graph));
+
+	// The node comes back with the same id
+	ASSERT_TRUE(hgraph_redo(graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 4);
+	ASSERT_TRUE(hgraph_get_node_type(graph, node) == &plugin1_end);
+	ASSERT_FALSE(hgraph_redo(graph));
+}
+
+TEST(journal, destroy_node) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+	hgraph_index_t mid_in = hgraph_get_pin_id(graph, mid, &plugin2_mid_in_f32);
+	hgraph_index_t end_in = hgraph_get_pin_id(graph, end, &plugin1_end_in_i32);
+	bool round_up = !*(const bool*)hgraph_get_node_attribute(graph, mid, &plugin2_mid_attr_round_up);
+	hgraph_set_node_attribute(graph, mid, &plugin2_mid_attr_round_up, &round_up);
+
+	hgraph_destroy_node(graph, mid);
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 2);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 0);
+
+	// Undoing restores the node, its attributes and its edges in one step
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 3);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 2);
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("mid")), mid);
+	ASSERT_TRUE(hgraph_get_node_type(graph, mid) == &plugin2_mid);
+	ASSERT_TRUE(hgraph_is_pin_connected(graph, mid_in));
+	ASSERT_TRUE(hgraph_is_pin_connected(graph, end_in));
+	const bool* restored_round_up = hgraph_get_node_attribute(graph, mid, &plugin2_mid_attr_round_up);
+	ASSERT_EQ(*restored_round_up, round_up);
+
+	ASSERT_TRUE(hgraph_redo(graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 2);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 0);
+	ASSERT_TRUE(hgraph_get_node_type(graph, mid) == NULL);
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("start")), start);
+}
+
+TEST(journal, digest) {
+	hgraph_t* graph = fixture.base.graph;
+	uint64_t saved_digest = hgraph_get_digest(graph);
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("renamed"));
+	hgraph_destroy_node(graph, hgraph_get_node_by_name(graph, HGRAPH_STR("end")));
+	ASSERT_NE(hgraph_get_digest(graph), saved_digest);
+
+	// Undoing back to the saved state makes the graph clean again
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_NE(hgraph_get_digest(graph), saved_digest);
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_digest(graph), saved_digest);
+}
+
+TEST(journal, connect) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+	hgraph_index_t mid_out = hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32);
+	hgraph_index_t end_in = hgraph_get_pin_id(graph, end, &plugin1_end_in_i32);
+
+	hgraph_index_t new_end = hgraph_create_node(graph, &plugin1_end);
+	hgraph_index_t new_end_in = hgraph_get_pin_id(graph, new_end, &plugin1_end_in_i32);
+	hgraph_index_t edge = hgraph_connect(graph, mid_out, new_end_in);
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(edge));
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 3);
+
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 2);
+	ASSERT_FALSE(hgraph_is_pin_connected(graph, new_end_in));
+	ASSERT_TRUE(hgraph_is_pin_connected(graph, end_in));
+
+	ASSERT_TRUE(hgraph_redo(graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 3);
+	ASSERT_TRUE(hgraph_is_pin_connected(graph, new_end_in));
+
+	hgraph_disconnect(graph, edge);
+	ASSERT_FALSE(hgraph_is_pin_connected(graph, new_end_in));
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_TRUE(hgraph_is_pin_connected(graph, new_end_in));
+}
+
+TEST(journal, set_name) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("middle"));
+
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("mid")), mid);
+	ASSERT_FALSE(HGRAPH_IS_VALID_INDEX(hgraph_get_node_by_name(graph, HGRAPH_STR("middle"))));
+
+	ASSERT_TRUE(hgraph_redo(graph));
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("middle")), mid);
+}
+
+TEST(journal, set_attribute) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	const float* value = hgraph_get_node_attribute(graph, start, &plugin1_start_attr_f32);
+	const bool* round_up = hgraph_get_node_attribute(graph, mid, &plugin2_mid_attr_round_up);
+	float initial_value = *value;
+	bool initial_round_up = *round_up;
+
+	// Consecutive writes to the same attribute are merged
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 1.f });
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 2.f });
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 3.f });
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(*value, initial_value);
+	ASSERT_TRUE(hgraph_redo(graph));
+	ASSERT_EQ(*value, 3.f);
+
+	// But not after an undo or across different attributes
+	ASSERT_TRUE(hgraph_undo(graph));
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 4.f });
+	hgraph_set_node_attribute(graph, mid, &plugin2_mid_attr_round_up, &(bool){ !initial_round_up });
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 5.f });
+
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(*value, 4.f);
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(*round_up, initial_round_up);
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(*value, initial_value);
+	ASSERT_FALSE(hgraph_undo(graph));
+}
+
+TEST(journal, set_attribute_group) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	const float* value = hgraph_get_node_attribute(graph, start, &plugin1_start_attr_f32);
+	const bool* round_up = hgraph_get_node_attribute(graph, mid, &plugin2_mid_attr_round_up);
+	float initial_value = *value;
+	bool initial_round_up = *round_up;
+
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 1.f });
+
+	// A group starting with the same attribute is still a step of its own
+	hgraph_begin_edit(graph);
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 2.f });
+	hgraph_set_node_attribute(graph, mid, &plugin2_mid_attr_round_up, &(bool){ !initial_round_up });
+	hgraph_end_edit(graph);
+
+	// Nor is a single write merged into the group
+	hgraph_set_node_attribute(graph, mid, &plugin2_mid_attr_round_up, &(bool){ initial_round_up });
+
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(*round_up, !initial_round_up);
+	ASSERT_EQ(*value, 2.f);
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(*value, 1.f);
+	ASSERT_EQ(*round_up, initial_round_up);
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(*value, initial_value);
+	ASSERT_FALSE(hgraph_undo(graph));
+}
+
+TEST(journal, edit_group) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_begin_edit(graph);
+	hgraph_index_t node = hgraph_create_node(graph, &plugin1_end);
+	hgraph_set_node_name(graph, node, HGRAPH_STR("end2"));
+	hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, mid, &plugin2_mid_out_i32),
+		hgraph_get_pin_id(graph, node, &plugin1_end_in_i32)
+	);
+	// Undo is not allowed in the middle of an edit
+	ASSERT_FALSE(hgraph_undo(graph));
+	hgraph_end_edit(graph);
+
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 4);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 3);
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_info(graph).num_nodes, 3);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 2);
+	ASSERT_FALSE(hgraph_undo(graph));
+
+	ASSERT_TRUE(hgraph_redo(graph));
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("end2")), node);
+	ASSERT_EQ(hgraph_get_info(graph).num_edges, 3);
+}
+
+TEST(journal, truncate_redo) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("a"));
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("b"));
+	ASSERT_TRUE(hgraph_undo(graph));
+
+	// A new edit discards what can be redone
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("c"));
+	ASSERT_FALSE(hgraph_redo(graph));
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("a")), mid);
+	ASSERT_TRUE(hgraph_undo(graph));
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("mid")), mid);
+}
+
+TEST(journal, overflow) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_set_journal(graph, create_journal(256));
+
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	char name[] = "name0";
+	for (int i = 0; i < 10; ++i) {
+		name[4] = (char)('0' + i);
+		hgraph_set_node_name(graph, mid, (hgraph_str_t){ .data = name, .length = 5 });
+	}
+
+	// Only the most recent steps are kept
+	int num_undos = 0;
+	while (hgraph_undo(graph)) { ++num_undos; }
+	ASSERT_TRUE(num_undos > 0);
+	ASSERT_TRUE(num_undos < 10);
+	ASSERT_FALSE(HGRAPH_IS_VALID_INDEX(hgraph_get_node_by_name(graph, HGRAPH_STR("name9"))));
+
+	while (hgraph_redo(graph)) { --num_undos; }
+	ASSERT_EQ(num_undos, 0);
+	ASSERT_EQ(hgraph_get_node_by_name(graph, HGRAPH_STR("name9")), mid);
+
+	// A step that does not fit clears the history
+	hgraph_begin_edit(graph);
+	for (int i = 0; i < 10; ++i) {
+		name[4] = (char)('0' + i);
+		hgraph_set_node_name(graph, mid, (hgraph_str_t){ .data = name, .length = 5 });
+	}
+	hgraph_end_edit(graph);
+	ASSERT_FALSE(hgraph_undo(graph));
+}
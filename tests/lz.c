@@ -0,0 +1,137 @@
+#include "rktest.h"
+#include "common.h"
+#include <hgraph/runtime.h>
+#include <hgraph/stream.h>
+#include <hgraph/lz.h>
+#include <hgraph/io.h>
+#include <stdio.h>
+#include <string.h>
+
+static struct {
+	fixture_t base;
+	char input[20000];
+	char compressed[32768];
+	char output[20000];
+	char block[HGRAPH_LZ_MAX_BLOCK_SIZE];
+} fixture;
+
+TEST_SETUP(lz) {
+	fixture_init(&fixture.base);
+}
+
+TEST_TEARDOWN(lz) {
+	fixture_cleanup(&fixture.base);
+}
+
+static size_t
+compress(const char* data, size_t size, size_t block_size) {
+	hgraph_stream_out_t stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(
+		&stream, fixture.compressed, sizeof(fixture.compressed)
+	);
+	hgraph_lz_out_t lz;
+	hgraph_out_t* lz_out = hgraph_lz_out_init(&lz, out, fixture.block, block_size);
+	ASSERT_EQ(hgraph_io_write(lz_out, data, size), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_lz_finish(&lz), HGRAPH_IO_OK);
+	return hgraph_stream_out_size(&stream);
+}
+
+static void
+check_round_trip(const char* data, size_t size, size_t block_size) {
+	size_t compressed_size = compress(data, size, block_size);
+
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&stream, fixture.compressed, compressed_size);
+	hgraph_lz_in_t lz;
+	hgraph_in_t* lz_in = hgraph_lz_in_init(&lz, in, fixture.block, block_size);
+	ASSERT_EQ(hgraph_io_read(lz_in, fixture.output, size), HGRAPH_IO_OK);
+	ASSERT_TRUE(memcmp(data, fixture.output, size) == 0);
+
+	// The end of the stream is not read past
+	char tmp;
+	ASSERT_EQ(hgraph_io_read(lz_in, &tmp, 1), HGRAPH_IO_ERROR);
+	ASSERT_EQ(hgraph_io_available(in), 0);
+}
+
+TEST(lz, round_trip) {
+	// Repeated paths with a counter
+	size_t size = 0;
+	for (int i = 0; size + 64 < sizeof(fixture.input); ++i) {
+		size += (size_t)snprintf(
+			fixture.input + size, 64, "/assets/textures/material_%d.png;", i % 97
+		);
+	}
+
+	check_round_trip(fixture.input, size, HGRAPH_LZ_MAX_BLOCK_SIZE);
+	ASSERT_TRUE(compress(fixture.input, size, HGRAPH_LZ_MAX_BLOCK_SIZE) < size / 4);
+
+	// Many blocks, with sizes which do not line up with the writes
+	check_round_trip(fixture.input, size, 1000);
+
+	// Runs are encoded as overlapping matches
+	memset(fixture.input, 'a', sizeof(fixture.input));
+	check_round_trip(fixture.input, sizeof(fixture.input), HGRAPH_LZ_MAX_BLOCK_SIZE);
+	ASSERT_TRUE(compress(fixture.input, sizeof(fixture.input), HGRAPH_LZ_MAX_BLOCK_SIZE) < 32);
+
+	// Incompressible data
+	uint32_t state = 12345;
+	for (size_t i = 0; i < sizeof(fixture.input); ++i) {
+		state = state * 1103515245u + 12345u;
+		fixture.input[i] = (char)(state >> 24);
+	}
+	check_round_trip(fixture.input, sizeof(fixture.input), HGRAPH_LZ_MAX_BLOCK_SIZE);
+
+	check_round_trip(fixture.input, 0, HGRAPH_LZ_MAX_BLOCK_SIZE);
+	check_round_trip(fixture.input, 3, HGRAPH_LZ_MAX_BLOCK_SIZE);
+}
+
+TEST(lz, malformed) {
+	// A match reaching before the start of the block
+	const unsigned char data[] = { 8, 0x10, 'a', 2, 0 };
+	hgraph_stream_in_t stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(&stream, data, sizeof(data));
+	hgraph_lz_in_t lz;
+	hgraph_in_t* lz_in = hgraph_lz_in_init(&lz, in, fixture.block, sizeof(fixture.block));
+	char tmp[8];
+	ASSERT_EQ(hgraph_io_read(lz_in, tmp, sizeof(tmp)), HGRAPH_IO_ERROR);
+
+	// A block larger than the buffer
+	const unsigned char large[] = { 0x80, 0x02, 0x00 };
+	in = hgraph_stream_in_init_mem(&stream, large, sizeof(large));
+	lz_in = hgraph_lz_in_init(&lz, in, fixture.block, 100);
+	ASSERT_EQ(hgraph_io_read(lz_in, tmp, sizeof(tmp)), HGRAPH_IO_ERROR);
+}
+
+TEST(lz, graph) {
+	create_start_mid_end_graph(fixture.base.graph);
+
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(
+		&out_stream, fixture.compressed, sizeof(fixture.compressed)
+	);
+	ASSERT_EQ(hgraph_write_compressed_header(out), HGRAPH_IO_OK);
+	hgraph_lz_out_t lz_out;
+	hgraph_out_t* graph_out = hgraph_lz_out_init(&lz_out, out, fixture.block, sizeof(fixture.block));
+	ASSERT_EQ(hgraph_write_graph(fixture.base.graph, graph_out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_lz_finish(&lz_out), HGRAPH_IO_OK);
+
+	hgraph_stream_in_t in_stream;
+	hgraph_in_t* in = hgraph_stream_in_init_mem(
+		&in_stream, fixture.compressed, hgraph_stream_out_size(&out_stream)
+	);
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+	ASSERT_TRUE(header.compressed);
+
+	hgraph_lz_in_t lz_in;
+	in = hgraph_lz_in_init(&lz_in, in, fixture.block, sizeof(fixture.block));
+	hgraph_config_t config;
+	ASSERT_EQ(hgraph_read_graph_config(&header, &config, in), HGRAPH_IO_OK);
+	config.registry = fixture.base.registry;
+
+	size_t mem_size = hgraph_init(NULL, 0, &config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &config);
+	ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(fixture.base.graph));
+}
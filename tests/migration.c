@@ -1,6 +1,7 @@
 #include "rktest.h"
 #include "common.h"
 #include "plugin1.h"
+#include "plugin2.h"
 #include <stdlib.h>
 
 static struct {
@@ -8,6 +9,14 @@ static struct {
 	hgraph_registry_builder_t* builder;
 } fixture;
 
+static bool
+count_nodes(hgraph_index_t node, const hgraph_node_type_t* node_type, void* userdata) {
+	(void)node;
+	(void)node_type;
+	++*(hgraph_index_t*)userdata;
+	return true;
+}
+
 TEST_SETUP(migration) {
 	fixture_init(&fixture.base);
 	create_start_mid_end_graph(fixture.base.graph);
@@ -111,4 +120,51 @@ TEST(migration, identical) {
 		hgraph_get_node_by_name(graph, HGRAPH_STR("end")),
 		hgraph_get_node_by_name(new_graph, HGRAPH_STR("end"))
 	);
+
+	hgraph_index_t num_mids = 0;
+	hgraph_iterate_nodes_of_type(new_graph, &plugin2_mid, count_nodes, &num_mids);
+	ASSERT_EQ(num_mids, 1);
+}
+
+TEST(migration, reordered_types) {
+	// Types are matched by name wherever they are in the new registry
+	hgraph_registry_builder_t* builder = fixture.builder;
+	hgraph_plugin_api_t* plugin_api = hgraph_registry_builder_as_plugin_api(builder);
+	plugin2_entry(plugin_api);
+	plugin1_entry(plugin_api);
+	size_t reg_size = hgraph_registry_init(NULL, 0, builder);
+	hgraph_registry_t* new_reg = arena_alloc(&fixture.base.arena, reg_size);
+	hgraph_registry_init(new_reg, reg_size, builder);
+
+	size_t migration_size = hgraph_migration_init(NULL, 0, fixture.base.registry, new_reg);
+	hgraph_migration_t* migration = arena_alloc(&fixture.base.arena, migration_size);
+	hgraph_migration_init(migration, migration_size, fixture.base.registry, new_reg);
+
+	hgraph_config_t new_graph_config = {
+		.registry = new_reg,
+		.max_nodes = 64,
+		.max_name_length = 64,
+	};
+	size_t new_graph_size = hgraph_init(NULL, 0, &new_graph_config);
+	hgraph_t* new_graph = arena_alloc(&fixture.base.arena, new_graph_size);
+	hgraph_init(new_graph, new_graph_size, &new_graph_config);
+
+	hgraph_migration_execute(migration, fixture.base.graph, new_graph);
+
+	hgraph_info_t new_info = hgraph_get_info(new_graph);
+	ASSERT_EQ(new_info.num_nodes, 3);
+	ASSERT_EQ(new_info.num_edges, 2);
+
+	ASSERT_TRUE(
+		hgraph_get_node_type(new_graph, hgraph_get_node_by_name(new_graph, HGRAPH_STR("start")))
+		== &plugin1_start
+	);
+	ASSERT_TRUE(
+		hgraph_get_node_type(new_graph, hgraph_get_node_by_name(new_graph, HGRAPH_STR("mid")))
+		== &plugin2_mid
+	);
+	ASSERT_TRUE(
+		hgraph_get_node_type(new_graph, hgraph_get_node_by_name(new_graph, HGRAPH_STR("end")))
+		== &plugin1_end
+	);
 }
@@ -3,6 +3,7 @@
 #include "plugin1.h"
 #include "plugin2.h"
 #include "common.h"
+#include "data.h"
 #include <stdlib.h>
 
 static struct {
@@ -98,3 +99,181 @@ TEST(pipeline, transfer) {
 	// Should be 2 even though this instance is only executed once
 	ASSERT_EQ(mid_state->num_executions, 2);
 }
+
+static const hgraph_pin_description_t macro_in_f32 = {
+	.name = HGRAPH_STR("in"),
+	.data_type = &test_f32,
+};
+
+static const hgraph_pin_description_t macro_out_i32 = {
+	.name = HGRAPH_STR("out"),
+	.data_type = &test_i32,
+};
+
+static hgraph_index_t macro_input_pins[1];
+static hgraph_index_t macro_output_pins[1];
+static hgraph_subgraph_t macro_subgraph = {
+	.input_pins = macro_input_pins,
+	.output_pins = macro_output_pins,
+};
+
+static const hgraph_node_type_t macro = {
+	.name = HGRAPH_STR("macro"),
+	.input_pins = HGRAPH_NODE_PINS(&macro_in_f32),
+	.output_pins = HGRAPH_NODE_PINS(&macro_out_i32),
+	.subgraph = &macro_subgraph,
+};
+
+static hgraph_t*
+create_graph(hgraph_registry_t* registry) {
+	hgraph_config_t graph_config = {
+		.registry = registry,
+		.max_nodes = 32,
+		.max_name_length = 64,
+	};
+	size_t mem_required = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_init(graph, mem_required, &graph_config);
+	return graph;
+}
+
+static hgraph_index_t
+create_start_macro_end(hgraph_t* graph, float value) {
+	hgraph_index_t start = hgraph_create_node(graph, &plugin1_start);
+	hgraph_index_t instance = hgraph_create_node(graph, &macro);
+	hgraph_index_t end = hgraph_create_node(graph, &plugin1_end);
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &value);
+	hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, start, &plugin1_start_out_f32),
+		hgraph_get_pin_id(graph, instance, &macro_in_f32)
+	);
+	hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, instance, &macro_out_i32),
+		hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+	);
+	return end;
+}
+
+static hgraph_registry_t*
+create_registry(const hgraph_node_type_t* extra_type) {
+	hgraph_registry_config_t reg_config = {
+		.max_data_types = 32,
+		.max_node_types = 32,
+	};
+	size_t mem_required = hgraph_registry_builder_init(NULL, 0, &reg_config);
+	hgraph_registry_builder_t* builder = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_registry_builder_init(builder, mem_required, &reg_config);
+	hgraph_plugin_api_t* plugin_api = hgraph_registry_builder_as_plugin_api(builder);
+	plugin1_entry(plugin_api);
+	plugin2_entry(plugin_api);
+	hgraph_registry_builder_add(builder, &macro);
+	if (extra_type != NULL) {
+		hgraph_registry_builder_add(builder, extra_type);
+	}
+
+	mem_required = hgraph_registry_init(NULL, 0, builder);
+	hgraph_registry_t* registry = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_registry_init(registry, mem_required, builder);
+	return registry;
+}
+
+TEST(pipeline, subgraph) {
+	hgraph_registry_t* registry = create_registry(NULL);
+
+	// The subgraph is a single mid node rounding down
+	hgraph_t* subgraph = create_graph(registry);
+	hgraph_index_t mid = hgraph_create_node(subgraph, &plugin2_mid);
+	hgraph_set_node_attribute(subgraph, mid, &plugin2_mid_attr_round_up, &(bool){ false });
+	macro_subgraph.graph = subgraph;
+	macro_input_pins[0] = hgraph_get_pin_id(subgraph, mid, &plugin2_mid_in_f32);
+	macro_output_pins[0] = hgraph_get_pin_id(subgraph, mid, &plugin2_mid_out_i32);
+
+	hgraph_t* graph = create_graph(registry);
+	hgraph_index_t end1 = create_start_macro_end(graph, 4.2f);
+	hgraph_index_t end2 = create_start_macro_end(graph, 2.5f);
+
+	hgraph_pipeline_config_t pipeline_config = {
+		.graph = graph,
+		.max_scratch_memory = 4096,
+	};
+	size_t mem_required = hgraph_pipeline_init(NULL, 0, &pipeline_config);
+	hgraph_pipeline_t* pipeline = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_pipeline_init(pipeline, mem_required, &pipeline_config);
+
+	for (int i = 0; i < 2; ++i) {
+		ASSERT_EQ(hgraph_pipeline_execute(pipeline, NULL, NULL), HGRAPH_PIPELINE_EXEC_FINISHED);
+
+		const int32_t* result = hgraph_pipeline_get_node_status(pipeline, end1);
+		ASSERT_TRUE(result != NULL);
+		ASSERT_EQ(*result, 4);
+
+		result = hgraph_pipeline_get_node_status(pipeline, end2);
+		ASSERT_TRUE(result != NULL);
+		ASSERT_EQ(*result, 2);
+	}
+
+	// An unbound output fails the subgraph node
+	macro_output_pins[0] = hgraph_get_pin_id(subgraph, hgraph_create_node(subgraph, &plugin2_mid), &plugin2_mid_out_i32);
+	mem_required = hgraph_pipeline_init(NULL, 0, &pipeline_config);
+	pipeline = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_pipeline_init(pipeline, mem_required, &pipeline_config);
+	ASSERT_EQ(hgraph_pipeline_execute(pipeline, NULL, NULL), HGRAPH_PIPELINE_EXEC_INCOMPLETE_OUTPUT);
+}
+
+static hgraph_index_t outer_macro_input_pins[1];
+static hgraph_index_t outer_macro_output_pins[1];
+static hgraph_subgraph_t outer_macro_subgraph = {
+	.input_pins = outer_macro_input_pins,
+	.output_pins = outer_macro_output_pins,
+};
+
+static const hgraph_node_type_t outer_macro = {
+	.name = HGRAPH_STR("outer_macro"),
+	.input_pins = HGRAPH_NODE_PINS(&macro_in_f32),
+	.output_pins = HGRAPH_NODE_PINS(&macro_out_i32),
+	.subgraph = &outer_macro_subgraph,
+};
+
+TEST(pipeline, nested_subgraph) {
+	hgraph_registry_t* registry = create_registry(&outer_macro);
+
+	hgraph_t* subgraph = create_graph(registry);
+	hgraph_index_t mid = hgraph_create_node(subgraph, &plugin2_mid);
+	macro_subgraph.graph = subgraph;
+	macro_input_pins[0] = hgraph_get_pin_id(subgraph, mid, &plugin2_mid_in_f32);
+	macro_output_pins[0] = hgraph_get_pin_id(subgraph, mid, &plugin2_mid_out_i32);
+
+	// The outer subgraph wraps an instance of the inner one
+	hgraph_t* outer_subgraph = create_graph(registry);
+	hgraph_index_t inner = hgraph_create_node(outer_subgraph, &macro);
+	outer_macro_subgraph.graph = outer_subgraph;
+	outer_macro_input_pins[0] = hgraph_get_pin_id(outer_subgraph, inner, &macro_in_f32);
+	outer_macro_output_pins[0] = hgraph_get_pin_id(outer_subgraph, inner, &macro_out_i32);
+
+	hgraph_t* graph = create_graph(registry);
+	hgraph_index_t start = hgraph_create_node(graph, &plugin1_start);
+	hgraph_index_t instance = hgraph_create_node(graph, &outer_macro);
+	hgraph_index_t end = hgraph_create_node(graph, &plugin1_end);
+	hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, start, &plugin1_start_out_f32),
+		hgraph_get_pin_id(graph, instance, &macro_in_f32)
+	);
+	hgraph_connect(
+		graph,
+		hgraph_get_pin_id(graph, instance, &macro_out_i32),
+		hgraph_get_pin_id(graph, end, &plugin1_end_in_i32)
+	);
+
+	hgraph_pipeline_config_t pipeline_config = {
+		.graph = graph,
+		.max_scratch_memory = 4096,
+	};
+	size_t mem_required = hgraph_pipeline_init(NULL, 0, &pipeline_config);
+	hgraph_pipeline_t* pipeline = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_pipeline_init(pipeline, mem_required, &pipeline_config);
+	ASSERT_EQ(hgraph_pipeline_execute(pipeline, NULL, NULL), HGRAPH_PIPELINE_EXEC_NESTED_SUBGRAPH);
+	ASSERT_TRUE(hgraph_pipeline_get_node_status(pipeline, end) == NULL);
+}
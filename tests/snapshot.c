@@ -0,0 +1,151 @@
+#include "rktest.h"
+#include "common.h"
+#include "plugin1.h"
+#include "plugin2.h"
+#include <hgraph/runtime.h>
+
+static struct {
+	fixture_t base;
+	hgraph_t* snapshot;
+} fixture;
+
+static hgraph_t*
+create_snapshot(const hgraph_t* graph) {
+	hgraph_config_t config = hgraph_get_config(graph);
+	size_t mem_required = hgraph_init(NULL, 0, &config);
+	hgraph_t* snapshot = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_init(snapshot, mem_required, &config);
+	return snapshot;
+}
+
+TEST_SETUP(snapshot) {
+	fixture_init(&fixture.base);
+	create_start_mid_end_graph(fixture.base.graph);
+	fixture.snapshot = create_snapshot(fixture.base.graph);
+}
+
+TEST_TEARDOWN(snapshot) {
+	fixture_cleanup(&fixture.base);
+}
+
+TEST(snapshot, copy) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_t* snapshot = fixture.snapshot;
+
+	ASSERT_TRUE(hgraph_snapshot(snapshot, graph));
+
+	hgraph_info_t info = hgraph_get_info(snapshot);
+	ASSERT_EQ(info.num_nodes, 3);
+	ASSERT_EQ(info.num_edges, 2);
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+	ASSERT_EQ(hgraph_get_node_by_name(snapshot, HGRAPH_STR("start")), start);
+	ASSERT_EQ(hgraph_get_node_by_name(snapshot, HGRAPH_STR("mid")), mid);
+	ASSERT_EQ(hgraph_get_node_by_name(snapshot, HGRAPH_STR("end")), end);
+	ASSERT_TRUE(hgraph_get_node_type(snapshot, mid) == &plugin2_mid);
+	ASSERT_TRUE(
+		hgraph_is_pin_connected(
+			snapshot,
+			hgraph_get_pin_id(snapshot, end, &plugin1_end_in_i32)
+		)
+	);
+}
+
+TEST(snapshot, isolation) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_t* snapshot = fixture.snapshot;
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t mid = hgraph_get_node_by_name(graph, HGRAPH_STR("mid"));
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 1.5f });
+	ASSERT_TRUE(hgraph_snapshot(snapshot, graph));
+
+	// Edit the source graph, the snapshot must not change
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 2.5f });
+	hgraph_set_node_name(graph, mid, HGRAPH_STR("middle"));
+	hgraph_index_t new_node = hgraph_create_node(graph, &plugin1_end);
+	ASSERT_TRUE(HGRAPH_IS_VALID_INDEX(new_node));
+
+	const float* value = hgraph_get_node_attribute(snapshot, start, &plugin1_start_attr_f32);
+	ASSERT_EQ(*value, 1.5f);
+	ASSERT_EQ(hgraph_get_node_by_name(snapshot, HGRAPH_STR("mid")), mid);
+	ASSERT_EQ(hgraph_get_info(snapshot).num_nodes, 3);
+
+	// Sync again, only the changes are copied
+	ASSERT_TRUE(hgraph_snapshot(snapshot, graph));
+	value = hgraph_get_node_attribute(snapshot, start, &plugin1_start_attr_f32);
+	ASSERT_EQ(*value, 2.5f);
+	ASSERT_EQ(hgraph_get_node_by_name(snapshot, HGRAPH_STR("middle")), mid);
+	ASSERT_EQ(hgraph_get_info(snapshot).num_nodes, 4);
+	ASSERT_TRUE(hgraph_get_node_type(snapshot, new_node) == &plugin1_end);
+
+	// Destroying a node moves slots around
+	hgraph_destroy_node(graph, start);
+	ASSERT_TRUE(hgraph_snapshot(snapshot, graph));
+	ASSERT_EQ(hgraph_get_info(snapshot).num_nodes, 3);
+	ASSERT_EQ(hgraph_get_info(snapshot).num_edges, 1);
+	ASSERT_TRUE(hgraph_get_node_type(snapshot, start) == NULL);
+	ASSERT_TRUE(hgraph_get_node_type(snapshot, new_node) == &plugin1_end);
+	ASSERT_EQ(hgraph_get_node_by_name(snapshot, HGRAPH_STR("middle")), mid);
+}
+
+TEST(snapshot, resync_after_write) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_t* snapshot = fixture.snapshot;
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	ASSERT_TRUE(hgraph_snapshot(snapshot, graph));
+
+	// Writing to the snapshot forces a full copy on the next sync
+	hgraph_set_node_attribute(snapshot, start, &plugin1_start_attr_f32, &(float){ 3.f });
+	ASSERT_TRUE(hgraph_snapshot(snapshot, graph));
+
+	const float* value = hgraph_get_node_attribute(snapshot, start, &plugin1_start_attr_f32);
+	const float* expected = hgraph_get_node_attribute(graph, start, &plugin1_start_attr_f32);
+	ASSERT_EQ(*value, *expected);
+}
+
+TEST(snapshot, incompatible) {
+	hgraph_t* graph = fixture.base.graph;
+
+	hgraph_config_t config = hgraph_get_config(graph);
+	config.max_nodes += 1;
+	size_t mem_required = hgraph_init(NULL, 0, &config);
+	hgraph_t* snapshot = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_init(snapshot, mem_required, &config);
+
+	ASSERT_FALSE(hgraph_snapshot(snapshot, graph));
+}
+
+TEST(snapshot, pipeline) {
+	hgraph_t* graph = fixture.base.graph;
+	hgraph_t* snapshot = fixture.snapshot;
+
+	hgraph_index_t start = hgraph_get_node_by_name(graph, HGRAPH_STR("start"));
+	hgraph_index_t end = hgraph_get_node_by_name(graph, HGRAPH_STR("end"));
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 4.20f });
+	ASSERT_TRUE(hgraph_snapshot(snapshot, graph));
+
+	hgraph_pipeline_config_t pipeline_config = {
+		.graph = snapshot,
+		.max_scratch_memory = 4096,
+	};
+	size_t mem_required = hgraph_pipeline_init(NULL, 0, &pipeline_config);
+	hgraph_pipeline_t* pipeline = arena_alloc(&fixture.base.arena, mem_required);
+	hgraph_pipeline_init(pipeline, mem_required, &pipeline_config);
+
+	// Editing the live graph does not disturb the pipeline
+	hgraph_destroy_node(graph, end);
+	hgraph_set_node_attribute(graph, start, &plugin1_start_attr_f32, &(float){ 1.f });
+
+	hgraph_pipeline_execution_status_t status = hgraph_pipeline_execute(pipeline, NULL, NULL);
+	ASSERT_EQ(status, HGRAPH_PIPELINE_EXEC_FINISHED);
+
+	const int32_t* result = hgraph_pipeline_get_node_status(pipeline, end);
+	ASSERT_TRUE(result != NULL);
+	ASSERT_EQ(*result, 5);
+
+	hgraph_pipeline_cleanup(pipeline);
+}
@@ -0,0 +1,142 @@
+#define _DEFAULT_SOURCE 1
+#include "rktest.h"
+#include "common.h"
+#include <hgraph/runtime.h>
+#include <hgraph/stream.h>
+#include <hgraph/io.h>
+#include <stdio.h>
+
+static const uint64_t stream_test_uints[] = {
+	0, 1, 0x7f, 0x80, 0x3fff, 0x4000, 0xffffffff, UINT64_MAX,
+};
+
+static hgraph_io_status_t
+write_test_values(hgraph_out_t* out) {
+	for (size_t i = 0; i < sizeof(stream_test_uints) / sizeof(stream_test_uints[0]); ++i) {
+		HGRAPH_CHECK_IO(hgraph_io_write_uint(stream_test_uints[i], out));
+		HGRAPH_CHECK_IO(hgraph_io_write_sint(-(int64_t)i, out));
+		HGRAPH_CHECK_IO(hgraph_io_write_str(HGRAPH_STR("a string longer than the buffer"), out));
+	}
+
+	return HGRAPH_IO_OK;
+}
+
+static void
+check_test_values(hgraph_in_t* in) {
+	for (size_t i = 0; i < sizeof(stream_test_uints) / sizeof(stream_test_uints[0]); ++i) {
+		uint64_t u = 0;
+		ASSERT_EQ(hgraph_io_read_uint(&u, in), HGRAPH_IO_OK);
+		ASSERT_EQ(u, stream_test_uints[i]);
+
+		int64_t s = 0;
+		ASSERT_EQ(hgraph_io_read_sint(&s, in), HGRAPH_IO_OK);
+		ASSERT_EQ(s, -(int64_t)i);
+
+		char buf[64];
+		size_t len = sizeof(buf) - 1;
+		ASSERT_EQ(hgraph_io_read_str(buf, &len, in), HGRAPH_IO_OK);
+		ASSERT_STREQ(buf, "a string longer than the buffer");
+	}
+
+	char tmp;
+	ASSERT_EQ(hgraph_io_read(in, &tmp, 1), HGRAPH_IO_ERROR);
+}
+
+static struct {
+	fixture_t base;
+} fixture;
+
+TEST_SETUP(stream) {
+	fixture_init(&fixture.base);
+}
+
+TEST_TEARDOWN(stream) {
+	fixture_cleanup(&fixture.base);
+}
+
+TEST(stream, mem) {
+	char data[512];
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_mem(&out_stream, data, sizeof(data));
+	ASSERT_EQ(write_test_values(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_stream_flush(&out_stream), HGRAPH_IO_OK);
+	size_t size = hgraph_stream_out_size(&out_stream);
+
+	hgraph_stream_in_t in_stream;
+	check_test_values(hgraph_stream_in_init_mem(&in_stream, data, size));
+
+	// Running out of space is an error instead of an overflow
+	char small[4];
+	out = hgraph_stream_out_init_mem(&out_stream, small, sizeof(small));
+	ASSERT_EQ(write_test_values(out), HGRAPH_IO_ERROR);
+	ASSERT_EQ(hgraph_stream_out_size(&out_stream), 3);
+}
+
+TEST(stream, file) {
+	FILE* file = tmpfile();
+	ASSERT_TRUE(file != NULL);
+
+	// A buffer smaller than a varint crosses refills in the middle of values
+	char buffer[7];
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_file(&out_stream, file, buffer, sizeof(buffer));
+	ASSERT_EQ(write_test_values(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_stream_flush(&out_stream), HGRAPH_IO_OK);
+	ASSERT_EQ((long)hgraph_stream_out_size(&out_stream), ftell(file));
+
+	rewind(file);
+	hgraph_stream_in_t in_stream;
+	check_test_values(hgraph_stream_in_init_file(&in_stream, file, buffer, sizeof(buffer)));
+
+	fclose(file);
+}
+
+TEST(stream, fd) {
+	FILE* file = tmpfile();
+	ASSERT_TRUE(file != NULL);
+	int fd = fileno(file);
+
+	char buffer[16];
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_fd(&out_stream, fd, buffer, sizeof(buffer));
+	ASSERT_EQ(write_test_values(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_stream_flush(&out_stream), HGRAPH_IO_OK);
+
+	rewind(file);
+	hgraph_stream_in_t in_stream;
+	check_test_values(hgraph_stream_in_init_fd(&in_stream, fd, buffer, sizeof(buffer)));
+
+	fclose(file);
+}
+
+TEST(stream, graph) {
+	create_start_mid_end_graph(fixture.base.graph);
+
+	FILE* file = tmpfile();
+	ASSERT_TRUE(file != NULL);
+
+	char buffer[64];
+	hgraph_stream_out_t out_stream;
+	hgraph_out_t* out = hgraph_stream_out_init_file(&out_stream, file, buffer, sizeof(buffer));
+	ASSERT_EQ(hgraph_write_header(out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_write_graph(fixture.base.graph, out), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_stream_flush(&out_stream), HGRAPH_IO_OK);
+
+	rewind(file);
+	hgraph_stream_in_t in_stream;
+	hgraph_in_t* in = hgraph_stream_in_init_file(&in_stream, file, buffer, sizeof(buffer));
+
+	hgraph_header_t header;
+	ASSERT_EQ(hgraph_read_header(&header, in), HGRAPH_IO_OK);
+	hgraph_config_t graph_config;
+	ASSERT_EQ(hgraph_read_graph_config(&header, &graph_config, in), HGRAPH_IO_OK);
+	graph_config.registry = fixture.base.registry;
+
+	size_t mem_size = hgraph_init(NULL, 0, &graph_config);
+	hgraph_t* graph = arena_alloc(&fixture.base.arena, mem_size);
+	hgraph_init(graph, mem_size, &graph_config);
+	ASSERT_EQ(hgraph_read_graph(&header, graph, in), HGRAPH_IO_OK);
+	ASSERT_EQ(hgraph_get_digest(graph), hgraph_get_digest(fixture.base.graph));
+
+	fclose(file);
+}